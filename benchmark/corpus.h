@@ -0,0 +1,234 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <random>
+#include <string>
+#include <cstdio>
+#include <cstdint>
+
+// generated documents shaped like the usual json benchmark files. the same seed always gives the
+// same text, so results stay comparable between releases.
+class corpus_writer {
+public:
+  explicit corpus_writer(uint64_t seed) : rng(seed) {}
+
+  std::string& text() { return out; }
+  size_t size() const { return out.size(); }
+
+  void raw(const char* s) { out += s; }
+  void put(char c) { out.push_back(c); }
+  void key(const char* k) {
+    out.push_back('"');
+    out += k;
+    out += "\":";
+  }
+  void string(const std::string& s) {
+    out.push_back('"');
+    out += s;
+    out.push_back('"');
+  }
+  void integer(int64_t n) { out += std::to_string(n); }
+  void real(double d, int digits) {
+    char buf[40];
+    snprintf(buf, sizeof(buf), "%.*g", digits, d);
+    out += buf;
+  }
+
+  uint64_t next() { return rng(); }
+  int64_t between(int64_t lo, int64_t hi) { return lo + static_cast<int64_t>(rng() % static_cast<uint64_t>(hi - lo + 1)); }
+  double uniform(double lo, double hi) { return lo + (hi - lo) * (rng() >> 11) * (1.0 / 9007199254740992.0); }
+  bool chance(int percent) { return static_cast<int>(rng() % 100) < percent; }
+
+  // prose with some escapes, \u sequences and multi byte utf-8, like tweets and descriptions
+  std::string words(int min, int max) {
+    static const char* vocabulary[] = {
+      "json", "parser", "the", "of", "stream", "fast", "\\u3042\\u308a", "caf\xc3\xa9", "\xe6\x9d\xb1\xe4\xba\xac",
+      "\\\"quoted\\\"", "line\\nbreak", "tab\\t", "http:\\/\\/t.co\\/x", "#tag", "@user", "\xf0\x9f\x98\x80", "rate", "data"
+    };
+    std::string s;
+    const int n = static_cast<int>(between(min, max));
+    for (int i = 0; i < n; ++i) {
+      if (i) s.push_back(' ');
+      s += vocabulary[rng() % (sizeof(vocabulary) / sizeof(vocabulary[0]))];
+    }
+    return s;
+  }
+  std::string identifier(const char* prefix) { return prefix + std::to_string(rng() % 1000000); }
+
+private:
+  std::mt19937_64 rng;
+  std::string out;
+};
+
+// twitter.json like: status objects with nested users and entities, mostly strings
+inline std::string make_twitter_corpus(size_t bytes, uint64_t seed = 1) {
+  corpus_writer w(seed);
+  w.raw("{\"statuses\":[");
+  for (int i = 0; w.size() < bytes; ++i) {
+    if (i) w.put(',');
+    w.raw("{\"metadata\":{\"result_type\":\"recent\",\"iso_language_code\":\"ja\"},\"created_at\":");
+    w.string("Sun Aug 31 00:29:" + std::to_string(10 + i % 50) + " +0000 2014");
+    w.raw(",\"id\":");
+    w.integer(505874924095815681LL + i);
+    w.raw(",\"id_str\":");
+    w.string(std::to_string(505874924095815681LL + i));
+    w.raw(",\"text\":");
+    w.string(w.words(5, 25));
+    w.raw(",\"source\":\"<a href=\\\"http:\\/\\/twitter.com\\/download\\/iphone\\\" rel=\\\"nofollow\\\">Twitter for iPhone<\\/a>\"");
+    w.raw(",\"truncated\":false,\"in_reply_to_status_id\":null,\"user\":{\"id\":");
+    w.integer(w.between(1, 3000000000LL));
+    w.raw(",\"name\":");
+    w.string(w.words(1, 3));
+    w.raw(",\"screen_name\":");
+    w.string(w.identifier("user_"));
+    w.raw(",\"location\":");
+    w.string(w.words(0, 2));
+    w.raw(",\"description\":");
+    w.string(w.words(0, 20));
+    w.raw(",\"followers_count\":");
+    w.integer(w.between(0, 100000));
+    w.raw(",\"friends_count\":");
+    w.integer(w.between(0, 5000));
+    w.raw(",\"verified\":");
+    w.raw(w.chance(5) ? "true" : "false");
+    w.raw(",\"profile_image_url\":");
+    w.string("http:\\/\\/pbs.twimg.com\\/profile_images\\/" + w.identifier("") + "\\/normal.jpeg");
+    w.raw("},\"entities\":{\"hashtags\":[");
+    const int tags = static_cast<int>(w.between(0, 3));
+    for (int t = 0; t < tags; ++t) {
+      if (t) w.put(',');
+      w.raw("{\"text\":");
+      w.string(w.words(1, 1));
+      w.raw(",\"indices\":[");
+      w.integer(t * 10);
+      w.put(',');
+      w.integer(t * 10 + 8);
+      w.raw("]}");
+    }
+    w.raw("],\"urls\":[],\"user_mentions\":[]},\"retweet_count\":");
+    w.integer(w.between(0, 500));
+    w.raw(",\"favorited\":false,\"lang\":\"ja\"}");
+  }
+  w.raw("],\"search_metadata\":{\"completed_in\":0.087,\"max_id\":505874924095815681,\"count\":100}}");
+  return std::move(w.text());
+}
+
+// canada.json like: a geojson polygon with long runs of coordinate pairs, mostly doubles
+inline std::string make_canada_corpus(size_t bytes, uint64_t seed = 2) {
+  corpus_writer w(seed);
+  w.raw("{\"type\":\"FeatureCollection\",\"features\":[{\"type\":\"Feature\",\"properties\":{\"name\":\"Canada\"},"
+        "\"geometry\":{\"type\":\"Polygon\",\"coordinates\":[");
+  for (int ring = 0; w.size() < bytes; ++ring) {
+    if (ring) w.put(',');
+    w.put('[');
+    double lon = w.uniform(-141.0, -52.6);
+    double lat = w.uniform(41.7, 83.1);
+    for (int p = 0; p < 1000; ++p) {
+      if (p) w.put(',');
+      lon += w.uniform(-0.01, 0.01);
+      lat += w.uniform(-0.01, 0.01);
+      w.put('[');
+      w.real(lon, 15);
+      w.put(',');
+      w.real(lat, 15);
+      w.put(']');
+    }
+    w.put(']');
+  }
+  w.raw("]}}]}");
+  return std::move(w.text());
+}
+
+// citm_catalog.json like: objects keyed by ids with many small records and integer arrays
+inline std::string make_citm_corpus(size_t bytes, uint64_t seed = 3) {
+  corpus_writer w(seed);
+  w.raw("{\"areaNames\":{");
+  for (int i = 0; i < 200; ++i) {
+    if (i) w.put(',');
+    w.key(std::to_string(205705993 + i).c_str());
+    w.string(w.words(1, 3));
+  }
+  w.raw("},\"events\":{");
+  for (int i = 0; w.size() < bytes / 2; ++i) {
+    if (i) w.put(',');
+    const int64_t id = 138586341 + i;
+    w.key(std::to_string(id).c_str());
+    w.raw("{\"description\":null,\"id\":");
+    w.integer(id);
+    w.raw(",\"logo\":");
+    w.string(w.chance(50) ? "\\/images\\/UE0AAAAACEKo6QAAAAZDSVRN" : "");
+    w.raw(",\"name\":");
+    w.string(w.words(1, 6));
+    w.raw(",\"subTopicIds\":[");
+    for (int t = 0, n = static_cast<int>(w.between(1, 6)); t < n; ++t) {
+      if (t) w.put(',');
+      w.integer(337184269 + w.between(0, 100));
+    }
+    w.raw("],\"subjectCode\":null,\"subtitle\":null,\"topicIds\":[324846099,107888604]}");
+  }
+  w.raw("},\"performances\":[");
+  for (int i = 0; w.size() < bytes; ++i) {
+    if (i) w.put(',');
+    w.raw("{\"eventId\":");
+    w.integer(138586341 + w.between(0, 1000));
+    w.raw(",\"id\":");
+    w.integer(339887544 + i);
+    w.raw(",\"logo\":null,\"name\":null,\"prices\":[");
+    for (int p = 0, n = static_cast<int>(w.between(1, 4)); p < n; ++p) {
+      if (p) w.put(',');
+      w.raw("{\"amount\":");
+      w.integer(w.between(10, 200) * 250);
+      w.raw(",\"audienceSubCategoryId\":337100890,\"seatCategoryId\":");
+      w.integer(338937295 + p);
+      w.put('}');
+    }
+    w.raw("],\"seatCategories\":[{\"areas\":[{\"areaId\":205705999,\"blockIds\":[]},{\"areaId\":205705998,\"blockIds\":[]}],"
+          "\"seatCategoryId\":338937295}],\"seatMapImage\":null,\"start\":");
+    w.integer(1372701600000LL + i * 86400000LL);
+    w.raw(",\"venueCode\":\"PLEYEL_PLEYEL\"}");
+  }
+  w.raw("]}");
+  return std::move(w.text());
+}
+
+// small records nested 64 levels deep, alternating objects and arrays
+inline std::string make_deep_corpus(size_t bytes, uint64_t seed = 4) {
+  corpus_writer w(seed);
+  const int depth = 64;
+  w.put('[');
+  for (int i = 0; w.size() < bytes; ++i) {
+    if (i) w.put(',');
+    for (int d = 0; d < depth; ++d) w.raw(d % 2 ? "[" : "{\"node\":");
+    w.integer(w.between(-1000, 1000));
+    for (int d = depth - 1; d >= 0; --d) w.raw(d % 2 ? "]" : "}");
+  }
+  w.put(']');
+  return std::move(w.text());
+}
+
+// records with 200 members each, so every object gets a hash index
+inline std::string make_wide_corpus(size_t bytes, uint64_t seed = 5) {
+  corpus_writer w(seed);
+  char name[32];
+  w.put('[');
+  for (int i = 0; w.size() < bytes; ++i) {
+    if (i) w.put(',');
+    w.put('{');
+    for (int k = 0; k < 200; ++k) {
+      if (k) w.put(',');
+      snprintf(name, sizeof(name), "field_%03d", k);
+      w.key(name);
+      switch (k % 4) {
+        case 0: w.integer(w.between(0, 1000000)); break;
+        case 1: w.real(w.uniform(-1000, 1000), 6); break;
+        case 2: w.string(w.identifier("v")); break;
+        default: w.raw(w.chance(50) ? "true" : "null"); break;
+      }
+    }
+    w.put('}');
+  }
+  w.put(']');
+  return std::move(w.text());
+}
+
+#endif // CORPUS_H
@@ -1,8 +1,936 @@
 #include "utils.h"
 #include <tinyjson.h>
+#include <random>
+#include <cstdio>
 
 using namespace tinyjson;
 
+// parses the same text over and over, once into fresh heap json_nodes and once into a reused json_document
+void bench_document(const std::string& json, int iterations) {
+  StopWatch watch;
+  std::string err;
+
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    json_node node;
+    json_parser::parse(node, json, err);
+  }
+  watch.stop();
+  std::cout << "per-node parse x" << iterations << ": " << watch.milli() << " ms" << std::endl;
+
+  json_document doc;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    doc.parse(json, err);
+  }
+  watch.stop();
+  std::cout << "document parse x" << iterations << ": " << watch.milli() << " ms, arena "
+            << doc.get_arena().size() << " bytes" << std::endl;
+
+  json_view_document view;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    view.parse(json.data(), json.size(), err);
+  }
+  watch.stop();
+  std::cout << "view document parse x" << iterations << ": " << watch.milli() << " ms, arena "
+            << view.get_arena().size() << " bytes" << std::endl;
+}
+
+// stage 1 on its own for every instruction set, then full parses, over a few megabytes of json
+void bench_stage1(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  const double mb = json.size() / 1000000.0;
+  const char* names[] = { "scalar", "sse4.2", "avx2" };
+  StopWatch watch;
+
+  std::vector<uint32_t> index(json.size());
+  for (int level = 0; level <= static_cast<int>(structural_index::best_level()); ++level) {
+    size_t count = 0;
+    watch.start();
+    structural_index::scan(json.data(), json.size(), index.data(), count, static_cast<simd_level>(level));
+    watch.stop();
+    std::cout << "stage 1 (" << names[level] << "): " << mb / watch.milli() << " GB/s" << std::endl;
+  }
+
+  std::string err;
+  json_node node;
+  watch.start();
+  json_parser::parse(node, json, err);
+  watch.stop();
+  std::cout << "per-node parse " << mb << " MB: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  json_document doc;
+  watch.start();
+  doc.parse(json, err);
+  watch.stop();
+  std::cout << "document parse " << mb << " MB: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  json_view_document view;
+  watch.start();
+  view.parse(json.data(), json.size(), err);
+  watch.stop();
+  std::cout << "view document parse " << mb << " MB: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+}
+
+// serializes a document made of nothing but numbers, then checks that every one of them reads back
+// bit for bit. random bit patterns go through dtoa and read_number on their own as well.
+void bench_numbers(int count) {
+  std::mt19937_64 rng(42);
+  json_node::array values;
+  for (int i = 0; i < count; ++i) {
+    uint64_t bits = rng();
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    switch (i % 4) {
+      case 0: values.push_back(new json_node(std::isfinite(d) ? d : 0.5)); break;
+      case 1: values.push_back(new json_node(std::uniform_real_distribution<double>(-180, 180)(rng))); break;
+      case 2: values.push_back(new json_node(static_cast<int64_t>(rng() >> (rng() % 64)))); break;
+      default: values.push_back(new json_node(static_cast<int>(rng() % 100000) / 100.0)); break;
+    }
+  }
+  json_node node(values);
+  for (json_node* v : values) delete v;
+  StopWatch watch;
+
+  watch.start();
+  std::string serialized = node.serialize();
+  watch.stop();
+  std::cout << "serialize " << count << " numbers: " << watch.milli() << " ms, "
+            << serialized.size() / 1000.0 / watch.milli() << " MB/s, "
+            << watch.nano() / count << " ns/number" << std::endl;
+
+  // what printf needs for the same round trip guarantee
+  std::string baseline;
+  char buf[32];
+  watch.start();
+  for (const json_node* v : node.get_array()) {
+    int length = v->is_integer() ? snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v->get_integer()))
+                                 : snprintf(buf, sizeof(buf), "%.17g", v->get_number());
+    baseline.append(buf, length);
+    baseline += ',';
+  }
+  watch.stop();
+  std::cout << "snprintf %.17g " << count << " numbers: " << watch.milli() << " ms, "
+            << watch.nano() / count << " ns/number" << std::endl;
+
+  std::string err;
+  json_node back;
+  size_t mismatches = 0;
+  if (!json_parser::parse(back, serialized, err) || back.length() != node.length()) {
+    std::cout << "round trip parse failed: " << err << std::endl;
+    return;
+  }
+  for (size_t i = 0; i < node.length(); ++i) {
+    const json_node& a = node[i];
+    const json_node& b = back[i];
+    const double x = a.get_number();
+    const double y = b.get_number();
+    if (a.is_integer() != b.is_integer() || (a.is_integer() ? a.get_integer() != b.get_integer() : memcmp(&x, &y, sizeof(x)) != 0)) {
+      ++mismatches;
+    }
+  }
+  for (int i = 0; i < 10 * count; ++i) {
+    uint64_t bits = rng();
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    if (!std::isfinite(d)) continue;
+    const char* end = dtoa(buf, d);
+    number_value r;
+    if (!read_number(buf, end, &r)) {
+      ++mismatches;
+      continue;
+    }
+    const double back_d = r.kind == number_kind::signed_integer     ? static_cast<double>(r.int_val)
+                          : r.kind == number_kind::unsigned_integer ? static_cast<double>(r.uint_val)
+                                                                    : r.real;
+    if (memcmp(&d, &back_d, sizeof(d)) != 0) ++mismatches;
+  }
+  std::cout << "number round trip mismatches: " << mismatches << std::endl;
+}
+
+// the same big document serialized into a fresh string, a reused output_buffer and a FILE sink
+void bench_serialize(const std::string& sample, int iterations) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  std::string err;
+  json_document doc;
+  doc.parse(json, err);
+  StopWatch watch;
+
+  for (int prettify = 0; prettify < 2; ++prettify) {
+    const char* mode = prettify ? " (pretty)" : "";
+    size_t size = 0;
+    watch.start();
+    for (int i = 0; i < iterations; ++i) {
+      size += doc.serialize(prettify != 0).size();
+    }
+    watch.stop();
+    std::cout << "serialize to string" << mode << ": " << size / 1000.0 / watch.milli() << " MB/s" << std::endl;
+
+    output_buffer buffer;
+    watch.start();
+    for (int i = 0; i < iterations; ++i) {
+      buffer.clear();
+      doc.serialize(buffer, prettify != 0);
+    }
+    watch.stop();
+    std::cout << "serialize to reused buffer" << mode << ": " << size / 1000.0 / watch.milli() << " MB/s" << std::endl;
+
+    FILE* null_file = fopen("/dev/null", "wb");
+    if (null_file) {
+      file_sink sink(null_file);
+      watch.start();
+      for (int i = 0; i < iterations; ++i) {
+        doc.serialize_to(sink, prettify != 0);
+      }
+      watch.stop();
+      fclose(null_file);
+      std::cout << "serialize to FILE sink" << mode << ": " << size / 1000.0 / watch.milli() << " MB/s" << std::endl;
+    }
+  }
+}
+
+// picks one field out of every record without building a tree
+struct field_counter : json_handler {
+  size_t records = 0;
+  size_t depth = 0;
+  bool want = false;
+  double sum = 0;
+
+  bool key(const char* str, size_t length, bool) {
+    want = depth == 1 && length == 6 && memcmp(str, "memory", 6) == 0;
+    return true;
+  }
+  bool number(const number_value& value) {
+    if (want) {
+      sum += value.kind == number_kind::real ? value.real : static_cast<double>(value.int_val);
+      ++records;
+    }
+    want = false;
+    return true;
+  }
+  bool start_object() {
+    ++depth;
+    return true;
+  }
+  bool end_object(size_t) {
+    --depth;
+    return true;
+  }
+};
+
+// parses the json held in every string value while the outer parse is still running
+struct nested_parser : json_handler {
+  size_t parsed = 0;
+
+  bool string(const char* str, size_t length, bool) {
+    json_node inner;
+    std::string err;
+    parsed += json_parser::parse(inner, str, length, err);
+    return true;
+  }
+};
+
+void bench_sax(const std::string& sample) {
+  // a parse started from a handler must not disturb the one that called it
+  const std::string nested = "[{\"payload\":\"[1,2,3,4,5,6,7,8]\",\"n\":1},{\"payload\":\"{}\",\"n\":2},{\"n\":3}]";
+  nested_parser inner;
+  std::string nested_err;
+  if (!json_parser::sax_parse(inner, nested, nested_err) || inner.parsed != 2) {
+    std::cout << "nested sax parse failed: " << nested_err << std::endl;
+  }
+
+
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  json_handler ignore;
+  watch.start();
+  json_parser::sax_parse(ignore, json, err);
+  watch.stop();
+  std::cout << "sax parse, no handler work " << mb << " MB: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  field_counter counter;
+  watch.start();
+  json_parser::sax_parse(counter, json, err);
+  watch.stop();
+  std::cout << "sax parse, one field of " << counter.records << " records: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  // the arena is warmed up first, so this is the steady state of a reused document
+  json_document doc;
+  doc.parse(json, err);
+  watch.start();
+  doc.parse(json, err);
+  watch.stop();
+  std::cout << "reused document parse " << mb << " MB: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+}
+
+// the same document fed to the push parser in network sized chunks
+void bench_push(const std::string& sample, size_t chunk_size) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  json_handler ignore;
+  json_push_parser<json_handler> events(ignore);
+  watch.start();
+  for (size_t i = 0; i < json.size(); i += chunk_size) {
+    events.feed(json.data() + i, std::min(chunk_size, json.size() - i), err);
+  }
+  events.finish(err);
+  watch.stop();
+  std::cout << "push parse events, " << chunk_size << " byte chunks: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  json_document doc;
+  dom_builder<document_node> builder(doc);
+  json_push_parser<dom_builder<document_node>> tree(builder);
+  watch.start();
+  for (size_t i = 0; i < json.size(); i += chunk_size) {
+    tree.feed(json.data() + i, std::min(chunk_size, json.size() - i), err);
+  }
+  tree.finish(err);
+  watch.stop();
+  std::cout << "push parse document, " << chunk_size << " byte chunks: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+}
+
+// json lines made of the records of the sample, parsed one by one and then across threads
+void bench_ndjson(const std::string& sample) {
+  json_node records;
+  std::string err;
+  json_parser::parse(records, sample, err);
+  std::string lines;
+  while (lines.size() < (64 << 20)) {
+    for (size_t i = 0; i < records.length(); ++i) {
+      lines += records[i].serialize();
+      lines += '\n';
+    }
+  }
+  const double mb = lines.size() / 1000000.0;
+  StopWatch watch;
+
+  json_document doc;
+  size_t count = 0;
+  watch.start();
+  for (size_t pos = 0; pos < lines.size();) {
+    size_t end = lines.find('\n', pos);
+    doc.parse(lines.data() + pos, end - pos, err);
+    count += doc.is_object();
+    pos = end + 1;
+  }
+  watch.stop();
+  std::cout << "ndjson line by line " << mb << " MB, " << count << " records: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  const unsigned cores = std::max(1u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= std::max(cores, 4u); threads *= 2) {
+    ndjson_parser parser(threads);
+    parser.parse(lines, err); // warm up the arenas
+    watch.start();
+    parser.parse(lines, err);
+    watch.stop();
+    std::cout << "ndjson parse, " << threads << " threads: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+    std::atomic<size_t> objects(0);
+    watch.start();
+    parser.for_each(lines, [&objects](ndjson_parser::node_type& record, size_t) {
+      objects += record.is_object();
+      return true;
+    }, err);
+    watch.stop();
+    std::cout << "ndjson for_each, " << threads << " threads: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+  }
+  std::cout << "(" << cores << " cores)" << std::endl;
+}
+
+// one record of bench_build, put together the way the README does it
+json_node::object make_record(int i) {
+  json_node::object record;
+  record.insert(std::make_pair("id", new json_node(i)));
+  record.insert(std::make_pair("name", new json_node("user" + std::to_string(i))));
+  record.insert(std::make_pair("score", new json_node(i * 0.5)));
+  record.insert(std::make_pair("tags", new json_node(json_node::array{new json_node("a"), new json_node("b"), new json_node("c")})));
+  record.insert(std::make_pair("active", new json_node(true)));
+  return record;
+}
+
+// builds an array of records in code: deep copies, moves, and in place
+void bench_build(int count) {
+  StopWatch watch;
+  size_t size = 0;
+
+  watch.start();
+  {
+    json_node root(json_node::array{});
+    for (int i = 0; i < count; ++i) {
+      json_node::object record = make_record(i);
+      root.get_array().push_back(new json_node(static_cast<const json_node::object&>(record)));
+      json_node(std::move(record)); // frees the originals
+    }
+    size += root.length();
+  }
+  watch.stop();
+  std::cout << "build " << count << " records, copied: " << watch.milli() << " ms" << std::endl;
+
+  watch.start();
+  {
+    json_node root(json_node::array{});
+    for (int i = 0; i < count; ++i) {
+      root.get_array().push_back(new json_node(make_record(i)));
+    }
+    size += root.length();
+  }
+  watch.stop();
+  std::cout << "build " << count << " records, moved: " << watch.milli() << " ms" << std::endl;
+
+  watch.start();
+  {
+    json_node root;
+    for (int i = 0; i < count; ++i) {
+      json_node& record = root.emplace_back(json_node::object());
+      record.reserve(5);
+      record.emplace("id", i);
+      record.emplace("name", "user" + std::to_string(i));
+      record.emplace("score", i * 0.5);
+      json_node& tags = record.emplace("tags", json_node::array());
+      tags.reserve(3);
+      tags.emplace_back("a");
+      tags.emplace_back("b");
+      tags.emplace_back("c");
+      record.emplace("active", true);
+    }
+    size += root.length();
+  }
+  watch.stop();
+  std::cout << "build " << count << " records, emplaced: " << watch.milli() << " ms" << std::endl;
+
+  json_document doc;
+  for (int round = 0; round < 2; ++round) { // the second round reuses the arena
+    doc.reset();
+    watch.start();
+    for (int i = 0; i < count; ++i) {
+      document_node& record = doc.emplace_back(document_node::object());
+      record.reserve(5);
+      record.emplace("id", i);
+      record.emplace("name", ("user" + std::to_string(i)).c_str());
+      record.emplace("score", i * 0.5);
+      document_node& tags = record.emplace("tags", document_node::array());
+      tags.reserve(3);
+      tags.emplace_back("a");
+      tags.emplace_back("b");
+      tags.emplace_back("c");
+      record.emplace("active", true);
+    }
+    watch.stop();
+  }
+  size += doc.length();
+  std::cout << "build " << count << " records, emplaced into a json_document: " << watch.milli() << " ms" << std::endl;
+
+  std::vector<json_node> nodes;
+  watch.start();
+  for (int i = 0; i < count; ++i) {
+    nodes.push_back(json_node(make_record(i)));
+  }
+  watch.stop();
+  std::cout << "fill std::vector<json_node> with " << count << " records: " << watch.milli() << " ms (" << size << ")" << std::endl;
+}
+
+// sums every number and string length of a tree, touching each node once
+template <typename Node>
+double walk(const Node& node) {
+  if (node.is_number()) return node.get_number();
+  if (node.is_string()) return static_cast<double>(node.length());
+  double sum = 0;
+  if (node.is_array()) {
+    for (size_t i = 0; i < node.length(); ++i) sum += walk(node[i]);
+  } else if (node.is_object()) {
+    for (const auto& member : node.get_object()) sum += walk(*member.second);
+  }
+  return sum;
+}
+
+double walk(const compact_node& node) {
+  if (node.is_number()) return node.get_number();
+  if (node.is_string()) return static_cast<double>(node.length());
+  double sum = 0;
+  if (node.is_array()) {
+    for (const compact_node& element : node.get_array()) sum += walk(element);
+  } else if (node.is_object()) {
+    for (const compact_node::member& member : node.get_object()) sum += walk(member.value);
+  }
+  return sum;
+}
+
+double walk(const tape_view& node) {
+  if (node.is_number()) return node.get_number();
+  if (node.is_string()) return static_cast<double>(node.length());
+  double sum = 0;
+  for (const tape_view& child : node) sum += walk(child);
+  return sum;
+}
+
+// the same document as pointer linked document_nodes and as 16 byte compact_nodes
+void bench_compact(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  json_document doc;
+  doc.parse(json, err);
+  watch.start();
+  doc.parse(json, err);
+  watch.stop();
+  std::cout << "json_document parse: " << mb * 1000 / watch.milli() << " MB/s, "
+            << doc.get_arena().size() / 1000000.0 << " MB of nodes" << std::endl;
+
+  compact_document compact;
+  compact.parse(json, err);
+  watch.start();
+  compact.parse(json, err);
+  watch.stop();
+  std::cout << "compact_document parse: " << mb * 1000 / watch.milli() << " MB/s, "
+            << compact.get_arena().size() / 1000000.0 << " MB of nodes" << std::endl;
+
+  double sum = 0;
+  watch.start();
+  for (int i = 0; i < 10; ++i) sum += walk(static_cast<const document_node&>(doc));
+  watch.stop();
+  std::cout << "walk json_document: " << watch.milli() / 10 << " ms" << std::endl;
+  watch.start();
+  for (int i = 0; i < 10; ++i) sum -= walk(static_cast<const compact_node&>(compact));
+  watch.stop();
+  std::cout << "walk compact_document: " << watch.milli() / 10 << " ms (" << sum << ")" << std::endl;
+
+  size_t found = 0;
+  watch.start();
+  for (size_t i = 0; i < doc.length(); ++i) {
+    const document_node& item = doc[i];
+    for (size_t j = 0; j < item.length(); ++j) found += item[j]["memory"].is_number();
+  }
+  watch.stop();
+  std::cout << "lookup json_document: " << watch.milli() << " ms" << std::endl;
+  watch.start();
+  for (size_t i = 0; i < compact.length(); ++i) {
+    const compact_node& item = compact[i];
+    for (size_t j = 0; j < item.length(); ++j) found -= item[j]["memory"].is_number();
+  }
+  watch.stop();
+  std::cout << "lookup compact_document: " << watch.milli() << " ms (" << found << ")" << std::endl;
+}
+
+// the document of bench_compact on a tape
+void bench_tape(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  tape_document doc;
+  doc.parse(json, err);
+  watch.start();
+  doc.parse(json, err);
+  watch.stop();
+  std::cout << "tape_document parse: " << mb * 1000 / watch.milli() << " MB/s, "
+            << (doc.tape_length() * 8 + doc.string_bytes()) / 1000000.0 << " MB of tape and strings" << std::endl;
+
+  double sum = 0;
+  watch.start();
+  for (int i = 0; i < 10; ++i) sum += walk(doc.root());
+  watch.stop();
+  std::cout << "walk tape_document: " << watch.milli() / 10 << " ms (" << sum << ")" << std::endl;
+
+  size_t found = 0;
+  watch.start();
+  for (const tape_view& item : doc.root()) {
+    for (const tape_view& record : item) found += record["memory"].is_number();
+  }
+  watch.stop();
+  std::cout << "lookup tape_document: " << watch.milli() << " ms (" << found << ")" << std::endl;
+}
+
+// reads a few fields out of a large payload, the way a request handler would
+void bench_lazy(const std::string& sample) {
+  std::string json = "{\"items\":[";
+  while (json.size() < (1 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null],\"status\":\"ok\",\"count\":42}";
+  const int iterations = 100;
+  std::string err;
+  StopWatch watch;
+
+  size_t found = 0;
+  json_view_document doc;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    doc.parse(json, err);
+    found += doc["status"].get_string().size() + doc["count"].get_integer() + doc["items"][0][0]["memory"].is_number();
+  }
+  watch.stop();
+  std::cout << "json_view_document parse and read 3 fields: " << watch.milli() / iterations << " ms (" << found << ")" << std::endl;
+
+  found = 0;
+  lazy_document lazy;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    lazy.parse(json, err);
+    found += lazy["status"].get_string().size() + lazy["count"].get_integer() + lazy["items"][0][0]["memory"].is_number();
+  }
+  watch.stop();
+  std::cout << "lazy_document parse and read 3 fields: " << watch.milli() / iterations << " ms (" << found << ")" << std::endl;
+
+  json_node items;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) lazy["items"][0].materialize(items, err);
+  watch.stop();
+  std::cout << "lazy_document materialize one record: " << watch.milli() / iterations << " ms (" << items.length() << ")" << std::endl;
+}
+
+void bench_path(const std::string& sample) {
+  std::string json = "{\"items\":[";
+  while (json.size() < (1 << 20)) {
+    json += sample;
+    json += ",";
+  }
+  json += "null],\"status\":\"ok\",\"count\":42}";
+  const int iterations = 100;
+  std::string err;
+  StopWatch watch;
+
+  json_node root;
+  json_parser::parse(root, json, err);
+  json_path path;
+  path.compile("$.items[0][0].backing_queue_status.mode", err);
+  size_t found = 0;
+  watch.start();
+  for (int i = 0; i < 1000000; ++i) found += root["items"][0][0]["backing_queue_status"]["mode"].is_string();
+  watch.stop();
+  std::cout << "operator[] chain x1M: " << watch.milli() << " ms (" << found << ")" << std::endl;
+
+  found = 0;
+  watch.start();
+  for (int i = 0; i < 1000000; ++i) found += path.find(root)->is_string();
+  watch.stop();
+  std::cout << "json_path on the tree x1M: " << watch.milli() << " ms (" << found << ")" << std::endl;
+
+  // extracting fields from text that is parsed only for them
+  string_view value;
+  found = 0;
+  json_view_document doc;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    doc.parse(json, err);
+    found += doc["items"][0][0]["backing_queue_status"]["mode"].get_string().size();
+  }
+  watch.stop();
+  std::cout << "json_view_document parse and lookup: " << watch.milli() / iterations << " ms (" << found << ")" << std::endl;
+
+  found = 0;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) found += path.find(json, value, err) ? value.size() : 0;
+  watch.stop();
+  std::cout << "json_path on the text, early match: " << watch.milli() / iterations << " ms (" << found << ")" << std::endl;
+
+  path.compile("$.status", err);
+  found = 0;
+  watch.start();
+  for (int i = 0; i < iterations; ++i) found += path.find(json, value, err) ? value.size() : 0;
+  watch.stop();
+  std::cout << "json_path on the text, last member: " << watch.milli() / iterations << " ms (" << found << ")" << std::endl;
+
+  std::vector<string_view> values;
+  path.compile("$.items[*][*].memory", err);
+  watch.start();
+  for (int i = 0; i < iterations; ++i) {
+    values.clear();
+    path.select(json, values, err);
+  }
+  watch.stop();
+  std::cout << "json_path on the text, every record: " << watch.milli() / iterations << " ms (" << values.size() << ")" << std::endl;
+}
+
+// records with the same 30 keys, looked up by every key
+void bench_intern(int count) {
+  std::vector<std::string> keys;
+  for (int k = 0; k < 30; ++k) keys.push_back("customer_field_" + std::to_string(k));
+  std::string json = "[";
+  for (int i = 0; i < count; ++i) {
+    json += i ? ",{" : "{";
+    for (int k = 0; k < 30; ++k) json += (k ? ",\"" : "\"") + keys[k] + "\":" + std::to_string(i + k);
+    json += "}";
+  }
+  json += "]";
+  std::string err;
+  StopWatch watch;
+
+  for (int interned = 0; interned < 2; ++interned) {
+    key_table table;
+    json_view_document doc;
+    if (interned) doc.set_key_table(&table);
+    doc.parse(json, err);
+    watch.start();
+    doc.parse(json, err);
+    watch.stop();
+    const double parse_ms = watch.milli();
+
+    std::vector<const key_table::symbol*> symbols;
+    for (const std::string& key : keys) symbols.push_back(table.intern(key.data(), key.size()));
+    int64_t sum = 0;
+    watch.start();
+    for (size_t i = 0; i < doc.length(); ++i) {
+      const view_node& record = doc[i];
+      if (interned) {
+        for (const key_table::symbol* key : symbols) sum += record[*key].get_integer();
+      } else {
+        for (const std::string& key : keys) sum += record[string_view(key.data(), key.size())].get_integer();
+      }
+    }
+    watch.stop();
+    std::cout << (interned ? "interned keys" : "plain keys") << ": parse " << parse_ms << " ms, "
+              << count * 30 / 1000 << "k lookups " << watch.milli() << " ms (" << sum << ")" << std::endl;
+  }
+}
+
+// the parts of a queue record from sample14 that an application would read
+struct gc_stats {
+  int64_t fullsweep_after;
+  int64_t max_heap_size;
+  int64_t min_bin_vheap_size;
+  int64_t min_heap_size;
+  int64_t minor_gcs;
+};
+struct backing_status {
+  int64_t len;
+  std::string mode;
+  int64_t next_seq_id;
+  int64_t q4;
+  std::string target_ram_count;
+};
+struct queue_info {
+  bool auto_delete;
+  backing_status backing_queue_status;
+  int64_t consumers;
+  bool durable;
+  gc_stats garbage_collection;
+  std::string idle_since;
+  int64_t memory;
+  int64_t messages;
+  std::string name;
+  std::string node;
+  int64_t reductions;
+  std::string state;
+  std::string type;
+  std::string vhost;
+};
+TINYJSON_BIND(gc_stats, fullsweep_after, max_heap_size, min_bin_vheap_size, min_heap_size, minor_gcs)
+TINYJSON_BIND(backing_status, len, mode, next_seq_id, q4, target_ram_count)
+TINYJSON_BIND(queue_info, auto_delete, backing_queue_status, consumers, durable, garbage_collection, idle_since,
+  memory, messages, name, node, reductions, state, type, vhost)
+
+// decodes queue records straight into structs and compares it with parsing a document and copying out
+// of it, then writes them back directly and through a json_node
+void bench_bind(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (16 << 20)) {
+    if (json.size() > 1) json += ",";
+    json += sample;
+  }
+  json += "]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  std::vector<std::vector<queue_info>> dom_queues;
+  json_view_document doc;
+  doc.parse(json, err);
+  watch.start();
+  doc.parse(json, err);
+  for (size_t i = 0; i < doc.length(); ++i) {
+    const view_node& list = doc[i];
+    dom_queues.emplace_back(list.length());
+    for (size_t k = 0; k < list.length(); ++k) {
+      const view_node& record = list[k];
+      queue_info& q = dom_queues.back()[k];
+      q.auto_delete = record["auto_delete"].get_boolean();
+      const view_node& status = record["backing_queue_status"];
+      q.backing_queue_status.len = status["len"].get_integer();
+      q.backing_queue_status.mode.assign(status["mode"].get_string().data(), status["mode"].get_string().size());
+      q.backing_queue_status.next_seq_id = status["next_seq_id"].get_integer();
+      q.backing_queue_status.q4 = status["q4"].get_integer();
+      q.backing_queue_status.target_ram_count.assign(status["target_ram_count"].get_string().data(), status["target_ram_count"].get_string().size());
+      q.consumers = record["consumers"].get_integer();
+      q.durable = record["durable"].get_boolean();
+      const view_node& gc = record["garbage_collection"];
+      q.garbage_collection.fullsweep_after = gc["fullsweep_after"].get_integer();
+      q.garbage_collection.max_heap_size = gc["max_heap_size"].get_integer();
+      q.garbage_collection.min_bin_vheap_size = gc["min_bin_vheap_size"].get_integer();
+      q.garbage_collection.min_heap_size = gc["min_heap_size"].get_integer();
+      q.garbage_collection.minor_gcs = gc["minor_gcs"].get_integer();
+      q.idle_since.assign(record["idle_since"].get_string().data(), record["idle_since"].get_string().size());
+      q.memory = record["memory"].get_integer();
+      q.messages = record["messages"].get_integer();
+      q.name.assign(record["name"].get_string().data(), record["name"].get_string().size());
+      q.node.assign(record["node"].get_string().data(), record["node"].get_string().size());
+      q.reductions = record["reductions"].get_integer();
+      q.state.assign(record["state"].get_string().data(), record["state"].get_string().size());
+      q.type.assign(record["type"].get_string().data(), record["type"].get_string().size());
+      q.vhost.assign(record["vhost"].get_string().data(), record["vhost"].get_string().size());
+    }
+  }
+  watch.stop();
+  std::cout << "parse json_view_document + copy into structs: " << mb * 1000 / watch.milli() << " MB/s" << std::endl;
+
+  std::vector<std::vector<queue_info>> queues;
+  json_parser::decode(queues, json, err);
+  watch.start();
+  json_parser::decode(queues, json, err);
+  watch.stop();
+  std::cout << "decode into structs: " << mb * 1000 / watch.milli() << " MB/s ("
+            << (serialize(queues) == serialize(dom_queues) ? "same" : "different") << ")" << std::endl;
+
+  watch.start();
+  json_node root(json_node::array{});
+  for (const std::vector<queue_info>& list : queues) {
+    json_node& items = root.emplace_back(json_node::array());
+    for (const queue_info& q : list) {
+      json_node& record = items.emplace_back(json_node::object());
+      record.emplace("auto_delete", q.auto_delete);
+      json_node& status = record.emplace("backing_queue_status", json_node::object());
+      status.emplace("len", q.backing_queue_status.len);
+      status.emplace("mode", q.backing_queue_status.mode);
+      status.emplace("next_seq_id", q.backing_queue_status.next_seq_id);
+      status.emplace("q4", q.backing_queue_status.q4);
+      status.emplace("target_ram_count", q.backing_queue_status.target_ram_count);
+      record.emplace("consumers", q.consumers);
+      record.emplace("durable", q.durable);
+      json_node& gc = record.emplace("garbage_collection", json_node::object());
+      gc.emplace("fullsweep_after", q.garbage_collection.fullsweep_after);
+      gc.emplace("max_heap_size", q.garbage_collection.max_heap_size);
+      gc.emplace("min_bin_vheap_size", q.garbage_collection.min_bin_vheap_size);
+      gc.emplace("min_heap_size", q.garbage_collection.min_heap_size);
+      gc.emplace("minor_gcs", q.garbage_collection.minor_gcs);
+      record.emplace("idle_since", q.idle_since);
+      record.emplace("memory", q.memory);
+      record.emplace("messages", q.messages);
+      record.emplace("name", q.name);
+      record.emplace("node", q.node);
+      record.emplace("reductions", q.reductions);
+      record.emplace("state", q.state);
+      record.emplace("type", q.type);
+      record.emplace("vhost", q.vhost);
+    }
+  }
+  const std::string via_node = root.serialize();
+  watch.stop();
+  std::cout << "build json_node + serialize: " << watch.milli() << " ms" << std::endl;
+
+  watch.start();
+  const std::string direct = serialize(queues);
+  watch.stop();
+  std::cout << "serialize structs: " << watch.milli() << " ms (" << (direct == via_node ? "same" : "different") << ")" << std::endl;
+}
+
+// parses one big array of records serially and then on 1 to N threads
+void bench_parallel(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (64 << 20)) {
+    if (json.size() > 1) json += ",";
+    json += sample;
+  }
+  json += "]";
+  const double mb = json.size() / 1000000.0;
+  std::string err;
+  StopWatch watch;
+
+  {
+    json_node node;
+    watch.start();
+    json_parser::parse(node, json, err);
+    watch.stop();
+  }
+  const double serial_ms = watch.milli();
+  std::cout << "serial parse " << static_cast<int>(mb) << " MB: " << mb * 1000 / serial_ms << " MB/s" << std::endl;
+
+  const unsigned most = std::max(8u, std::thread::hardware_concurrency());
+  for (unsigned threads = 1; threads <= most; threads *= 2) {
+    parallel_parser parser(threads);
+    json_node node;
+    watch.start();
+    parser.parse(node, json, err);
+    watch.stop();
+    std::cout << "parallel parse, " << threads << " threads: " << mb * 1000 / watch.milli() << " MB/s (x"
+              << serial_ms / watch.milli() << ")" << std::endl;
+  }
+}
+
+// serializes one big array of records serially and on 1 to N threads, compact and pretty
+void bench_parallel_serialize(const std::string& sample) {
+  std::string json = "[";
+  while (json.size() < (64 << 20)) {
+    if (json.size() > 1) json += ",";
+    json += sample;
+  }
+  json += "]";
+  std::string err;
+  json_node node;
+  json_parser::parse(node, json, err);
+  StopWatch watch;
+
+  for (int pretty = 0; pretty < 2; ++pretty) {
+    node.serialize(pretty != 0);
+    watch.start();
+    const std::string serial = node.serialize(pretty != 0);
+    watch.stop();
+    const double serial_ms = watch.milli();
+    const double mb = serial.size() / 1000000.0;
+    std::cout << (pretty ? "serial serialize, pretty: " : "serial serialize: ") << mb * 1000 / serial_ms << " MB/s" << std::endl;
+
+    const unsigned most = std::max(8u, std::thread::hardware_concurrency());
+    for (unsigned threads = 1; threads <= most; threads *= 2) {
+      parallel_serializer serializer(threads);
+      serializer.serialize(node, pretty != 0);
+      watch.start();
+      const std::string text = serializer.serialize(node, pretty != 0);
+      watch.stop();
+      std::cout << "parallel serialize, " << threads << " threads: " << mb * 1000 / watch.milli() << " MB/s (x"
+                << serial_ms / watch.milli() << (text == serial ? ", same" : ", different") << ")" << std::endl;
+    }
+  }
+}
+
 int main() {
   StopWatch watch;
   json_node node;
@@ -35,8 +963,24 @@ int main() {
   std::string serialized = node.serialize(true);
   watch.stop();
 
-  std::cout << "serialize json elapsed: " << watch.milli() << " ms" << std::endl;
-  std::cout << serialized << std::endl;
+  std::cout << "serialize json elapsed: " << watch.milli() << " ms, " << serialized.size() << " bytes" << std::endl;
+
+  bench_document(json, 10000);
+  bench_stage1(json);
+  bench_numbers(1000000);
+  bench_serialize(json, 5);
+  bench_sax(json);
+  bench_push(json, 16 * 1024);
+  bench_ndjson(json);
+  bench_build(200000);
+  bench_compact(json);
+  bench_tape(json);
+  bench_lazy(json);
+  bench_path(json);
+  bench_intern(100000);
+  bench_bind(json);
+  bench_parallel(json);
+  bench_parallel_serialize(json);
 
   return 0;
 }
@@ -0,0 +1,426 @@
+#include "utils.h"
+#include "corpus.h"
+#include <tinyjson.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/resource.h>
+#endif
+
+using namespace tinyjson;
+
+// every allocation of the process is counted along with the live and peak bytes. the size is kept
+// in front of the block so delete knows how much goes back.
+namespace {
+  std::atomic<size_t> allocations(0);
+  std::atomic<size_t> allocated_bytes(0);
+  std::atomic<size_t> live_bytes(0);
+  std::atomic<size_t> peak_bytes(0);
+  const size_t header_size = alignof(std::max_align_t);
+
+  void* counted_alloc(size_t n) {
+    char* p = static_cast<char*>(std::malloc(n + header_size));
+    if (!p) throw std::bad_alloc();
+    *reinterpret_cast<size_t*>(p) = n;
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    allocated_bytes.fetch_add(n, std::memory_order_relaxed);
+    const size_t live = live_bytes.fetch_add(n, std::memory_order_relaxed) + n;
+    size_t peak = peak_bytes.load(std::memory_order_relaxed);
+    while (live > peak && !peak_bytes.compare_exchange_weak(peak, live, std::memory_order_relaxed)) {}
+    return p + header_size;
+  }
+  void counted_free(void* block) {
+    if (!block) return;
+    char* p = static_cast<char*>(block) - header_size;
+    live_bytes.fetch_sub(*reinterpret_cast<size_t*>(p), std::memory_order_relaxed);
+    std::free(p);
+  }
+}
+
+void* operator new(size_t n) { return counted_alloc(n); }
+void* operator new[](size_t n) { return counted_alloc(n); }
+void operator delete(void* p) noexcept { counted_free(p); }
+void operator delete[](void* p) noexcept { counted_free(p); }
+void operator delete(void* p, size_t) noexcept { counted_free(p); }
+void operator delete[](void* p, size_t) noexcept { counted_free(p); }
+
+// peak resident set of the process so far, 0 where it is not known
+size_t peak_rss_kb() {
+#if defined(_WIN32)
+  return 0;
+#else
+  rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#if defined(__APPLE__)
+  return static_cast<size_t>(usage.ru_maxrss) / 1024;
+#else
+  return static_cast<size_t>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// one operation on one corpus, timed over several runs after a warm up
+struct result {
+  std::string corpus;
+  std::string operation;
+  size_t bytes;      // json processed by one run
+  size_t items;      // documents, nodes or lookups done by one run
+  int runs;
+  double min_ms;
+  double median_ms;
+  double mean_ms;
+  double stddev_ms;
+  size_t allocations;      // per run
+  size_t allocated_bytes;  // per run
+  size_t peak_bytes;       // above what was live before the run
+
+  double mb_per_s() const { return bytes / 1000.0 / median_ms; }
+  double items_per_s() const { return items * 1000.0 / median_ms; }
+};
+
+template <typename F>
+result measure(const std::string& corpus, const std::string& operation, size_t bytes, size_t items, int runs, F f) {
+  f();
+  std::vector<double> times;
+  times.reserve(runs);
+  StopWatch watch;
+  const size_t count_before = allocations.load();
+  const size_t bytes_before = allocated_bytes.load();
+  const size_t live_before = live_bytes.load();
+  peak_bytes.store(live_before);
+  for (int i = 0; i < runs; ++i) {
+    watch.start();
+    f();
+    watch.stop();
+    times.push_back(watch.micro() / 1000.0);
+  }
+
+  result r;
+  r.corpus = corpus;
+  r.operation = operation;
+  r.bytes = bytes;
+  r.items = items;
+  r.runs = runs;
+  r.allocations = (allocations.load() - count_before) / runs;
+  r.allocated_bytes = (allocated_bytes.load() - bytes_before) / runs;
+  r.peak_bytes = peak_bytes.load() - live_before;
+  std::sort(times.begin(), times.end());
+  r.min_ms = times.front();
+  r.median_ms = runs % 2 ? times[runs / 2] : (times[runs / 2 - 1] + times[runs / 2]) / 2;
+  double sum = 0;
+  for (double t : times) sum += t;
+  r.mean_ms = sum / runs;
+  double squares = 0;
+  for (double t : times) squares += (t - r.mean_ms) * (t - r.mean_ms);
+  r.stddev_ms = runs > 1 ? std::sqrt(squares / (runs - 1)) : 0;
+  return r;
+}
+
+// results the timed code produces go here, so the compiler can not drop the work
+volatile double keep_alive = 0;
+
+// counts the nodes of a tree and adds up its numbers and string lengths
+size_t traverse(const json_node& node, double& sum) {
+  if (node.is_number()) {
+    sum += node.get_number();
+  } else if (node.is_string()) {
+    sum += node.length();
+  }
+  size_t count = 1;
+  if (node.is_array()) {
+    for (const json_node* element : node.get_array()) count += traverse(*element, sum);
+  } else if (node.is_object()) {
+    for (const auto& member : node.get_object()) count += traverse(*member.second, sum);
+  }
+  return count;
+}
+
+// every object of the tree paired with each of its keys, the lookups the lookup run repeats
+void collect_keys(const json_node& node, std::vector<std::pair<const json_node*, std::string>>& out) {
+  if (node.is_array()) {
+    for (const json_node* element : node.get_array()) collect_keys(*element, out);
+  } else if (node.is_object()) {
+    for (const auto& member : node.get_object()) {
+      out.emplace_back(&node, member.first);
+      collect_keys(*member.second, out);
+    }
+  }
+}
+
+// what one parse and one serialize of a corpus did, from json_stats. only filled in the
+// benchmark_stats build, where TINYJSON_STATS is 1.
+struct corpus_stats {
+  std::string corpus;
+  json_stats parse;
+  json_stats serialize;
+};
+
+typedef basic_json_node<stats_allocator<char>> counted_node;
+
+corpus_stats collect_stats(const std::string& name, const std::string& json) {
+  corpus_stats s;
+  s.corpus = name;
+  std::string err;
+  json_parser::reset_stats();
+  {
+    counted_node node;
+    json_parser::parse(node, json, err);
+    s.parse = json_parser::stats();
+    json_parser::reset_stats();
+    output_buffer out;
+    node.serialize(out);
+    s.serialize = json_parser::stats();
+  }
+  return s;
+}
+
+void run_corpus(const std::string& name, const std::string& json, int runs, std::vector<result>& results) {
+  std::string err;
+  json_node node;
+  if (!json_parser::parse(node, json, err)) {
+    std::cerr << name << ": " << err << std::endl;
+    return;
+  }
+
+  results.push_back(measure(name, "parse json_node", json.size(), 1, runs, [&]() {
+    json_node n;
+    json_parser::parse(n, json, err);
+  }));
+  json_document doc;
+  results.push_back(measure(name, "parse json_document", json.size(), 1, runs, [&]() { doc.parse(json, err); }));
+  tape_document tape;
+  results.push_back(measure(name, "parse tape_document", json.size(), 1, runs, [&]() { tape.parse(json, err); }));
+
+  output_buffer out;
+  node.serialize(out);
+  results.push_back(measure(name, "serialize", out.size(), 1, runs, [&]() {
+    out.clear();
+    node.serialize(out);
+  }));
+  out.clear();
+  node.serialize(out, true);
+  results.push_back(measure(name, "serialize pretty", out.size(), 1, runs, [&]() {
+    out.clear();
+    node.serialize(out, true);
+  }));
+
+  double sum = 0;
+  const size_t nodes = traverse(node, sum);
+  results.push_back(measure(name, "traverse", json.size(), nodes, runs, [&]() { traverse(node, sum); }));
+
+  std::vector<std::pair<const json_node*, std::string>> keys;
+  collect_keys(node, keys);
+  size_t found = 0;
+  results.push_back(measure(name, "lookup", 0, keys.size(), runs, [&]() {
+    for (const auto& key : keys) found += !key.first->get_node(key.second).is_null();
+  }));
+  keep_alive += sum + found;
+}
+
+// time to parse a file from disk, read into a string first or mapped with mapped_file. the files are
+// twitter shaped, 1 MB and up by 16 times to max_mb, and parsed into a compact_view_document so the
+// strings point into the input either way. the page cache is warm after the first run of each.
+void run_files(size_t max_mb, int runs, std::vector<result>& results) {
+  const std::string path = "benchmark_suite_file.json";
+  std::string err;
+  compact_view_document doc;
+  for (size_t mb = 1; mb <= max_mb; mb = mb < max_mb && mb * 16 > max_mb ? max_mb : mb * 16) {
+    size_t size;
+    {
+      const std::string json = make_twitter_corpus(mb << 20);
+      size = json.size();
+      FILE* file = fopen(path.c_str(), "wb");
+      if (!file || fwrite(json.data(), 1, json.size(), file) != json.size()) {
+        std::cerr << path << ": can not write file." << std::endl;
+        if (file) fclose(file);
+        return;
+      }
+      fclose(file);
+    }
+    const std::string name = "file " + std::to_string(mb) + "MB";
+    std::string text;
+    results.push_back(measure(name, "read + parse", size, 1, runs, [&]() {
+      text.clear();
+      read_file(path, text);
+      doc.parse(text.data(), text.size(), err);
+    }));
+    doc.reset();
+    std::string().swap(text);
+    results.push_back(measure(name, "mmap + parse", size, 1, runs, [&]() {
+      mapped_file file;
+      file.open(path, err);
+      doc.parse(file.data(), file.size(), err);
+    }));
+    doc.reset();
+    if (mb == max_mb) break;
+  }
+  remove(path.c_str());
+}
+
+void print_stats_text(const std::vector<corpus_stats>& stats) {
+  printf("\n%-10s %12s %10s %10s %10s %10s %10s %10s %6s %10s %10s %12s %12s\n", "corpus", "scanned MB", "nodes", "objects",
+         "arrays", "strings", "numbers", "allocs", "depth", "number ms", "string ms", "alloc MB", "output MB");
+  for (const corpus_stats& s : stats) {
+    const json_stats& p = s.parse;
+    printf("%-10s %12.2f %10llu %10llu %10llu %10llu %10llu %10llu %6u %10.3f %10.3f %12.2f %12.2f\n", s.corpus.c_str(),
+           p.bytes_scanned / 1000000.0, (unsigned long long)p.nodes(), (unsigned long long)p.object_nodes,
+           (unsigned long long)p.array_nodes, (unsigned long long)p.string_nodes, (unsigned long long)p.number_nodes,
+           (unsigned long long)p.allocations, p.max_depth, p.number_ns / 1000000.0, p.string_ns / 1000000.0,
+           p.allocated_bytes / 1000000.0, s.serialize.serialized_bytes / 1000000.0);
+  }
+}
+
+void emplace_stats(json_node& item, const json_stats& s) {
+  item.emplace("bytes_scanned", static_cast<uint64_t>(s.bytes_scanned));
+  item.emplace("null_nodes", static_cast<uint64_t>(s.null_nodes));
+  item.emplace("boolean_nodes", static_cast<uint64_t>(s.boolean_nodes));
+  item.emplace("number_nodes", static_cast<uint64_t>(s.number_nodes));
+  item.emplace("string_nodes", static_cast<uint64_t>(s.string_nodes));
+  item.emplace("array_nodes", static_cast<uint64_t>(s.array_nodes));
+  item.emplace("object_nodes", static_cast<uint64_t>(s.object_nodes));
+  item.emplace("allocations", static_cast<uint64_t>(s.allocations));
+  item.emplace("allocated_bytes", static_cast<uint64_t>(s.allocated_bytes));
+  item.emplace("deallocations", static_cast<uint64_t>(s.deallocations));
+  item.emplace("max_depth", static_cast<uint64_t>(s.max_depth));
+  item.emplace("number_ns", static_cast<uint64_t>(s.number_ns));
+  item.emplace("string_ns", static_cast<uint64_t>(s.string_ns));
+  item.emplace("serialized_bytes", static_cast<uint64_t>(s.serialized_bytes));
+}
+
+void print_text(const std::vector<result>& results) {
+  printf("%-10s %-20s %10s %10s %8s %10s %12s %12s %12s %12s\n", "corpus", "operation", "median ms", "min ms", "stddev",
+         "MB/s", "items/s", "allocs", "alloc MB", "peak MB");
+  for (const result& r : results) {
+    printf("%-10s %-20s %10.3f %10.3f %8.3f %10.1f %12.0f %12zu %12.2f %12.2f\n", r.corpus.c_str(), r.operation.c_str(),
+           r.median_ms, r.min_ms, r.stddev_ms, r.bytes ? r.mb_per_s() : 0.0, r.items_per_s(), r.allocations,
+           r.allocated_bytes / 1000000.0, r.peak_bytes / 1000000.0);
+  }
+  printf("peak rss: %zu kB\n", peak_rss_kb());
+}
+
+void print_csv(const std::vector<result>& results) {
+  printf("corpus,operation,bytes,items,runs,min_ms,median_ms,mean_ms,stddev_ms,mb_per_s,items_per_s,allocations,allocated_bytes,peak_bytes\n");
+  for (const result& r : results) {
+    printf("%s,%s,%zu,%zu,%d,%.4f,%.4f,%.4f,%.4f,%.2f,%.1f,%zu,%zu,%zu\n", r.corpus.c_str(), r.operation.c_str(), r.bytes,
+           r.items, r.runs, r.min_ms, r.median_ms, r.mean_ms, r.stddev_ms, r.bytes ? r.mb_per_s() : 0.0, r.items_per_s(),
+           r.allocations, r.allocated_bytes, r.peak_bytes);
+  }
+}
+
+void print_json(const std::vector<result>& results, const std::vector<corpus_stats>& stats) {
+  json_node root;
+  root.emplace("threads", static_cast<int64_t>(std::thread::hardware_concurrency()));
+  root.emplace("peak_rss_kb", static_cast<uint64_t>(peak_rss_kb()));
+  json_node& list = root.emplace("results", json_node::array());
+  for (const result& r : results) {
+    json_node& item = list.emplace_back(json_node::object());
+    item.emplace("corpus", r.corpus);
+    item.emplace("operation", r.operation);
+    item.emplace("bytes", static_cast<uint64_t>(r.bytes));
+    item.emplace("items", static_cast<uint64_t>(r.items));
+    item.emplace("runs", r.runs);
+    item.emplace("min_ms", r.min_ms);
+    item.emplace("median_ms", r.median_ms);
+    item.emplace("mean_ms", r.mean_ms);
+    item.emplace("stddev_ms", r.stddev_ms);
+    item.emplace("mb_per_s", r.bytes ? r.mb_per_s() : 0.0);
+    item.emplace("items_per_s", r.items_per_s());
+    item.emplace("allocations", static_cast<uint64_t>(r.allocations));
+    item.emplace("allocated_bytes", static_cast<uint64_t>(r.allocated_bytes));
+    item.emplace("peak_bytes", static_cast<uint64_t>(r.peak_bytes));
+  }
+  if (!stats.empty()) {
+    json_node& list = root.emplace("stats", json_node::array());
+    for (const corpus_stats& s : stats) {
+      json_node& item = list.emplace_back(json_node::object());
+      item.emplace("corpus", s.corpus);
+      emplace_stats(item.emplace("parse", json_node::object()), s.parse);
+      emplace_stats(item.emplace("serialize", json_node::object()), s.serialize);
+    }
+  }
+  std::cout << root.serialize(true) << std::endl;
+}
+
+void usage() {
+  std::cerr << "usage: benchmark_suite [--size MB] [--runs N] [--mmap MB] [--format text|csv|json] [--file name=path]..." << std::endl
+            << "  every generated corpus is about --size megabytes (default 8), runs defaults to 10." << std::endl
+            << "  --file adds a json file of your own, for example twitter=twitter.json." << std::endl
+            << "  --mmap MB also times parsing files of 1 MB up to MB read into a string against mapped." << std::endl
+            << "  the benchmark_stats build also reports json_stats for one parse and serialize of each corpus." << std::endl;
+}
+
+int main(int argc, char** argv) {
+  size_t mb = 8;
+  int runs = 10;
+  std::string format = "text";
+  size_t mmap_mb = 0;
+  std::vector<std::pair<std::string, std::string>> files;
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg = argv[i];
+    if (i + 1 < argc && arg == "--size") {
+      mb = std::max(1, atoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--runs") {
+      runs = std::max(1, atoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--mmap") {
+      mmap_mb = std::max(1, atoi(argv[++i]));
+    } else if (i + 1 < argc && arg == "--format") {
+      format = argv[++i];
+    } else if (i + 1 < argc && arg == "--file") {
+      const std::string spec = argv[++i];
+      const size_t eq = spec.find('=');
+      if (eq == std::string::npos) {
+        files.emplace_back(spec, spec);
+      } else {
+        files.emplace_back(spec.substr(0, eq), spec.substr(eq + 1));
+      }
+    } else {
+      usage();
+      return arg == "--help" ? 0 : 1;
+    }
+  }
+  if (format != "text" && format != "csv" && format != "json") {
+    usage();
+    return 1;
+  }
+
+  const size_t bytes = mb << 20;
+  std::vector<std::pair<std::string, std::string>> corpora;
+  corpora.emplace_back("twitter", make_twitter_corpus(bytes));
+  corpora.emplace_back("canada", make_canada_corpus(bytes));
+  corpora.emplace_back("citm", make_citm_corpus(bytes));
+  corpora.emplace_back("deep", make_deep_corpus(bytes));
+  corpora.emplace_back("wide", make_wide_corpus(bytes));
+  for (const auto& file : files) {
+    std::string json;
+    if (!read_file(file.second, json)) {
+      std::cerr << file.second << ": file not found!" << std::endl;
+      return 1;
+    }
+    corpora.emplace_back(file.first, std::move(json));
+  }
+
+  std::vector<result> results;
+  std::vector<corpus_stats> stats;
+  for (const auto& corpus : corpora) {
+    run_corpus(corpus.first, corpus.second, runs, results);
+    if (json_stats::enabled) stats.push_back(collect_stats(corpus.first, corpus.second));
+  }
+  corpora.clear();
+  if (mmap_mb) run_files(mmap_mb, runs, results);
+
+  if (format == "csv") {
+    print_csv(results);
+  } else if (format == "json") {
+    print_json(results, stats);
+  } else {
+    print_text(results);
+    if (!stats.empty()) print_stats_text(stats);
+  }
+  return 0;
+}
@@ -2,12 +2,32 @@
 #include <cstring>
 #include <utility>
 #include <vector>
-#include <unordered_map>
-#include <list>
 #include <string>
 #include <cmath>
 #include <limits>
 #include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <cstdio>
+#include <cstdlib>
+#include <cerrno>
+#include <thread>
+#include <atomic>
+#include <tuple>
+#include <array>
+#include <map>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
 
 #define USE_UNICODE false
 
@@ -17,6 +37,38 @@
 #define	FORCE_INLINE inline __attribute__((always_inline))
 #endif
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define TINYJSON_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define TARGET_ISA(isa)
+#else	// defined(_MSC_VER)
+#define TARGET_ISA(isa) __attribute__((target(isa)))
+#endif
+#else
+#define TINYJSON_X86 0
+#endif
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <optional>
+#define TINYJSON_HAS_OPTIONAL 1
+#else
+#define TINYJSON_HAS_OPTIONAL 0
+#endif
+
+// 1 counts what parses and serializes do in json_stats, 0 compiles the counting out
+#ifndef TINYJSON_STATS
+#define TINYJSON_STATS 0
+#endif
+
+#if TINYJSON_STATS
+#include <chrono>
+#define TINYJSON_STAT(statement) statement
+#else
+#define TINYJSON_STAT(statement)
+#endif
+
 #ifndef _ASSERT
 #include <cassert>
 #define _ASSERT(_EXPR) assert(_EXPR)
@@ -33,882 +85,7078 @@ namespace tinyjson {
     return std::fabs(a - b) < dbl_epsilon;
   }
 
-  template <typename K, typename V>
-  class linked_hash_map {
-  public:
-    typedef std::pair<K, V> value_type;
-    typedef typename std::list<value_type>::size_type size_type;
-    typedef typename std::list<value_type>::iterator iterator;
-    typedef typename std::list<value_type>::const_iterator const_iterator;
+  // what the parser and the serializers did on the current thread. only counted when TINYJSON_STATS
+  // is 1, otherwise it stays zero. plain integers, so it can be copied out and exported as it is.
+  struct json_stats {
+    static constexpr bool enabled = TINYJSON_STATS != 0;
+
+    uint64_t bytes_scanned;     // input that went through stage 1
+    uint64_t null_nodes;        // nodes dom_builder created, by type
+    uint64_t boolean_nodes;
+    uint64_t number_nodes;
+    uint64_t string_nodes;
+    uint64_t array_nodes;
+    uint64_t object_nodes;
+    uint64_t allocations;       // heap blocks taken through stats_allocator and memory_arena chunks
+    uint64_t allocated_bytes;
+    uint64_t deallocations;
+    uint64_t number_ns;         // spent decoding numbers and strings, keys included
+    uint64_t string_ns;
+    uint64_t serialized_bytes;  // output of serialize
+    uint32_t max_depth;         // deepest nesting parsed
+
+    // the counters of this thread
+    static json_stats& local() {
+      thread_local json_stats stats = json_stats();
+      return stats;
+    }
+    void reset() { *this = json_stats(); }
+    uint64_t nodes() const {
+      return null_nodes + boolean_nodes + number_nodes + string_nodes + array_nodes + object_nodes;
+    }
+    // adds up the counters of several threads
+    json_stats& operator+=(const json_stats& other) {
+      bytes_scanned += other.bytes_scanned;
+      null_nodes += other.null_nodes;
+      boolean_nodes += other.boolean_nodes;
+      number_nodes += other.number_nodes;
+      string_nodes += other.string_nodes;
+      array_nodes += other.array_nodes;
+      object_nodes += other.object_nodes;
+      allocations += other.allocations;
+      allocated_bytes += other.allocated_bytes;
+      deallocations += other.deallocations;
+      number_ns += other.number_ns;
+      string_ns += other.string_ns;
+      serialized_bytes += other.serialized_bytes;
+      max_depth = std::max(max_depth, other.max_depth);
+      return *this;
+    }
+
+    static FORCE_INLINE void reached(size_t depth) {
+      json_stats& stats = local();
+      if (depth > stats.max_depth) stats.max_depth = static_cast<uint32_t>(depth);
+    }
+    static FORCE_INLINE void allocated(size_t bytes) {
+      json_stats& stats = local();
+      ++stats.allocations;
+      stats.allocated_bytes += bytes;
+    }
+  };
 
+#if TINYJSON_STATS
+  // adds the time until it goes out of scope to a counter
+  class stats_timer {
   public:
-    linked_hash_map() : linked_list(), hash_map() {}
-    linked_hash_map(size_t size) : linked_list(), hash_map() {
-      hash_map.reserve(size);
+    explicit stats_timer(uint64_t& counter) : counter(counter), start(std::chrono::steady_clock::now()) {}
+    ~stats_timer() {
+      counter += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
     }
-    linked_hash_map(const linked_hash_map<K, V>& other) : linked_list(), hash_map() {
-      for(auto citer = other.cbegin(); citer != other.cend(); citer++) {
-        insert(*citer);
+
+  private:
+    uint64_t& counter;
+    std::chrono::steady_clock::time_point start;
+  };
+#endif
+
+  // FNV-1a, works with any std::basic_string allocator
+  struct string_hash {
+    template <typename C>
+    static FORCE_INLINE size_t hash(const C* str, size_t length) {
+      uint64_t h = 14695981039346656037ULL;
+      for (size_t i = 0; i < length; ++i) {
+        h ^= static_cast<uint64_t>(str[i]);
+        h *= 1099511628211ULL;
       }
+      return static_cast<size_t>(h);
     }
+    template <typename S>
+    FORCE_INLINE size_t operator()(const S& str) const {
+      return hash(str.data(), str.size());
+    }
+  };
 
-    FORCE_INLINE auto insert(const value_type& value) {
-      linked_list.emplace_back(value);
-      return hash_map.insert(std::make_pair(value.first, std::prev(linked_list.end())));
+  // where memory comes from, chosen at runtime. the same shape as std::pmr::memory_resource so pools,
+  // per request buffers or huge page backed blocks can be plugged in without changing any types.
+  class memory_resource {
+  public:
+    virtual ~memory_resource() {}
+
+    FORCE_INLINE void* allocate(size_t size, size_t align = alignof(std::max_align_t)) { return do_allocate(size, align); }
+    FORCE_INLINE void deallocate(void* p, size_t size, size_t align = alignof(std::max_align_t)) {
+      do_deallocate(p, size, align);
     }
+    FORCE_INLINE bool is_equal(const memory_resource& other) const noexcept { return this == &other || do_is_equal(other); }
 
-    FORCE_INLINE bool erase(const K& key) {
-      typename std::unordered_map<K, iterator>::iterator iter = hash_map.find(key);
-      if (iter == hash_map.end()) {
-        return false;
-      }
-      linked_list.erase(iter->second);
-      hash_map.erase(iter);
-      return true;
+  protected:
+    virtual void* do_allocate(size_t size, size_t align) = 0;
+    virtual void do_deallocate(void* p, size_t size, size_t align) = 0;
+    virtual bool do_is_equal(const memory_resource& other) const noexcept { return this == &other; }
+  };
+
+  // the global heap
+  class new_delete_resource : public memory_resource {
+  public:
+    static new_delete_resource* get() {
+      static new_delete_resource resource;
+      return &resource;
     }
 
-    FORCE_INLINE size_type size() const {
-      return linked_list.size();
+  protected:
+    void* do_allocate(size_t size, size_t) override { return ::operator new(size); }
+    void do_deallocate(void* p, size_t, size_t) override { ::operator delete(p); }
+
+  private:
+    new_delete_resource() {}
+  };
+
+  // bump allocator. memory is handed out from chunks and only ever given back all at once,
+  // either by reset() which keeps the last chunk around for reuse or by release().
+  // chunks come from the global heap, or from upstream when one is given.
+  class memory_arena {
+  public:
+    static const size_t default_chunk_size = 64 * 1024;
+
+    explicit memory_arena(size_t chunk_size = default_chunk_size, memory_resource* upstream = nullptr)
+      : head(nullptr), chunk_size(chunk_size < sizeof(chunk) ? sizeof(chunk) : chunk_size), upstream(upstream) {}
+    memory_arena(const memory_arena&) = delete;
+    memory_arena& operator=(const memory_arena&) = delete;
+    ~memory_arena() {
+      release();
     }
 
-    FORCE_INLINE bool empty() const {
-      return linked_list.empty();
+    FORCE_INLINE void* allocate(size_t size, size_t align = alignof(std::max_align_t)) {
+      if (head) {
+        size_t offset = (head->used + align - 1) & ~(align - 1);
+        if (offset + size <= head->capacity) {
+          head->used = offset + size;
+          return head->data() + offset;
+        }
+      }
+      return allocate_slow(size, align);
     }
 
-    FORCE_INLINE iterator find(const K& key) {
-      typename std::unordered_map<K, iterator>::iterator iter = hash_map.find(key);
-      return iter != hash_map.end() ? iter->second : end();
+    void reset() {
+      if (!head) return;
+      free_chunks(head->next);
+      head->next = nullptr;
+      head->used = 0;
     }
 
-    FORCE_INLINE const_iterator find(const K& key) const {
-      typename std::unordered_map<K, iterator>::const_iterator citer = hash_map.find(key);
-      return citer != hash_map.cend() ? citer->second : cend();
+    void release() {
+      free_chunks(head);
+      head = nullptr;
     }
 
-    FORCE_INLINE iterator begin() { return linked_list.begin(); }
-    FORCE_INLINE iterator end() { return linked_list.end(); }
-    FORCE_INLINE const_iterator cbegin() const { return linked_list.cbegin(); }
-    FORCE_INLINE const_iterator cend() const { return linked_list.cend(); }
+    size_t capacity() const {
+      size_t total = 0;
+      for (const chunk* c = head; c; c = c->next) total += c->capacity;
+      return total;
+    }
+
+    size_t size() const {
+      size_t total = 0;
+      for (const chunk* c = head; c; c = c->next) total += c->used;
+      return total;
+    }
 
   private:
-    std::list<value_type> linked_list;
-    std::unordered_map<K, iterator> hash_map;
-  };
+    struct chunk {
+      chunk* next;
+      size_t capacity;
+      size_t used;
+      FORCE_INLINE char* data() { return reinterpret_cast<char*>(this) + header_size(); }
+    };
 
-  enum class node_type {
-    null_type = 0,
-    boolean_type,
-    number_type,
-    string_type,
-    array_type,
-    object_type
+    static constexpr size_t header_size() {
+      return (sizeof(chunk) + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1);
+    }
+
+    void* allocate_slow(size_t size, size_t align) {
+      // chunks grow geometrically so reset() keeps the biggest one
+      size_t capacity = head ? head->capacity * 2 : chunk_size;
+      if (capacity < size + align) capacity = size + align;
+      chunk* c = static_cast<chunk*>(upstream ? upstream->allocate(header_size() + capacity)
+                                              : ::operator new(header_size() + capacity));
+      TINYJSON_STAT(json_stats::allocated(header_size() + capacity));
+      c->next = head;
+      c->capacity = capacity;
+      c->used = 0;
+      head = c;
+      return allocate(size, align);
+    }
+
+    void free_chunks(chunk* c) {
+      while (c) {
+        chunk* next = c->next;
+        if (upstream) {
+          upstream->deallocate(c, header_size() + c->capacity);
+        } else {
+          ::operator delete(c);
+        }
+        c = next;
+      }
+    }
+
+    chunk* head;
+    size_t chunk_size;
+    memory_resource* upstream;
   };
 
-  enum class token_type {
-    start_object = '{',
-    end_object = '}',
-    start_array = '[',
-    end_array = ']',
-    double_quote = '\"',
-    colon = ':',
-    comma = ','
+  // std allocator adaptor over memory_arena. deallocate is a no-op, the arena owns everything.
+  // a default constructed arena_allocator has no arena and falls back to the global heap.
+  template <typename T>
+  class arena_allocator {
+  public:
+    typedef T value_type;
+
+    arena_allocator() noexcept : arena(nullptr) {}
+    explicit arena_allocator(memory_arena* arena) noexcept : arena(arena) {}
+    template <typename U>
+    arena_allocator(const arena_allocator<U>& other) noexcept : arena(other.get_arena()) {}
+
+    FORCE_INLINE T* allocate(size_t n) {
+      if (!arena) return static_cast<T*>(::operator new(n * sizeof(T)));
+      return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T)));
+    }
+    FORCE_INLINE void deallocate(T* p, size_t) noexcept {
+      if (!arena) ::operator delete(p);
+    }
+    FORCE_INLINE memory_arena* get_arena() const noexcept { return arena; }
+
+  private:
+    memory_arena* arena;
   };
 
-  FORCE_INLINE bool operator==(const char a, const token_type b) {
-    return static_cast<token_type>(a) == b;
+  template <typename T, typename U>
+  FORCE_INLINE bool operator==(const arena_allocator<T>& a, const arena_allocator<U>& b) {
+    return a.get_arena() == b.get_arena();
   }
 
-  FORCE_INLINE bool operator!=(const char a, const token_type b) {
-    return static_cast<token_type>(a) != b;
+  template <typename T, typename U>
+  FORCE_INLINE bool operator!=(const arena_allocator<T>& a, const arena_allocator<U>& b) {
+    return a.get_arena() != b.get_arena();
   }
 
-  // https://stackoverflow.com/questions/2302969/convert-a-float-to-a-string
-  static double PRECISION = 0.00000000000001;
-  static const int MAX_NUMBER_STRING_SIZE = 32;
-  static char * dtoa(char *s, double n) {
-    // handle special cases
-    if (std::isnan(n)) {
-      strcpy(s, "nan");
-    } else if (std::isinf(n)) {
-      strcpy(s, "inf");
-    } else if (n == 0.0) {
-      strcpy(s, "0");
-    } else {
-      int digit, m, m1;
-      char *c = s;
-      int neg = (n < 0);
-      if (neg)
-        n = -n;
-      // calculate magnitude
-      m = log10(n);
-      int useExp = (m >= 14 || (neg && m >= 9) || m <= -9);
-      if (neg)
-        *(c++) = '-';
-      // set up for scientific notation
-      if (useExp) {
-        if (m < 0)
-          m -= 1.0;
-        n = n / pow(10.0, m);
-        m1 = m;
-        m = 0;
-      }
-      if (m < 1.0) {
-        m = 0;
-      }
-      // convert the number
-      while (n > PRECISION || m >= 0) {
-        double weight = pow(10.0, m);
-        if (weight > 0 && !std::isinf(weight)) {
-          digit = floor(n / weight);
-          n -= (digit * weight);
-          *(c++) = '0' + digit;
-        }
-        if (m == 0 && n > 0)
-          *(c++) = '.';
-        m--;
-      }
-      if (useExp) {
-        // convert the exponent
-        int i, j;
-        *(c++) = 'e';
-        if (m1 > 0) {
-          *(c++) = '+';
-        } else {
-          *(c++) = '-';
-          m1 = -m1;
-        }
-        m = 0;
-        while (m1 > 0) {
-          *(c++) = '0' + m1 % 10;
-          m1 /= 10;
-          m++;
-        }
-        c -= m;
-        for (i = 0, j = m-1; i<j; i++, j--) {
-          // swap without temporary
-          c[i] ^= c[j];
-          c[j] ^= c[i];
-          c[i] ^= c[j];
-        }
-        c += m;
-      }
-      *(c) = '\0';
-    }
-    return s;
-  }
+  // a memory_resource over its own memory_arena: deallocate does nothing and release() frees it all.
+  // one per request makes a monotonic buffer that is thrown away with the request.
+  class arena_resource : public memory_resource {
+  public:
+    explicit arena_resource(size_t chunk_size = memory_arena::default_chunk_size, memory_resource* upstream = nullptr)
+      : arena(chunk_size, upstream) {}
 
-  // https://github.com/syoyo/tinyobjloader/blob/master/tiny_obj_loader.h
-  static bool atod(const char *s, const char *s_end, double *result) {
-    if (s >= s_end) {
-      return false;
-    }
+    FORCE_INLINE void reset() { arena.reset(); }
+    FORCE_INLINE void release() { arena.release(); }
+    FORCE_INLINE memory_arena& get_arena() { return arena; }
 
-    double mantissa = 0.0;
-    // This exponent is base 2 rather than 10.
-    // However the exponent we parse is supposed to be one of ten,
-    // thus we must take care to convert the exponent/and or the
-    // mantissa to a * 2^E, where a is the mantissa and E is the
-    // exponent.
-    // To get the final double we will use ldexp, it requires the
-    // exponent to be in base 2.
-    int exponent = 0;
-
-    // NOTE: THESE MUST BE DECLARED HERE SINCE WE ARE NOT ALLOWED
-    // TO JUMP OVER DEFINITIONS.
-    char sign = '+';
-    char exp_sign = '+';
-    char const *curr = s;
-
-    // How many characters were read in a loop.
-    int read = 0;
-    // Tells whether a loop terminated due to reaching s_end.
-    bool end_not_reached = false;
-    bool leading_decimal_dots = false;
-
-    /*
-            BEGIN PARSING.
-    */
-
-    // Find out what sign we've got.
-    if (*curr == '+' || *curr == '-') {
-      sign = *curr;
-      curr++;
-      if ((curr != s_end) && (*curr == '.')) {
-        // accept. Somethig like `.7e+2`, `-.5234`
-        leading_decimal_dots = true;
-      }
-    } else if (is_digit(*curr)) { /* Pass through. */
-    } else if (*curr == '.') {
-      // accept. Somethig like `.7e+2`, `-.5234`
-      leading_decimal_dots = true;
-    } else {
-      goto fail;
-    }
-
-    // Read the integer part.
-    end_not_reached = (curr != s_end);
-    if (!leading_decimal_dots) {
-      while (end_not_reached && is_digit(*curr)) {
-        mantissa *= 10;
-        mantissa += static_cast<int>(*curr - 0x30);
-        curr++;
-        read++;
-        end_not_reached = (curr != s_end);
-      }
-
-      // We must make sure we actually got something.
-      if (read == 0) goto fail;
-    }
-
-    // We allow numbers of form "#", "###" etc.
-    if (!end_not_reached) goto assemble;
-
-    // Read the decimal part.
-    if (*curr == '.') {
-      curr++;
-      read = 1;
-      end_not_reached = (curr != s_end);
-      while (end_not_reached && is_digit(*curr)) {
-        static const double pow_lut[] = {
-                1.0, 0.1, 0.01, 0.001, 0.0001, 0.00001, 0.000001, 0.0000001,
-        };
-        const int lut_entries = sizeof pow_lut / sizeof pow_lut[0];
-
-        // NOTE: Don't use powf here, it will absolutely murder precision.
-        mantissa += static_cast<int>(*curr - 0x30) *
-                    (read < lut_entries ? pow_lut[read] : std::pow(10.0, -read));
-        read++;
-        curr++;
-        end_not_reached = (curr != s_end);
-      }
-    } else if (*curr == 'e' || *curr == 'E') {
-    } else {
-      goto assemble;
-    }
+  protected:
+    void* do_allocate(size_t size, size_t align) override { return arena.allocate(size, align); }
+    void do_deallocate(void*, size_t, size_t) override {}
 
-    if (!end_not_reached) goto assemble;
+  private:
+    memory_arena arena;
+  };
 
-    // Read the exponent part.
-    if (*curr == 'e' || *curr == 'E') {
-      curr++;
-      // Figure out if a sign is present and if it is.
-      end_not_reached = (curr != s_end);
-      if (end_not_reached && (*curr == '+' || *curr == '-')) {
-        exp_sign = *curr;
-        curr++;
-      } else if (is_digit(*curr)) { /* Pass through. */
-      } else {
-        // Empty E is not allowed.
-        goto fail;
-      }
+  // std allocator adaptor over a memory_resource, like std::pmr::polymorphic_allocator. the resource
+  // is picked when a tree is made, basic_json_node<resource_allocator<char>> is resource_node.
+  // a default constructed one uses new_delete_resource.
+  template <typename T>
+  class resource_allocator {
+  public:
+    typedef T value_type;
 
-      read = 0;
-      end_not_reached = (curr != s_end);
-      while (end_not_reached && is_digit(*curr)) {
-        exponent *= 10;
-        exponent += static_cast<int>(*curr - 0x30);
-        curr++;
-        read++;
-        end_not_reached = (curr != s_end);
-      }
-      exponent *= (exp_sign == '+' ? 1 : -1);
-      if (read == 0) goto fail;
-    }
+    resource_allocator() noexcept : resource(new_delete_resource::get()) {}
+    explicit resource_allocator(memory_resource* resource) noexcept : resource(resource) {}
+    template <typename U>
+    resource_allocator(const resource_allocator<U>& other) noexcept : resource(other.get_resource()) {}
 
-    assemble:
-    *result = (sign == '+' ? 1 : -1) *
-              (exponent ? std::ldexp(mantissa * std::pow(5.0, exponent), exponent)
-                        : mantissa);
-    return true;
-    fail:
-    return false;
+    FORCE_INLINE T* allocate(size_t n) { return static_cast<T*>(resource->allocate(n * sizeof(T), alignof(T))); }
+    FORCE_INLINE void deallocate(T* p, size_t n) noexcept { resource->deallocate(p, n * sizeof(T), alignof(T)); }
+    FORCE_INLINE memory_resource* get_resource() const noexcept { return resource; }
+
+  private:
+    memory_resource* resource;
+  };
+
+  template <typename T, typename U>
+  FORCE_INLINE bool operator==(const resource_allocator<T>& a, const resource_allocator<U>& b) {
+    return a.get_resource()->is_equal(*b.get_resource());
   }
 
-  class json_node {
-    friend class json_parser;
+  template <typename T, typename U>
+  FORCE_INLINE bool operator!=(const resource_allocator<T>& a, const resource_allocator<U>& b) {
+    return !(a == b);
+  }
+
+  // std allocator adaptor that counts what goes through it in json_stats and leaves the work to Base.
+  // without TINYJSON_STATS it only forwards. basic_json_node<stats_allocator<char>> counts a tree.
+  template <typename T, typename Base = std::allocator<T>>
+  class stats_allocator {
   public:
-    typedef bool boolean;
-    typedef double number;
-#if USE_UNICODE
-    typedef std::u16string string;
-#else
-    typedef std::string string;
-#endif
-    typedef std::vector<json_node*> array;
-    typedef linked_hash_map<string, json_node*> object;
-    union Storage {
-      boolean bool_val;
-      number num_val;
-      string* str_val;
-      array* array_val;
-      object* object_val;
+    typedef T value_type;
+    template <typename U>
+    struct rebind {
+      typedef stats_allocator<U, typename std::allocator_traits<Base>::template rebind_alloc<U>> other;
     };
 
-    FORCE_INLINE json_node() : storage(), type(node_type::null_type) {}
-    FORCE_INLINE json_node(const json_node& other) : storage(), type() { *this = other; }
-    explicit json_node(boolean val) : storage(), type(node_type::boolean_type) { storage.bool_val = val; }
-    explicit json_node(number val) : storage(), type(node_type::number_type) { storage.num_val = val; }
-    explicit json_node(const string& val) : storage(), type(node_type::string_type) { storage.str_val = new string(val); }
+    stats_allocator() noexcept : base() {}
+    explicit stats_allocator(const Base& base) noexcept : base(base) {}
+    template <typename U, typename B>
+    stats_allocator(const stats_allocator<U, B>& other) noexcept : base(other.get_base()) {}
+
+    FORCE_INLINE T* allocate(size_t n) {
+      TINYJSON_STAT(json_stats::allocated(n * sizeof(T)));
+      return std::allocator_traits<Base>::allocate(base, n);
+    }
+    FORCE_INLINE void deallocate(T* p, size_t n) noexcept {
+      TINYJSON_STAT(++json_stats::local().deallocations);
+      std::allocator_traits<Base>::deallocate(base, p, n);
+    }
+    FORCE_INLINE const Base& get_base() const noexcept { return base; }
+
+  private:
+    Base base;
+  };
+
+  template <typename T, typename A, typename U, typename B>
+  FORCE_INLINE bool operator==(const stats_allocator<T, A>& a, const stats_allocator<U, B>& b) {
+    return a.get_base() == b.get_base();
+  }
+
+  template <typename T, typename A, typename U, typename B>
+  FORCE_INLINE bool operator!=(const stats_allocator<T, A>& a, const stats_allocator<U, B>& b) {
+    return !(a == b);
+  }
+
+  // true when everything handed out by the allocator is given back in bulk,
+  // so trees built with it can be dropped without walking them.
+  template <typename Alloc>
+  FORCE_INLINE bool releases_in_bulk(const Alloc&) { return false; }
+
+  template <typename T>
+  FORCE_INLINE bool releases_in_bulk(const arena_allocator<T>& alloc) { return alloc.get_arena() != nullptr; }
 
 #if USE_UNICODE
-    explicit json_node(const char16_t* val) : storage(), type(node_type::string_type) { storage.str_val = new string(val); }
+  typedef char16_t json_char;
 #else
-    explicit json_node(const char* val) : storage(), type(node_type::string_type) { storage.str_val = new string(val); }
+  typedef char json_char;
 #endif
-    explicit json_node(const array& val) : storage(), type() { set(val); }
-    explicit json_node(const object& val) : storage(), type() { set(val); }
-    ~json_node() {
-      clear();
+
+  // non owning reference to characters somebody else keeps alive
+  template <typename CharT>
+  class basic_string_view {
+  public:
+    typedef CharT value_type;
+    typedef const CharT* const_iterator;
+
+    FORCE_INLINE basic_string_view() : ptr(nullptr), len(0) {}
+    FORCE_INLINE basic_string_view(const CharT* str) : ptr(str), len(std::char_traits<CharT>::length(str)) {}
+    FORCE_INLINE basic_string_view(const CharT* str, size_t length) : ptr(str), len(length) {}
+    template <typename Traits, typename Alloc>
+    FORCE_INLINE basic_string_view(const std::basic_string<CharT, Traits, Alloc>& str) : ptr(str.data()), len(str.size()) {}
+
+    FORCE_INLINE const CharT* data() const { return ptr; }
+    FORCE_INLINE size_t size() const { return len; }
+    FORCE_INLINE size_t length() const { return len; }
+    FORCE_INLINE bool empty() const { return len == 0; }
+    FORCE_INLINE const_iterator begin() const { return ptr; }
+    FORCE_INLINE const_iterator end() const { return ptr + len; }
+    FORCE_INLINE CharT operator[](size_t index) const { return ptr[index]; }
+    FORCE_INLINE std::basic_string<CharT> str() const { return std::basic_string<CharT>(ptr, len); }
+
+    FORCE_INLINE bool operator==(const basic_string_view& other) const {
+      return len == other.len && std::char_traits<CharT>::compare(ptr, other.ptr, len) == 0;
+    }
+    FORCE_INLINE bool operator!=(const basic_string_view& other) const {
+      return !(*this == other);
     }
 
-    FORCE_INLINE json_node& get_node(const string& key) {
-      static json_node null_node;
-      if (!is_object()) return null_node;
-      object::iterator iter = storage.object_val->find(key);
-      return iter != storage.object_val->end() ? *(iter->second) : null_node;
+  private:
+    const CharT* ptr;
+    size_t len;
+  };
+
+  typedef basic_string_view<json_char> string_view;
+
+  template <typename CharT>
+  std::basic_ostream<CharT>& operator<<(std::basic_ostream<CharT>& os, const basic_string_view<CharT>& str) {
+    return os.write(str.data(), str.size());
+  }
+
+  // how a node string is made out of characters. owning strings always copy them with the node allocator,
+  // views keep pointing at the characters they were given unless asked to copy them into the allocator.
+  template <typename String>
+  struct string_traits {
+    template <typename Alloc>
+    static FORCE_INLINE String empty(const Alloc& alloc) {
+      return String(alloc);
     }
-    FORCE_INLINE const json_node& get_node(const string& key) const {
-      static const json_node null_node;
-      if (!is_object()) return null_node;
-      object::const_iterator citer = storage.object_val->find(key);
-      return citer != storage.object_val->cend() ? *(citer->second) : null_node;
+    template <typename Alloc>
+    static FORCE_INLINE String copy(const json_char* str, size_t length, const Alloc& alloc) {
+      return String(str, length, alloc);
     }
-    FORCE_INLINE json_node& get_element(const size_t index) {
-      static json_node null_node;
-      if (!is_array()) return null_node;
-      return index < storage.array_val->size() ? *(*storage.array_val)[index] : null_node;
+    // moves the characters over when the allocators agree
+    template <typename Alloc>
+    static FORCE_INLINE String take(String&& str, const Alloc& alloc) {
+      return String(std::move(str), typename String::allocator_type(alloc));
     }
-    FORCE_INLINE const json_node& get_element(const size_t index) const {
-      static const json_node null_node;
-      if (!is_array()) return null_node;
-      return index < storage.array_val->size() ? *(*storage.array_val)[index] : null_node;
+    template <typename Alloc>
+    static FORCE_INLINE void borrow(String& target, const json_char* str, size_t length, const Alloc&) {
+      target.assign(str, length);
     }
-    FORCE_INLINE boolean get_boolean() const {
-      _ASSERT(is_boolean());
-      return storage.bool_val;
+    // borrow() text that outlives the string, copy() anything else
+    template <typename Alloc>
+    static FORCE_INLINE void assign(String& target, const json_char* str, size_t length, bool, const Alloc&) {
+      target.assign(str, length);
     }
-    FORCE_INLINE number get_number() const {
-      _ASSERT(is_number());
-      return storage.num_val;
+    // hands out room for length characters that end up in target, resize() trims it afterwards
+    template <typename Alloc>
+    static FORCE_INLINE json_char* reserve(String& target, size_t length, const Alloc&) {
+      target.resize(length);
+      return &target[0];
     }
-    FORCE_INLINE string& get_string() const {
-      _ASSERT(is_string());
-      return *(storage.str_val);
+    static FORCE_INLINE void resize(String& target, size_t length) {
+      target.resize(length);
     }
-    FORCE_INLINE array& get_array() const {
-      _ASSERT(is_array());
-      return *(storage.array_val);
+  };
+
+  template <typename CharT>
+  struct string_traits<basic_string_view<CharT>> {
+    typedef basic_string_view<CharT> view;
+
+    template <typename Alloc>
+    static FORCE_INLINE view empty(const Alloc&) {
+      return view();
     }
-    FORCE_INLINE object& get_object() const {
-      _ASSERT(is_object());
-      return *(storage.object_val);
+    template <typename Alloc>
+    static FORCE_INLINE view copy(const CharT* str, size_t length, const Alloc& alloc) {
+      CharT* buf = reserve_chars(length, alloc);
+      std::char_traits<CharT>::copy(buf, str, length);
+      return view(buf, length);
     }
-    FORCE_INLINE json_node& operator[](size_t index) { return this->get_element(index); }
-    FORCE_INLINE const json_node& operator[](size_t index) const { return this->get_element(index); }
-    FORCE_INLINE json_node& operator[](const string& key) { return this->get_node(key); }
-    FORCE_INLINE const json_node& operator[](const string& key) const { return this->get_node(key); }
-    FORCE_INLINE bool has(const string& key) const {
-      if(!is_object()) return false;
-      return storage.object_val->find(key) != storage.object_val->cend();
+    template <typename Alloc>
+    static FORCE_INLINE view take(view&& str, const Alloc& alloc) {
+      return copy(str.data(), str.size(), alloc);
     }
-    FORCE_INLINE size_t length() const {
-      switch (type) {
-        case node_type::string_type:
-          return storage.str_val->size();
-        case node_type::array_type:
-          return storage.array_val->size();
-        case node_type::object_type:
-          return storage.object_val->size();
-        default:
-          return 0;
-      }
+    template <typename Alloc>
+    static FORCE_INLINE void borrow(view& target, const CharT* str, size_t length, const Alloc&) {
+      target = view(str, length);
     }
-    FORCE_INLINE std::string to_string() const {
-      switch (type) {
-        case node_type::string_type:
-          return "string";
-        case node_type::object_type:
-          return "object";
-        case node_type::array_type:
-          return "array";
-        case node_type::null_type:
-          return "null";
-        case node_type::number_type:
-          return "number";
-        case node_type::boolean_type:
-          return "boolean";
-      }
+    template <typename Alloc>
+    static FORCE_INLINE void assign(view& target, const CharT* str, size_t length, bool transient, const Alloc& alloc) {
+      target = transient ? copy(str, length, alloc) : view(str, length);
     }
-    FORCE_INLINE bool to_boolean() const {
-      switch (type) {
-        case node_type::null_type:
-          return false;
-        case node_type::boolean_type:
-          return storage.bool_val;
-        case node_type::number_type:
-          return storage.num_val != 0;
-        case node_type::string_type:
-          return !storage.str_val->empty();
-        default:
-          return true;
-      }
+    template <typename Alloc>
+    static FORCE_INLINE CharT* reserve(view& target, size_t length, const Alloc& alloc) {
+      CharT* buf = reserve_chars(length, alloc);
+      target = view(buf, length);
+      return buf;
     }
-    FORCE_INLINE string serialize(bool prettify = false, unsigned int indent_size = 2) const {
-      string s;
-      std::back_insert_iterator<string> iter = std::back_inserter(s);
-      _serialize(prettify ? 0 : -1, iter, indent_size);
-      return s;
+    static FORCE_INLINE void resize(view& target, size_t length) {
+      target = view(target.data(), length);
     }
-    FORCE_INLINE json_node& operator=(const json_node& other) {
-      if (this != &other) {
-        clear();
-
-        switch (other.type) {
-          case node_type::string_type:
-            set(*other.storage.str_val);
-            break;
-          case node_type::array_type:
-            set(*other.storage.array_val);
-            break;
-          case node_type::object_type:
-            set(*other.storage.object_val);
-            break;
-          default:
-            type = other.type;
-            storage = other.storage;
-            break;
-        }
-      }
 
-      return *this;
+  private:
+    template <typename Alloc>
+    static FORCE_INLINE CharT* reserve_chars(size_t length, const Alloc& alloc) {
+      typename std::allocator_traits<Alloc>::template rebind_alloc<CharT> a(alloc);
+      return length ? a.allocate(length) : nullptr;
     }
-    FORCE_INLINE json_node& operator=(const boolean other) {
-      clear();
-      set(other);
-      return *this;
+  };
+
+  // one shared copy of each distinct object key. a document or parser that interns its keys here
+  // points every member key at the table instead of copying it, and hands the map the hash the
+  // table already has. a lookup with an interned key is settled by comparing pointers.
+  // the table only grows and is not thread safe; it has to outlive every document using it.
+  class key_table {
+  public:
+    struct symbol {
+      const json_char* str;
+      uint32_t length;
+      uint32_t hash;
+
+      FORCE_INLINE basic_string_view<json_char> key() const { return basic_string_view<json_char>(str, length); }
+    };
+    // a feed with keys made of data, like ids, would otherwise grow the table without end
+    static const size_t default_max_keys = 1 << 16;
+
+    explicit key_table(size_t max_keys = default_max_keys)
+      : arena(4096), count(0), max_keys(max_keys) {}
+    key_table(const key_table&) = delete;
+    key_table& operator=(const key_table&) = delete;
+
+    // the interned key, or nullptr when the table is full and the key is not in it
+    const symbol* intern(const json_char* str, size_t length) {
+      const uint32_t hash = static_cast<uint32_t>(string_hash::hash(str, length));
+      if (!slots.empty()) {
+        const size_t mask = slots.size() - 1;
+        for (size_t pos = hash & mask; slots[pos]; pos = (pos + 1) & mask) {
+          const symbol* sym = slots[pos];
+          if (sym->hash == hash && sym->length == length && std::char_traits<json_char>::compare(sym->str, str, length) == 0) {
+            return sym;
+          }
+        }
+      }
+      if (count >= max_keys || length > std::numeric_limits<uint32_t>::max()) return nullptr;
+      if ((count + 1) * 2 > slots.size()) grow();
+
+      symbol* sym = static_cast<symbol*>(arena.allocate(sizeof(symbol) + length * sizeof(json_char), alignof(symbol)));
+      json_char* chars = reinterpret_cast<json_char*>(sym + 1);
+      std::char_traits<json_char>::copy(chars, str, length);
+      sym->str = chars;
+      sym->length = static_cast<uint32_t>(length);
+      sym->hash = hash;
+      place(sym);
+      ++count;
+      return sym;
+    }
+    FORCE_INLINE const symbol* intern(basic_string_view<json_char> key) {
+      return intern(key.data(), key.size());
+    }
+
+    FORCE_INLINE size_t size() const { return count; }
+    // drops every key, only once no document points at them any more
+    void clear() {
+      slots.clear();
+      arena.release();
+      count = 0;
+    }
+
+  private:
+    FORCE_INLINE void place(const symbol* sym) {
+      const size_t mask = slots.size() - 1;
+      size_t pos = sym->hash & mask;
+      while (slots[pos]) pos = (pos + 1) & mask;
+      slots[pos] = sym;
+    }
+    void grow() {
+      std::vector<const symbol*> old(std::max<size_t>(64, slots.size() * 2), nullptr);
+      old.swap(slots);
+      for (const symbol* sym : old) {
+        if (sym) place(sym);
+      }
+    }
+
+    memory_arena arena;
+    std::vector<const symbol*> slots;
+    size_t count;
+    size_t max_keys;
+  };
+
+  // insertion ordered map over contiguous storage. members live in one vector in the order they were
+  // inserted; small maps are searched linearly and bigger ones get an open addressing index on top.
+  template <typename K, typename V, typename Alloc = std::allocator<std::pair<K, V>>>
+  class linked_hash_map {
+  public:
+    typedef std::pair<K, V> value_type;
+    typedef typename K::value_type char_type;
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<value_type> entry_allocator;
+    typedef std::vector<value_type, entry_allocator> entry_type;
+    typedef typename entry_type::size_type size_type;
+    typedef typename entry_type::iterator iterator;
+    typedef typename entry_type::const_iterator const_iterator;
+    // maps up to this size are scanned linearly, that beats hashing the key for them
+    static const size_type linear_limit = 16;
+
+  private:
+    struct slot {
+      uint32_t index; // entry index + 1, 0 means empty
+      uint32_t hash;
+    };
+    typedef typename std::allocator_traits<Alloc>::template rebind_alloc<slot> slot_allocator;
+    typedef std::vector<slot, slot_allocator> index_type;
+
+  public:
+    explicit linked_hash_map(const Alloc& alloc = Alloc())
+      : entries(entry_allocator(alloc)), index(slot_allocator(alloc)) {}
+    linked_hash_map(size_t size, const Alloc& alloc = Alloc())
+      : entries(entry_allocator(alloc)), index(slot_allocator(alloc)) {
+      reserve(size);
+    }
+    linked_hash_map(const linked_hash_map& other)
+      : entries(other.entries), index(other.index) {}
+    linked_hash_map(linked_hash_map&& other) noexcept
+      : entries(std::move(other.entries)), index(std::move(other.index)) {}
+    linked_hash_map& operator=(const linked_hash_map& other) = default;
+    linked_hash_map& operator=(linked_hash_map&& other) = default;
+
+    // always appends, a duplicated key stays reachable through iteration but find() returns the first one
+    FORCE_INLINE std::pair<iterator, bool> insert(const value_type& value) {
+      return insert_entry(value);
+    }
+
+    FORCE_INLINE std::pair<iterator, bool> insert(value_type&& value) {
+      return insert_entry(std::move(value));
+    }
+
+    // with the string_hash of the key worked out ahead, e.g. by a key_table
+    FORCE_INLINE std::pair<iterator, bool> insert(value_type&& value, uint32_t hash) {
+      return insert_entry(std::move(value), hash);
+    }
+
+    bool erase(const K& key) {
+      iterator iter = find(key);
+      if (iter == end()) {
+        return false;
+      }
+      entries.erase(iter);
+      if (!index.empty()) {
+        rebuild_index(index.size());
+      }
+      return true;
+    }
+
+    FORCE_INLINE void reserve(size_type size) {
+      entries.reserve(size);
+      if (size > linear_limit && index.size() < index_size_for(size)) {
+        rebuild_index(index_size_for(size));
+      }
+    }
+
+    FORCE_INLINE size_type size() const {
+      return entries.size();
+    }
+
+    FORCE_INLINE bool empty() const {
+      return entries.empty();
+    }
+
+    FORCE_INLINE entry_allocator get_allocator() const {
+      return entries.get_allocator();
+    }
+
+    FORCE_INLINE iterator find(const K& key) {
+      return begin() + find_index(key.data(), key.size());
+    }
+
+    FORCE_INLINE const_iterator find(const K& key) const {
+      return cbegin() + find_index(key.data(), key.size());
+    }
+
+    FORCE_INLINE iterator find(const char_type* key, size_t length) {
+      return begin() + find_index(key, length);
+    }
+
+    FORCE_INLINE const_iterator find(const char_type* key, size_t length) const {
+      return cbegin() + find_index(key, length);
+    }
+
+    // with the string_hash of the key worked out ahead, for keys that are looked up again and again
+    FORCE_INLINE const_iterator find(const char_type* key, size_t length, uint32_t hash) const {
+      return cbegin() + find_index(key, length, hash);
+    }
+
+    FORCE_INLINE iterator begin() { return entries.begin(); }
+    FORCE_INLINE iterator end() { return entries.end(); }
+    FORCE_INLINE const_iterator begin() const { return entries.cbegin(); }
+    FORCE_INLINE const_iterator end() const { return entries.cend(); }
+    FORCE_INLINE const_iterator cbegin() const { return entries.cbegin(); }
+    FORCE_INLINE const_iterator cend() const { return entries.cend(); }
+
+  private:
+    static FORCE_INLINE bool key_equal(const K& key, const char_type* str, size_t length) {
+      if (key.size() != length) return false;
+      const char_type* data = key.data();
+      // keys from the same key_table share their characters
+      if (data == str) return true;
+      // most keys differ in their first character, settle that before calling into compare
+      return length == 0 || (data[0] == str[0] && std::char_traits<char_type>::compare(data + 1, str + 1, length - 1) == 0);
+    }
+
+    static FORCE_INLINE size_t index_size_for(size_type size) {
+      size_t capacity = 32;
+      while (capacity < size * 2) capacity <<= 1;
+      return capacity;
+    }
+
+    // position of the first entry with the key, or size() when there is none
+    FORCE_INLINE size_type find_index(const char_type* key, size_t length) const {
+      if (index.empty()) return scan_index(key, length);
+      return find_index(key, length, static_cast<uint32_t>(string_hash::hash(key, length)));
+    }
+
+    FORCE_INLINE size_type scan_index(const char_type* key, size_t length) const {
+      size_type i = 0;
+      const size_type n = entries.size();
+      for (; i < n; ++i) {
+        if (key_equal(entries[i].first, key, length)) break;
+      }
+      return i;
+    }
+
+    FORCE_INLINE size_type find_index(const char_type* key, size_t length, uint32_t hash) const {
+      if (index.empty()) return scan_index(key, length);
+      const size_t mask = index.size() - 1;
+      for (size_t pos = hash & mask; index[pos].index; pos = (pos + 1) & mask) {
+        const slot& s = index[pos];
+        if (s.hash == hash && key_equal(entries[s.index - 1].first, key, length)) {
+          return s.index - 1;
+        }
+      }
+      return entries.size();
+    }
+
+    template <typename T>
+    FORCE_INLINE std::pair<iterator, bool> insert_entry(T&& value) {
+      if (index.empty() && entries.size() < linear_limit) {
+        bool inserted = find_index(value.first.data(), value.first.size()) == entries.size();
+        entries.emplace_back(std::forward<T>(value));
+        return std::make_pair(std::prev(entries.end()), inserted);
+      }
+      return insert_entry(std::forward<T>(value), static_cast<uint32_t>(string_hash::hash(value.first.data(), value.first.size())));
+    }
+
+    template <typename T>
+    FORCE_INLINE std::pair<iterator, bool> insert_entry(T&& value, uint32_t hash) {
+      if (index.empty() && entries.size() < linear_limit) {
+        bool inserted = scan_index(value.first.data(), value.first.size()) == entries.size();
+        entries.emplace_back(std::forward<T>(value));
+        return std::make_pair(std::prev(entries.end()), inserted);
+      }
+
+      if ((entries.size() + 1) * 2 > index.size()) {
+        rebuild_index(index_size_for(entries.size() + 1));
+      }
+      bool inserted = index_slot(hash, value.first.data(), value.first.size(), static_cast<uint32_t>(entries.size() + 1));
+      entries.emplace_back(std::forward<T>(value));
+      return std::make_pair(std::prev(entries.end()), inserted);
+    }
+
+    // claims an empty slot for the entry unless the key is already indexed
+    FORCE_INLINE bool index_slot(uint32_t hash, const char_type* key, size_t length, uint32_t entry) {
+      const size_t mask = index.size() - 1;
+      size_t pos = hash & mask;
+      for (; index[pos].index; pos = (pos + 1) & mask) {
+        const slot& s = index[pos];
+        if (s.hash == hash && key_equal(entries[s.index - 1].first, key, length)) {
+          return false;
+        }
+      }
+      index[pos].index = entry;
+      index[pos].hash = hash;
+      return true;
+    }
+
+    void rebuild_index(size_t capacity) {
+      index.assign(capacity, slot());
+      for (size_type i = 0; i < entries.size(); ++i) {
+        const K& key = entries[i].first;
+        index_slot(static_cast<uint32_t>(string_hash::hash(key.data(), key.size())), key.data(), key.size(), static_cast<uint32_t>(i + 1));
+      }
+    }
+
+    entry_type entries;
+    index_type index;
+  };
+
+  enum class node_type {
+    null_type = 0,
+    boolean_type,
+    number_type,
+    string_type,
+    array_type,
+    object_type
+  };
+
+  enum class token_type {
+    start_object = '{',
+    end_object = '}',
+    start_array = '[',
+    end_array = ']',
+    double_quote = '\"',
+    colon = ':',
+    comma = ','
+  };
+
+  FORCE_INLINE bool operator==(const char a, const token_type b) {
+    return static_cast<token_type>(a) == b;
+  }
+
+  FORCE_INLINE bool operator!=(const char a, const token_type b) {
+    return static_cast<token_type>(a) != b;
+  }
+
+  enum class number_kind : uint8_t {
+    real = 0,
+    signed_integer,
+    unsigned_integer
+  };
+
+  // a json number as read from the text. integers without fraction or exponent that fit 64 bits stay exact.
+  struct number_value {
+    number_kind kind;
+    union {
+      double real;
+      int64_t int_val;
+      uint64_t uint_val;
+    };
+  };
+
+  // integer reads of a number. doubles are truncated toward zero, values out of range saturate at
+  // the limits of the type and nan reads as 0.
+  FORCE_INLINE int64_t saturate_int64(double d) {
+    if (d >= 9223372036854775808.0) return std::numeric_limits<int64_t>::max();
+    if (d >= -9223372036854775808.0) return static_cast<int64_t>(d);
+    return d < 0 ? std::numeric_limits<int64_t>::min() : 0;
+  }
+  FORCE_INLINE uint64_t saturate_uint64(double d) {
+    if (d >= 18446744073709551616.0) return std::numeric_limits<uint64_t>::max();
+    return d > -1.0 ? static_cast<uint64_t>(d) : 0;
+  }
+  FORCE_INLINE int64_t saturate_int64(const number_value& value) {
+    switch (value.kind) {
+      case number_kind::real: return saturate_int64(value.real);
+      case number_kind::unsigned_integer: return std::numeric_limits<int64_t>::max();
+      default: return value.int_val;
+    }
+  }
+  FORCE_INLINE uint64_t saturate_uint64(const number_value& value) {
+    switch (value.kind) {
+      case number_kind::real: return saturate_uint64(value.real);
+      case number_kind::signed_integer: return value.int_val < 0 ? 0 : static_cast<uint64_t>(value.int_val);
+      default: return value.uint_val;
+    }
+  }
+
+  FORCE_INLINE int leading_zeroes(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanReverse64(&index, bits);
+    return 63 - static_cast<int>(index);
+#else
+    return __builtin_clzll(bits);
+#endif
+  }
+
+  // high and low 64 bits of a * b
+  FORCE_INLINE uint64_t full_multiplication(uint64_t a, uint64_t b, uint64_t* high) {
+#if defined(_MSC_VER) && defined(_M_X64)
+    return _umul128(a, b, high);
+#elif defined(__SIZEOF_INT128__)
+    __extension__ typedef unsigned __int128 uint128;
+    const uint128 r = static_cast<uint128>(a) * b;
+    *high = static_cast<uint64_t>(r >> 64);
+    return static_cast<uint64_t>(r);
+#else
+    const uint64_t a_lo = a & 0xFFFFFFFF, a_hi = a >> 32, b_lo = b & 0xFFFFFFFF, b_hi = b >> 32;
+    const uint64_t lo_lo = a_lo * b_lo, hi_lo = a_hi * b_lo, lo_hi = a_lo * b_hi, hi_hi = a_hi * b_hi;
+    const uint64_t cross = (lo_lo >> 32) + (hi_lo & 0xFFFFFFFF) + lo_hi;
+    *high = (hi_lo >> 32) + (cross >> 32) + hi_hi;
+    return (cross << 32) | (lo_lo & 0xFFFFFFFF);
+#endif
+  }
+
+  FORCE_INLINE double double_from_bits(uint64_t bits) {
+    double d;
+    memcpy(&d, &bits, sizeof(d));
+    return d;
+  }
+
+  FORCE_INLINE uint64_t bits_from_double(double d) {
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(bits));
+    return bits;
+  }
+
+  // 5^q for q in [-342, 308], normalized to 128 bits with the top bit set (rounded up for negative q).
+  // a class template so the table is defined once no matter how many translation units include us.
+  template <typename T = void>
+  struct powers_of_five {
+    static const int smallest_power = -342;
+    static const int largest_power = 308;
+    static const uint64_t table[2 * (largest_power - smallest_power + 1)];
+  };
+
+  template <typename T>
+  const uint64_t powers_of_five<T>::table[] = {
+      0xeef453d6923bd65aULL, 0x113faa2906a13b3fULL, 0x9558b4661b6565f8ULL, 0x4ac7ca59a424c507ULL,
+      0xbaaee17fa23ebf76ULL, 0x5d79bcf00d2df649ULL, 0xe95a99df8ace6f53ULL, 0xf4d82c2c107973dcULL,
+      0x91d8a02bb6c10594ULL, 0x79071b9b8a4be869ULL, 0xb64ec836a47146f9ULL, 0x9748e2826cdee284ULL,
+      0xe3e27a444d8d98b7ULL, 0xfd1b1b2308169b25ULL, 0x8e6d8c6ab0787f72ULL, 0xfe30f0f5e50e20f7ULL,
+      0xb208ef855c969f4fULL, 0xbdbd2d335e51a935ULL, 0xde8b2b66b3bc4723ULL, 0xad2c788035e61382ULL,
+      0x8b16fb203055ac76ULL, 0x4c3bcb5021afcc31ULL, 0xaddcb9e83c6b1793ULL, 0xdf4abe242a1bbf3dULL,
+      0xd953e8624b85dd78ULL, 0xd71d6dad34a2af0dULL, 0x87d4713d6f33aa6bULL, 0x8672648c40e5ad68ULL,
+      0xa9c98d8ccb009506ULL, 0x680efdaf511f18c2ULL, 0xd43bf0effdc0ba48ULL, 0x0212bd1b2566def2ULL,
+      0x84a57695fe98746dULL, 0x014bb630f7604b57ULL, 0xa5ced43b7e3e9188ULL, 0x419ea3bd35385e2dULL,
+      0xcf42894a5dce35eaULL, 0x52064cac828675b9ULL, 0x818995ce7aa0e1b2ULL, 0x7343efebd1940993ULL,
+      0xa1ebfb4219491a1fULL, 0x1014ebe6c5f90bf8ULL, 0xca66fa129f9b60a6ULL, 0xd41a26e077774ef6ULL,
+      0xfd00b897478238d0ULL, 0x8920b098955522b4ULL, 0x9e20735e8cb16382ULL, 0x55b46e5f5d5535b0ULL,
+      0xc5a890362fddbc62ULL, 0xeb2189f734aa831dULL, 0xf712b443bbd52b7bULL, 0xa5e9ec7501d523e4ULL,
+      0x9a6bb0aa55653b2dULL, 0x47b233c92125366eULL, 0xc1069cd4eabe89f8ULL, 0x999ec0bb696e840aULL,
+      0xf148440a256e2c76ULL, 0xc00670ea43ca250dULL, 0x96cd2a865764dbcaULL, 0x380406926a5e5728ULL,
+      0xbc807527ed3e12bcULL, 0xc605083704f5ecf2ULL, 0xeba09271e88d976bULL, 0xf7864a44c633682eULL,
+      0x93445b8731587ea3ULL, 0x7ab3ee6afbe0211dULL, 0xb8157268fdae9e4cULL, 0x5960ea05bad82964ULL,
+      0xe61acf033d1a45dfULL, 0x6fb92487298e33bdULL, 0x8fd0c16206306babULL, 0xa5d3b6d479f8e056ULL,
+      0xb3c4f1ba87bc8696ULL, 0x8f48a4899877186cULL, 0xe0b62e2929aba83cULL, 0x331acdabfe94de87ULL,
+      0x8c71dcd9ba0b4925ULL, 0x9ff0c08b7f1d0b14ULL, 0xaf8e5410288e1b6fULL, 0x07ecf0ae5ee44dd9ULL,
+      0xdb71e91432b1a24aULL, 0xc9e82cd9f69d6150ULL, 0x892731ac9faf056eULL, 0xbe311c083a225cd2ULL,
+      0xab70fe17c79ac6caULL, 0x6dbd630a48aaf406ULL, 0xd64d3d9db981787dULL, 0x092cbbccdad5b108ULL,
+      0x85f0468293f0eb4eULL, 0x25bbf56008c58ea5ULL, 0xa76c582338ed2621ULL, 0xaf2af2b80af6f24eULL,
+      0xd1476e2c07286faaULL, 0x1af5af660db4aee1ULL, 0x82cca4db847945caULL, 0x50d98d9fc890ed4dULL,
+      0xa37fce126597973cULL, 0xe50ff107bab528a0ULL, 0xcc5fc196fefd7d0cULL, 0x1e53ed49a96272c8ULL,
+      0xff77b1fcbebcdc4fULL, 0x25e8e89c13bb0f7aULL, 0x9faacf3df73609b1ULL, 0x77b191618c54e9acULL,
+      0xc795830d75038c1dULL, 0xd59df5b9ef6a2417ULL, 0xf97ae3d0d2446f25ULL, 0x4b0573286b44ad1dULL,
+      0x9becce62836ac577ULL, 0x4ee367f9430aec32ULL, 0xc2e801fb244576d5ULL, 0x229c41f793cda73fULL,
+      0xf3a20279ed56d48aULL, 0x6b43527578c1110fULL, 0x9845418c345644d6ULL, 0x830a13896b78aaa9ULL,
+      0xbe5691ef416bd60cULL, 0x23cc986bc656d553ULL, 0xedec366b11c6cb8fULL, 0x2cbfbe86b7ec8aa8ULL,
+      0x94b3a202eb1c3f39ULL, 0x7bf7d71432f3d6a9ULL, 0xb9e08a83a5e34f07ULL, 0xdaf5ccd93fb0cc53ULL,
+      0xe858ad248f5c22c9ULL, 0xd1b3400f8f9cff68ULL, 0x91376c36d99995beULL, 0x23100809b9c21fa1ULL,
+      0xb58547448ffffb2dULL, 0xabd40a0c2832a78aULL, 0xe2e69915b3fff9f9ULL, 0x16c90c8f323f516cULL,
+      0x8dd01fad907ffc3bULL, 0xae3da7d97f6792e3ULL, 0xb1442798f49ffb4aULL, 0x99cd11cfdf41779cULL,
+      0xdd95317f31c7fa1dULL, 0x40405643d711d583ULL, 0x8a7d3eef7f1cfc52ULL, 0x482835ea666b2572ULL,
+      0xad1c8eab5ee43b66ULL, 0xda3243650005eecfULL, 0xd863b256369d4a40ULL, 0x90bed43e40076a82ULL,
+      0x873e4f75e2224e68ULL, 0x5a7744a6e804a291ULL, 0xa90de3535aaae202ULL, 0x711515d0a205cb36ULL,
+      0xd3515c2831559a83ULL, 0x0d5a5b44ca873e03ULL, 0x8412d9991ed58091ULL, 0xe858790afe9486c2ULL,
+      0xa5178fff668ae0b6ULL, 0x626e974dbe39a872ULL, 0xce5d73ff402d98e3ULL, 0xfb0a3d212dc8128fULL,
+      0x80fa687f881c7f8eULL, 0x7ce66634bc9d0b99ULL, 0xa139029f6a239f72ULL, 0x1c1fffc1ebc44e80ULL,
+      0xc987434744ac874eULL, 0xa327ffb266b56220ULL, 0xfbe9141915d7a922ULL, 0x4bf1ff9f0062baa8ULL,
+      0x9d71ac8fada6c9b5ULL, 0x6f773fc3603db4a9ULL, 0xc4ce17b399107c22ULL, 0xcb550fb4384d21d3ULL,
+      0xf6019da07f549b2bULL, 0x7e2a53a146606a48ULL, 0x99c102844f94e0fbULL, 0x2eda7444cbfc426dULL,
+      0xc0314325637a1939ULL, 0xfa911155fefb5308ULL, 0xf03d93eebc589f88ULL, 0x793555ab7eba27caULL,
+      0x96267c7535b763b5ULL, 0x4bc1558b2f3458deULL, 0xbbb01b9283253ca2ULL, 0x9eb1aaedfb016f16ULL,
+      0xea9c227723ee8bcbULL, 0x465e15a979c1cadcULL, 0x92a1958a7675175fULL, 0x0bfacd89ec191ec9ULL,
+      0xb749faed14125d36ULL, 0xcef980ec671f667bULL, 0xe51c79a85916f484ULL, 0x82b7e12780e7401aULL,
+      0x8f31cc0937ae58d2ULL, 0xd1b2ecb8b0908810ULL, 0xb2fe3f0b8599ef07ULL, 0x861fa7e6dcb4aa15ULL,
+      0xdfbdcece67006ac9ULL, 0x67a791e093e1d49aULL, 0x8bd6a141006042bdULL, 0xe0c8bb2c5c6d24e0ULL,
+      0xaecc49914078536dULL, 0x58fae9f773886e18ULL, 0xda7f5bf590966848ULL, 0xaf39a475506a899eULL,
+      0x888f99797a5e012dULL, 0x6d8406c952429603ULL, 0xaab37fd7d8f58178ULL, 0xc8e5087ba6d33b83ULL,
+      0xd5605fcdcf32e1d6ULL, 0xfb1e4a9a90880a64ULL, 0x855c3be0a17fcd26ULL, 0x5cf2eea09a55067fULL,
+      0xa6b34ad8c9dfc06fULL, 0xf42faa48c0ea481eULL, 0xd0601d8efc57b08bULL, 0xf13b94daf124da26ULL,
+      0x823c12795db6ce57ULL, 0x76c53d08d6b70858ULL, 0xa2cb1717b52481edULL, 0x54768c4b0c64ca6eULL,
+      0xcb7ddcdda26da268ULL, 0xa9942f5dcf7dfd09ULL, 0xfe5d54150b090b02ULL, 0xd3f93b35435d7c4cULL,
+      0x9efa548d26e5a6e1ULL, 0xc47bc5014a1a6dafULL, 0xc6b8e9b0709f109aULL, 0x359ab6419ca1091bULL,
+      0xf867241c8cc6d4c0ULL, 0xc30163d203c94b62ULL, 0x9b407691d7fc44f8ULL, 0x79e0de63425dcf1dULL,
+      0xc21094364dfb5636ULL, 0x985915fc12f542e4ULL, 0xf294b943e17a2bc4ULL, 0x3e6f5b7b17b2939dULL,
+      0x979cf3ca6cec5b5aULL, 0xa705992ceecf9c42ULL, 0xbd8430bd08277231ULL, 0x50c6ff782a838353ULL,
+      0xece53cec4a314ebdULL, 0xa4f8bf5635246428ULL, 0x940f4613ae5ed136ULL, 0x871b7795e136be99ULL,
+      0xb913179899f68584ULL, 0x28e2557b59846e3fULL, 0xe757dd7ec07426e5ULL, 0x331aeada2fe589cfULL,
+      0x9096ea6f3848984fULL, 0x3ff0d2c85def7621ULL, 0xb4bca50b065abe63ULL, 0x0fed077a756b53a9ULL,
+      0xe1ebce4dc7f16dfbULL, 0xd3e8495912c62894ULL, 0x8d3360f09cf6e4bdULL, 0x64712dd7abbbd95cULL,
+      0xb080392cc4349decULL, 0xbd8d794d96aacfb3ULL, 0xdca04777f541c567ULL, 0xecf0d7a0fc5583a0ULL,
+      0x89e42caaf9491b60ULL, 0xf41686c49db57244ULL, 0xac5d37d5b79b6239ULL, 0x311c2875c522ced5ULL,
+      0xd77485cb25823ac7ULL, 0x7d633293366b828bULL, 0x86a8d39ef77164bcULL, 0xae5dff9c02033197ULL,
+      0xa8530886b54dbdebULL, 0xd9f57f830283fdfcULL, 0xd267caa862a12d66ULL, 0xd072df63c324fd7bULL,
+      0x8380dea93da4bc60ULL, 0x4247cb9e59f71e6dULL, 0xa46116538d0deb78ULL, 0x52d9be85f074e608ULL,
+      0xcd795be870516656ULL, 0x67902e276c921f8bULL, 0x806bd9714632dff6ULL, 0x00ba1cd8a3db53b6ULL,
+      0xa086cfcd97bf97f3ULL, 0x80e8a40eccd228a4ULL, 0xc8a883c0fdaf7df0ULL, 0x6122cd128006b2cdULL,
+      0xfad2a4b13d1b5d6cULL, 0x796b805720085f81ULL, 0x9cc3a6eec6311a63ULL, 0xcbe3303674053bb0ULL,
+      0xc3f490aa77bd60fcULL, 0xbedbfc4411068a9cULL, 0xf4f1b4d515acb93bULL, 0xee92fb5515482d44ULL,
+      0x991711052d8bf3c5ULL, 0x751bdd152d4d1c4aULL, 0xbf5cd54678eef0b6ULL, 0xd262d45a78a0635dULL,
+      0xef340a98172aace4ULL, 0x86fb897116c87c34ULL, 0x9580869f0e7aac0eULL, 0xd45d35e6ae3d4da0ULL,
+      0xbae0a846d2195712ULL, 0x8974836059cca109ULL, 0xe998d258869facd7ULL, 0x2bd1a438703fc94bULL,
+      0x91ff83775423cc06ULL, 0x7b6306a34627ddcfULL, 0xb67f6455292cbf08ULL, 0x1a3bc84c17b1d542ULL,
+      0xe41f3d6a7377eecaULL, 0x20caba5f1d9e4a93ULL, 0x8e938662882af53eULL, 0x547eb47b7282ee9cULL,
+      0xb23867fb2a35b28dULL, 0xe99e619a4f23aa43ULL, 0xdec681f9f4c31f31ULL, 0x6405fa00e2ec94d4ULL,
+      0x8b3c113c38f9f37eULL, 0xde83bc408dd3dd04ULL, 0xae0b158b4738705eULL, 0x9624ab50b148d445ULL,
+      0xd98ddaee19068c76ULL, 0x3badd624dd9b0957ULL, 0x87f8a8d4cfa417c9ULL, 0xe54ca5d70a80e5d6ULL,
+      0xa9f6d30a038d1dbcULL, 0x5e9fcf4ccd211f4cULL, 0xd47487cc8470652bULL, 0x7647c3200069671fULL,
+      0x84c8d4dfd2c63f3bULL, 0x29ecd9f40041e073ULL, 0xa5fb0a17c777cf09ULL, 0xf468107100525890ULL,
+      0xcf79cc9db955c2ccULL, 0x7182148d4066eeb4ULL, 0x81ac1fe293d599bfULL, 0xc6f14cd848405530ULL,
+      0xa21727db38cb002fULL, 0xb8ada00e5a506a7cULL, 0xca9cf1d206fdc03bULL, 0xa6d90811f0e4851cULL,
+      0xfd442e4688bd304aULL, 0x908f4a166d1da663ULL, 0x9e4a9cec15763e2eULL, 0x9a598e4e043287feULL,
+      0xc5dd44271ad3cdbaULL, 0x40eff1e1853f29fdULL, 0xf7549530e188c128ULL, 0xd12bee59e68ef47cULL,
+      0x9a94dd3e8cf578b9ULL, 0x82bb74f8301958ceULL, 0xc13a148e3032d6e7ULL, 0xe36a52363c1faf01ULL,
+      0xf18899b1bc3f8ca1ULL, 0xdc44e6c3cb279ac1ULL, 0x96f5600f15a7b7e5ULL, 0x29ab103a5ef8c0b9ULL,
+      0xbcb2b812db11a5deULL, 0x7415d448f6b6f0e7ULL, 0xebdf661791d60f56ULL, 0x111b495b3464ad21ULL,
+      0x936b9fcebb25c995ULL, 0xcab10dd900beec34ULL, 0xb84687c269ef3bfbULL, 0x3d5d514f40eea742ULL,
+      0xe65829b3046b0afaULL, 0x0cb4a5a3112a5112ULL, 0x8ff71a0fe2c2e6dcULL, 0x47f0e785eaba72abULL,
+      0xb3f4e093db73a093ULL, 0x59ed216765690f56ULL, 0xe0f218b8d25088b8ULL, 0x306869c13ec3532cULL,
+      0x8c974f7383725573ULL, 0x1e414218c73a13fbULL, 0xafbd2350644eeacfULL, 0xe5d1929ef90898faULL,
+      0xdbac6c247d62a583ULL, 0xdf45f746b74abf39ULL, 0x894bc396ce5da772ULL, 0x6b8bba8c328eb783ULL,
+      0xab9eb47c81f5114fULL, 0x066ea92f3f326564ULL, 0xd686619ba27255a2ULL, 0xc80a537b0efefebdULL,
+      0x8613fd0145877585ULL, 0xbd06742ce95f5f36ULL, 0xa798fc4196e952e7ULL, 0x2c48113823b73704ULL,
+      0xd17f3b51fca3a7a0ULL, 0xf75a15862ca504c5ULL, 0x82ef85133de648c4ULL, 0x9a984d73dbe722fbULL,
+      0xa3ab66580d5fdaf5ULL, 0xc13e60d0d2e0ebbaULL, 0xcc963fee10b7d1b3ULL, 0x318df905079926a8ULL,
+      0xffbbcfe994e5c61fULL, 0xfdf17746497f7052ULL, 0x9fd561f1fd0f9bd3ULL, 0xfeb6ea8bedefa633ULL,
+      0xc7caba6e7c5382c8ULL, 0xfe64a52ee96b8fc0ULL, 0xf9bd690a1b68637bULL, 0x3dfdce7aa3c673b0ULL,
+      0x9c1661a651213e2dULL, 0x06bea10ca65c084eULL, 0xc31bfa0fe5698db8ULL, 0x486e494fcff30a62ULL,
+      0xf3e2f893dec3f126ULL, 0x5a89dba3c3efccfaULL, 0x986ddb5c6b3a76b7ULL, 0xf89629465a75e01cULL,
+      0xbe89523386091465ULL, 0xf6bbb397f1135823ULL, 0xee2ba6c0678b597fULL, 0x746aa07ded582e2cULL,
+      0x94db483840b717efULL, 0xa8c2a44eb4571cdcULL, 0xba121a4650e4ddebULL, 0x92f34d62616ce413ULL,
+      0xe896a0d7e51e1566ULL, 0x77b020baf9c81d17ULL, 0x915e2486ef32cd60ULL, 0x0ace1474dc1d122eULL,
+      0xb5b5ada8aaff80b8ULL, 0x0d819992132456baULL, 0xe3231912d5bf60e6ULL, 0x10e1fff697ed6c69ULL,
+      0x8df5efabc5979c8fULL, 0xca8d3ffa1ef463c1ULL, 0xb1736b96b6fd83b3ULL, 0xbd308ff8a6b17cb2ULL,
+      0xddd0467c64bce4a0ULL, 0xac7cb3f6d05ddbdeULL, 0x8aa22c0dbef60ee4ULL, 0x6bcdf07a423aa96bULL,
+      0xad4ab7112eb3929dULL, 0x86c16c98d2c953c6ULL, 0xd89d64d57a607744ULL, 0xe871c7bf077ba8b7ULL,
+      0x87625f056c7c4a8bULL, 0x11471cd764ad4972ULL, 0xa93af6c6c79b5d2dULL, 0xd598e40d3dd89bcfULL,
+      0xd389b47879823479ULL, 0x4aff1d108d4ec2c3ULL, 0x843610cb4bf160cbULL, 0xcedf722a585139baULL,
+      0xa54394fe1eedb8feULL, 0xc2974eb4ee658828ULL, 0xce947a3da6a9273eULL, 0x733d226229feea32ULL,
+      0x811ccc668829b887ULL, 0x0806357d5a3f525fULL, 0xa163ff802a3426a8ULL, 0xca07c2dcb0cf26f7ULL,
+      0xc9bcff6034c13052ULL, 0xfc89b393dd02f0b5ULL, 0xfc2c3f3841f17c67ULL, 0xbbac2078d443ace2ULL,
+      0x9d9ba7832936edc0ULL, 0xd54b944b84aa4c0dULL, 0xc5029163f384a931ULL, 0x0a9e795e65d4df11ULL,
+      0xf64335bcf065d37dULL, 0x4d4617b5ff4a16d5ULL, 0x99ea0196163fa42eULL, 0x504bced1bf8e4e45ULL,
+      0xc06481fb9bcf8d39ULL, 0xe45ec2862f71e1d6ULL, 0xf07da27a82c37088ULL, 0x5d767327bb4e5a4cULL,
+      0x964e858c91ba2655ULL, 0x3a6a07f8d510f86fULL, 0xbbe226efb628afeaULL, 0x890489f70a55368bULL,
+      0xeadab0aba3b2dbe5ULL, 0x2b45ac74ccea842eULL, 0x92c8ae6b464fc96fULL, 0x3b0b8bc90012929dULL,
+      0xb77ada0617e3bbcbULL, 0x09ce6ebb40173744ULL, 0xe55990879ddcaabdULL, 0xcc420a6a101d0515ULL,
+      0x8f57fa54c2a9eab6ULL, 0x9fa946824a12232dULL, 0xb32df8e9f3546564ULL, 0x47939822dc96abf9ULL,
+      0xdff9772470297ebdULL, 0x59787e2b93bc56f7ULL, 0x8bfbea76c619ef36ULL, 0x57eb4edb3c55b65aULL,
+      0xaefae51477a06b03ULL, 0xede622920b6b23f1ULL, 0xdab99e59958885c4ULL, 0xe95fab368e45ecedULL,
+      0x88b402f7fd75539bULL, 0x11dbcb0218ebb414ULL, 0xaae103b5fcd2a881ULL, 0xd652bdc29f26a119ULL,
+      0xd59944a37c0752a2ULL, 0x4be76d3346f0495fULL, 0x857fcae62d8493a5ULL, 0x6f70a4400c562ddbULL,
+      0xa6dfbd9fb8e5b88eULL, 0xcb4ccd500f6bb952ULL, 0xd097ad07a71f26b2ULL, 0x7e2000a41346a7a7ULL,
+      0x825ecc24c873782fULL, 0x8ed400668c0c28c8ULL, 0xa2f67f2dfa90563bULL, 0x728900802f0f32faULL,
+      0xcbb41ef979346bcaULL, 0x4f2b40a03ad2ffb9ULL, 0xfea126b7d78186bcULL, 0xe2f610c84987bfa8ULL,
+      0x9f24b832e6b0f436ULL, 0x0dd9ca7d2df4d7c9ULL, 0xc6ede63fa05d3143ULL, 0x91503d1c79720dbbULL,
+      0xf8a95fcf88747d94ULL, 0x75a44c6397ce912aULL, 0x9b69dbe1b548ce7cULL, 0xc986afbe3ee11abaULL,
+      0xc24452da229b021bULL, 0xfbe85badce996168ULL, 0xf2d56790ab41c2a2ULL, 0xfae27299423fb9c3ULL,
+      0x97c560ba6b0919a5ULL, 0xdccd879fc967d41aULL, 0xbdb6b8e905cb600fULL, 0x5400e987bbc1c920ULL,
+      0xed246723473e3813ULL, 0x290123e9aab23b68ULL, 0x9436c0760c86e30bULL, 0xf9a0b6720aaf6521ULL,
+      0xb94470938fa89bceULL, 0xf808e40e8d5b3e69ULL, 0xe7958cb87392c2c2ULL, 0xb60b1d1230b20e04ULL,
+      0x90bd77f3483bb9b9ULL, 0xb1c6f22b5e6f48c2ULL, 0xb4ecd5f01a4aa828ULL, 0x1e38aeb6360b1af3ULL,
+      0xe2280b6c20dd5232ULL, 0x25c6da63c38de1b0ULL, 0x8d590723948a535fULL, 0x579c487e5a38ad0eULL,
+      0xb0af48ec79ace837ULL, 0x2d835a9df0c6d851ULL, 0xdcdb1b2798182244ULL, 0xf8e431456cf88e65ULL,
+      0x8a08f0f8bf0f156bULL, 0x1b8e9ecb641b58ffULL, 0xac8b2d36eed2dac5ULL, 0xe272467e3d222f3fULL,
+      0xd7adf884aa879177ULL, 0x5b0ed81dcc6abb0fULL, 0x86ccbb52ea94baeaULL, 0x98e947129fc2b4e9ULL,
+      0xa87fea27a539e9a5ULL, 0x3f2398d747b36224ULL, 0xd29fe4b18e88640eULL, 0x8eec7f0d19a03aadULL,
+      0x83a3eeeef9153e89ULL, 0x1953cf68300424acULL, 0xa48ceaaab75a8e2bULL, 0x5fa8c3423c052dd7ULL,
+      0xcdb02555653131b6ULL, 0x3792f412cb06794dULL, 0x808e17555f3ebf11ULL, 0xe2bbd88bbee40bd0ULL,
+      0xa0b19d2ab70e6ed6ULL, 0x5b6aceaeae9d0ec4ULL, 0xc8de047564d20a8bULL, 0xf245825a5a445275ULL,
+      0xfb158592be068d2eULL, 0xeed6e2f0f0d56712ULL, 0x9ced737bb6c4183dULL, 0x55464dd69685606bULL,
+      0xc428d05aa4751e4cULL, 0xaa97e14c3c26b886ULL, 0xf53304714d9265dfULL, 0xd53dd99f4b3066a8ULL,
+      0x993fe2c6d07b7fabULL, 0xe546a8038efe4029ULL, 0xbf8fdb78849a5f96ULL, 0xde98520472bdd033ULL,
+      0xef73d256a5c0f77cULL, 0x963e66858f6d4440ULL, 0x95a8637627989aadULL, 0xdde7001379a44aa8ULL,
+      0xbb127c53b17ec159ULL, 0x5560c018580d5d52ULL, 0xe9d71b689dde71afULL, 0xaab8f01e6e10b4a6ULL,
+      0x9226712162ab070dULL, 0xcab3961304ca70e8ULL, 0xb6b00d69bb55c8d1ULL, 0x3d607b97c5fd0d22ULL,
+      0xe45c10c42a2b3b05ULL, 0x8cb89a7db77c506aULL, 0x8eb98a7a9a5b04e3ULL, 0x77f3608e92adb242ULL,
+      0xb267ed1940f1c61cULL, 0x55f038b237591ed3ULL, 0xdf01e85f912e37a3ULL, 0x6b6c46dec52f6688ULL,
+      0x8b61313bbabce2c6ULL, 0x2323ac4b3b3da015ULL, 0xae397d8aa96c1b77ULL, 0xabec975e0a0d081aULL,
+      0xd9c7dced53c72255ULL, 0x96e7bd358c904a21ULL, 0x881cea14545c7575ULL, 0x7e50d64177da2e54ULL,
+      0xaa242499697392d2ULL, 0xdde50bd1d5d0b9e9ULL, 0xd4ad2dbfc3d07787ULL, 0x955e4ec64b44e864ULL,
+      0x84ec3c97da624ab4ULL, 0xbd5af13bef0b113eULL, 0xa6274bbdd0fadd61ULL, 0xecb1ad8aeacdd58eULL,
+      0xcfb11ead453994baULL, 0x67de18eda5814af2ULL, 0x81ceb32c4b43fcf4ULL, 0x80eacf948770ced7ULL,
+      0xa2425ff75e14fc31ULL, 0xa1258379a94d028dULL, 0xcad2f7f5359a3b3eULL, 0x096ee45813a04330ULL,
+      0xfd87b5f28300ca0dULL, 0x8bca9d6e188853fcULL, 0x9e74d1b791e07e48ULL, 0x775ea264cf55347eULL,
+      0xc612062576589ddaULL, 0x95364afe032a819eULL, 0xf79687aed3eec551ULL, 0x3a83ddbd83f52205ULL,
+      0x9abe14cd44753b52ULL, 0xc4926a9672793543ULL, 0xc16d9a0095928a27ULL, 0x75b7053c0f178294ULL,
+      0xf1c90080baf72cb1ULL, 0x5324c68b12dd6339ULL, 0x971da05074da7beeULL, 0xd3f6fc16ebca5e04ULL,
+      0xbce5086492111aeaULL, 0x88f4bb1ca6bcf585ULL, 0xec1e4a7db69561a5ULL, 0x2b31e9e3d06c32e6ULL,
+      0x9392ee8e921d5d07ULL, 0x3aff322e62439fd0ULL, 0xb877aa3236a4b449ULL, 0x09befeb9fad487c3ULL,
+      0xe69594bec44de15bULL, 0x4c2ebe687989a9b4ULL, 0x901d7cf73ab0acd9ULL, 0x0f9d37014bf60a11ULL,
+      0xb424dc35095cd80fULL, 0x538484c19ef38c95ULL, 0xe12e13424bb40e13ULL, 0x2865a5f206b06fbaULL,
+      0x8cbccc096f5088cbULL, 0xf93f87b7442e45d4ULL, 0xafebff0bcb24aafeULL, 0xf78f69a51539d749ULL,
+      0xdbe6fecebdedd5beULL, 0xb573440e5a884d1cULL, 0x89705f4136b4a597ULL, 0x31680a88f8953031ULL,
+      0xabcc77118461cefcULL, 0xfdc20d2b36ba7c3eULL, 0xd6bf94d5e57a42bcULL, 0x3d32907604691b4dULL,
+      0x8637bd05af6c69b5ULL, 0xa63f9a49c2c1b110ULL, 0xa7c5ac471b478423ULL, 0x0fcf80dc33721d54ULL,
+      0xd1b71758e219652bULL, 0xd3c36113404ea4a9ULL, 0x83126e978d4fdf3bULL, 0x645a1cac083126eaULL,
+      0xa3d70a3d70a3d70aULL, 0x3d70a3d70a3d70a4ULL, 0xccccccccccccccccULL, 0xcccccccccccccccdULL,
+      0x8000000000000000ULL, 0x0000000000000000ULL, 0xa000000000000000ULL, 0x0000000000000000ULL,
+      0xc800000000000000ULL, 0x0000000000000000ULL, 0xfa00000000000000ULL, 0x0000000000000000ULL,
+      0x9c40000000000000ULL, 0x0000000000000000ULL, 0xc350000000000000ULL, 0x0000000000000000ULL,
+      0xf424000000000000ULL, 0x0000000000000000ULL, 0x9896800000000000ULL, 0x0000000000000000ULL,
+      0xbebc200000000000ULL, 0x0000000000000000ULL, 0xee6b280000000000ULL, 0x0000000000000000ULL,
+      0x9502f90000000000ULL, 0x0000000000000000ULL, 0xba43b74000000000ULL, 0x0000000000000000ULL,
+      0xe8d4a51000000000ULL, 0x0000000000000000ULL, 0x9184e72a00000000ULL, 0x0000000000000000ULL,
+      0xb5e620f480000000ULL, 0x0000000000000000ULL, 0xe35fa931a0000000ULL, 0x0000000000000000ULL,
+      0x8e1bc9bf04000000ULL, 0x0000000000000000ULL, 0xb1a2bc2ec5000000ULL, 0x0000000000000000ULL,
+      0xde0b6b3a76400000ULL, 0x0000000000000000ULL, 0x8ac7230489e80000ULL, 0x0000000000000000ULL,
+      0xad78ebc5ac620000ULL, 0x0000000000000000ULL, 0xd8d726b7177a8000ULL, 0x0000000000000000ULL,
+      0x878678326eac9000ULL, 0x0000000000000000ULL, 0xa968163f0a57b400ULL, 0x0000000000000000ULL,
+      0xd3c21bcecceda100ULL, 0x0000000000000000ULL, 0x84595161401484a0ULL, 0x0000000000000000ULL,
+      0xa56fa5b99019a5c8ULL, 0x0000000000000000ULL, 0xcecb8f27f4200f3aULL, 0x0000000000000000ULL,
+      0x813f3978f8940984ULL, 0x4000000000000000ULL, 0xa18f07d736b90be5ULL, 0x5000000000000000ULL,
+      0xc9f2c9cd04674edeULL, 0xa400000000000000ULL, 0xfc6f7c4045812296ULL, 0x4d00000000000000ULL,
+      0x9dc5ada82b70b59dULL, 0xf020000000000000ULL, 0xc5371912364ce305ULL, 0x6c28000000000000ULL,
+      0xf684df56c3e01bc6ULL, 0xc732000000000000ULL, 0x9a130b963a6c115cULL, 0x3c7f400000000000ULL,
+      0xc097ce7bc90715b3ULL, 0x4b9f100000000000ULL, 0xf0bdc21abb48db20ULL, 0x1e86d40000000000ULL,
+      0x96769950b50d88f4ULL, 0x1314448000000000ULL, 0xbc143fa4e250eb31ULL, 0x17d955a000000000ULL,
+      0xeb194f8e1ae525fdULL, 0x5dcfab0800000000ULL, 0x92efd1b8d0cf37beULL, 0x5aa1cae500000000ULL,
+      0xb7abc627050305adULL, 0xf14a3d9e40000000ULL, 0xe596b7b0c643c719ULL, 0x6d9ccd05d0000000ULL,
+      0x8f7e32ce7bea5c6fULL, 0xe4820023a2000000ULL, 0xb35dbf821ae4f38bULL, 0xdda2802c8a800000ULL,
+      0xe0352f62a19e306eULL, 0xd50b2037ad200000ULL, 0x8c213d9da502de45ULL, 0x4526f422cc340000ULL,
+      0xaf298d050e4395d6ULL, 0x9670b12b7f410000ULL, 0xdaf3f04651d47b4cULL, 0x3c0cdd765f114000ULL,
+      0x88d8762bf324cd0fULL, 0xa5880a69fb6ac800ULL, 0xab0e93b6efee0053ULL, 0x8eea0d047a457a00ULL,
+      0xd5d238a4abe98068ULL, 0x72a4904598d6d880ULL, 0x85a36366eb71f041ULL, 0x47a6da2b7f864750ULL,
+      0xa70c3c40a64e6c51ULL, 0x999090b65f67d924ULL, 0xd0cf4b50cfe20765ULL, 0xfff4b4e3f741cf6dULL,
+      0x82818f1281ed449fULL, 0xbff8f10e7a8921a4ULL, 0xa321f2d7226895c7ULL, 0xaff72d52192b6a0dULL,
+      0xcbea6f8ceb02bb39ULL, 0x9bf4f8a69f764490ULL, 0xfee50b7025c36a08ULL, 0x02f236d04753d5b4ULL,
+      0x9f4f2726179a2245ULL, 0x01d762422c946590ULL, 0xc722f0ef9d80aad6ULL, 0x424d3ad2b7b97ef5ULL,
+      0xf8ebad2b84e0d58bULL, 0xd2e0898765a7deb2ULL, 0x9b934c3b330c8577ULL, 0x63cc55f49f88eb2fULL,
+      0xc2781f49ffcfa6d5ULL, 0x3cbf6b71c76b25fbULL, 0xf316271c7fc3908aULL, 0x8bef464e3945ef7aULL,
+      0x97edd871cfda3a56ULL, 0x97758bf0e3cbb5acULL, 0xbde94e8e43d0c8ecULL, 0x3d52eeed1cbea317ULL,
+      0xed63a231d4c4fb27ULL, 0x4ca7aaa863ee4bddULL, 0x945e455f24fb1cf8ULL, 0x8fe8caa93e74ef6aULL,
+      0xb975d6b6ee39e436ULL, 0xb3e2fd538e122b44ULL, 0xe7d34c64a9c85d44ULL, 0x60dbbca87196b616ULL,
+      0x90e40fbeea1d3a4aULL, 0xbc8955e946fe31cdULL, 0xb51d13aea4a488ddULL, 0x6babab6398bdbe41ULL,
+      0xe264589a4dcdab14ULL, 0xc696963c7eed2dd1ULL, 0x8d7eb76070a08aecULL, 0xfc1e1de5cf543ca2ULL,
+      0xb0de65388cc8ada8ULL, 0x3b25a55f43294bcbULL, 0xdd15fe86affad912ULL, 0x49ef0eb713f39ebeULL,
+      0x8a2dbf142dfcc7abULL, 0x6e3569326c784337ULL, 0xacb92ed9397bf996ULL, 0x49c2c37f07965404ULL,
+      0xd7e77a8f87daf7fbULL, 0xdc33745ec97be906ULL, 0x86f0ac99b4e8dafdULL, 0x69a028bb3ded71a3ULL,
+      0xa8acd7c0222311bcULL, 0xc40832ea0d68ce0cULL, 0xd2d80db02aabd62bULL, 0xf50a3fa490c30190ULL,
+      0x83c7088e1aab65dbULL, 0x792667c6da79e0faULL, 0xa4b8cab1a1563f52ULL, 0x577001b891185938ULL,
+      0xcde6fd5e09abcf26ULL, 0xed4c0226b55e6f86ULL, 0x80b05e5ac60b6178ULL, 0x544f8158315b05b4ULL,
+      0xa0dc75f1778e39d6ULL, 0x696361ae3db1c721ULL, 0xc913936dd571c84cULL, 0x03bc3a19cd1e38e9ULL,
+      0xfb5878494ace3a5fULL, 0x04ab48a04065c723ULL, 0x9d174b2dcec0e47bULL, 0x62eb0d64283f9c76ULL,
+      0xc45d1df942711d9aULL, 0x3ba5d0bd324f8394ULL, 0xf5746577930d6500ULL, 0xca8f44ec7ee36479ULL,
+      0x9968bf6abbe85f20ULL, 0x7e998b13cf4e1ecbULL, 0xbfc2ef456ae276e8ULL, 0x9e3fedd8c321a67eULL,
+      0xefb3ab16c59b14a2ULL, 0xc5cfe94ef3ea101eULL, 0x95d04aee3b80ece5ULL, 0xbba1f1d158724a12ULL,
+      0xbb445da9ca61281fULL, 0x2a8a6e45ae8edc97ULL, 0xea1575143cf97226ULL, 0xf52d09d71a3293bdULL,
+      0x924d692ca61be758ULL, 0x593c2626705f9c56ULL, 0xb6e0c377cfa2e12eULL, 0x6f8b2fb00c77836cULL,
+      0xe498f455c38b997aULL, 0x0b6dfb9c0f956447ULL, 0x8edf98b59a373fecULL, 0x4724bd4189bd5eacULL,
+      0xb2977ee300c50fe7ULL, 0x58edec91ec2cb657ULL, 0xdf3d5e9bc0f653e1ULL, 0x2f2967b66737e3edULL,
+      0x8b865b215899f46cULL, 0xbd79e0d20082ee74ULL, 0xae67f1e9aec07187ULL, 0xecd8590680a3aa11ULL,
+      0xda01ee641a708de9ULL, 0xe80e6f4820cc9495ULL, 0x884134fe908658b2ULL, 0x3109058d147fdcddULL,
+      0xaa51823e34a7eedeULL, 0xbd4b46f0599fd415ULL, 0xd4e5e2cdc1d1ea96ULL, 0x6c9e18ac7007c91aULL,
+      0x850fadc09923329eULL, 0x03e2cf6bc604ddb0ULL, 0xa6539930bf6bff45ULL, 0x84db8346b786151cULL,
+      0xcfe87f7cef46ff16ULL, 0xe612641865679a63ULL, 0x81f14fae158c5f6eULL, 0x4fcb7e8f3f60c07eULL,
+      0xa26da3999aef7749ULL, 0xe3be5e330f38f09dULL, 0xcb090c8001ab551cULL, 0x5cadf5bfd3072cc5ULL,
+      0xfdcb4fa002162a63ULL, 0x73d9732fc7c8f7f6ULL, 0x9e9f11c4014dda7eULL, 0x2867e7fddcdd9afaULL,
+      0xc646d63501a1511dULL, 0xb281e1fd541501b8ULL, 0xf7d88bc24209a565ULL, 0x1f225a7ca91a4226ULL,
+      0x9ae757596946075fULL, 0x3375788de9b06958ULL, 0xc1a12d2fc3978937ULL, 0x0052d6b1641c83aeULL,
+      0xf209787bb47d6b84ULL, 0xc0678c5dbd23a49aULL, 0x9745eb4d50ce6332ULL, 0xf840b7ba963646e0ULL,
+      0xbd176620a501fbffULL, 0xb650e5a93bc3d898ULL, 0xec5d3fa8ce427affULL, 0xa3e51f138ab4cebeULL,
+      0x93ba47c980e98cdfULL, 0xc66f336c36b10137ULL, 0xb8a8d9bbe123f017ULL, 0xb80b0047445d4184ULL,
+      0xe6d3102ad96cec1dULL, 0xa60dc059157491e5ULL, 0x9043ea1ac7e41392ULL, 0x87c89837ad68db2fULL,
+      0xb454e4a179dd1877ULL, 0x29babe4598c311fbULL, 0xe16a1dc9d8545e94ULL, 0xf4296dd6fef3d67aULL,
+      0x8ce2529e2734bb1dULL, 0x1899e4a65f58660cULL, 0xb01ae745b101e9e4ULL, 0x5ec05dcff72e7f8fULL,
+      0xdc21a1171d42645dULL, 0x76707543f4fa1f73ULL, 0x899504ae72497ebaULL, 0x6a06494a791c53a8ULL,
+      0xabfa45da0edbde69ULL, 0x0487db9d17636892ULL, 0xd6f8d7509292d603ULL, 0x45a9d2845d3c42b6ULL,
+      0x865b86925b9bc5c2ULL, 0x0b8a2392ba45a9b2ULL, 0xa7f26836f282b732ULL, 0x8e6cac7768d7141eULL,
+      0xd1ef0244af2364ffULL, 0x3207d795430cd926ULL, 0x8335616aed761f1fULL, 0x7f44e6bd49e807b8ULL,
+      0xa402b9c5a8d3a6e7ULL, 0x5f16206c9c6209a6ULL, 0xcd036837130890a1ULL, 0x36dba887c37a8c0fULL,
+      0x802221226be55a64ULL, 0xc2494954da2c9789ULL, 0xa02aa96b06deb0fdULL, 0xf2db9baa10b7bd6cULL,
+      0xc83553c5c8965d3dULL, 0x6f92829494e5acc7ULL, 0xfa42a8b73abbf48cULL, 0xcb772339ba1f17f9ULL,
+      0x9c69a97284b578d7ULL, 0xff2a760414536efbULL, 0xc38413cf25e2d70dULL, 0xfef5138519684abaULL,
+      0xf46518c2ef5b8cd1ULL, 0x7eb258665fc25d69ULL, 0x98bf2f79d5993802ULL, 0xef2f773ffbd97a61ULL,
+      0xbeeefb584aff8603ULL, 0xaafb550ffacfd8faULL, 0xeeaaba2e5dbf6784ULL, 0x95ba2a53f983cf38ULL,
+      0x952ab45cfa97a0b2ULL, 0xdd945a747bf26183ULL, 0xba756174393d88dfULL, 0x94f971119aeef9e4ULL,
+      0xe912b9d1478ceb17ULL, 0x7a37cd5601aab85dULL, 0x91abb422ccb812eeULL, 0xac62e055c10ab33aULL,
+      0xb616a12b7fe617aaULL, 0x577b986b314d6009ULL, 0xe39c49765fdf9d94ULL, 0xed5a7e85fda0b80bULL,
+      0x8e41ade9fbebc27dULL, 0x14588f13be847307ULL, 0xb1d219647ae6b31cULL, 0x596eb2d8ae258fc8ULL,
+      0xde469fbd99a05fe3ULL, 0x6fca5f8ed9aef3bbULL, 0x8aec23d680043beeULL, 0x25de7bb9480d5854ULL,
+      0xada72ccc20054ae9ULL, 0xaf561aa79a10ae6aULL, 0xd910f7ff28069da4ULL, 0x1b2ba1518094da04ULL,
+      0x87aa9aff79042286ULL, 0x90fb44d2f05d0842ULL, 0xa99541bf57452b28ULL, 0x353a1607ac744a53ULL,
+      0xd3fa922f2d1675f2ULL, 0x42889b8997915ce8ULL, 0x847c9b5d7c2e09b7ULL, 0x69956135febada11ULL,
+      0xa59bc234db398c25ULL, 0x43fab9837e699095ULL, 0xcf02b2c21207ef2eULL, 0x94f967e45e03f4bbULL,
+      0x8161afb94b44f57dULL, 0x1d1be0eebac278f5ULL, 0xa1ba1ba79e1632dcULL, 0x6462d92a69731732ULL,
+      0xca28a291859bbf93ULL, 0x7d7b8f7503cfdcfeULL, 0xfcb2cb35e702af78ULL, 0x5cda735244c3d43eULL,
+      0x9defbf01b061adabULL, 0x3a0888136afa64a7ULL, 0xc56baec21c7a1916ULL, 0x088aaa1845b8fdd0ULL,
+      0xf6c69a72a3989f5bULL, 0x8aad549e57273d45ULL, 0x9a3c2087a63f6399ULL, 0x36ac54e2f678864bULL,
+      0xc0cb28a98fcf3c7fULL, 0x84576a1bb416a7ddULL, 0xf0fdf2d3f3c30b9fULL, 0x656d44a2a11c51d5ULL,
+      0x969eb7c47859e743ULL, 0x9f644ae5a4b1b325ULL, 0xbc4665b596706114ULL, 0x873d5d9f0dde1feeULL,
+      0xeb57ff22fc0c7959ULL, 0xa90cb506d155a7eaULL, 0x9316ff75dd87cbd8ULL, 0x09a7f12442d588f2ULL,
+      0xb7dcbf5354e9beceULL, 0x0c11ed6d538aeb2fULL, 0xe5d3ef282a242e81ULL, 0x8f1668c8a86da5faULL,
+      0x8fa475791a569d10ULL, 0xf96e017d694487bcULL, 0xb38d92d760ec4455ULL, 0x37c981dcc395a9acULL,
+      0xe070f78d3927556aULL, 0x85bbe253f47b1417ULL, 0x8c469ab843b89562ULL, 0x93956d7478ccec8eULL,
+      0xaf58416654a6babbULL, 0x387ac8d1970027b2ULL, 0xdb2e51bfe9d0696aULL, 0x06997b05fcc0319eULL,
+      0x88fcf317f22241e2ULL, 0x441fece3bdf81f03ULL, 0xab3c2fddeeaad25aULL, 0xd527e81cad7626c3ULL,
+      0xd60b3bd56a5586f1ULL, 0x8a71e223d8d3b074ULL, 0x85c7056562757456ULL, 0xf6872d5667844e49ULL,
+      0xa738c6bebb12d16cULL, 0xb428f8ac016561dbULL, 0xd106f86e69d785c7ULL, 0xe13336d701beba52ULL,
+      0x82a45b450226b39cULL, 0xecc0024661173473ULL, 0xa34d721642b06084ULL, 0x27f002d7f95d0190ULL,
+      0xcc20ce9bd35c78a5ULL, 0x31ec038df7b441f4ULL, 0xff290242c83396ceULL, 0x7e67047175a15271ULL,
+      0x9f79a169bd203e41ULL, 0x0f0062c6e984d386ULL, 0xc75809c42c684dd1ULL, 0x52c07b78a3e60868ULL,
+      0xf92e0c3537826145ULL, 0xa7709a56ccdf8a82ULL, 0x9bbcc7a142b17ccbULL, 0x88a66076400bb691ULL,
+      0xc2abf989935ddbfeULL, 0x6acff893d00ea435ULL, 0xf356f7ebf83552feULL, 0x0583f6b8c4124d43ULL,
+      0x98165af37b2153deULL, 0xc3727a337a8b704aULL, 0xbe1bf1b059e9a8d6ULL, 0x744f18c0592e4c5cULL,
+      0xeda2ee1c7064130cULL, 0x1162def06f79df73ULL, 0x9485d4d1c63e8be7ULL, 0x8addcb5645ac2ba8ULL,
+      0xb9a74a0637ce2ee1ULL, 0x6d953e2bd7173692ULL, 0xe8111c87c5c1ba99ULL, 0xc8fa8db6ccdd0437ULL,
+      0x910ab1d4db9914a0ULL, 0x1d9c9892400a22a2ULL, 0xb54d5e4a127f59c8ULL, 0x2503beb6d00cab4bULL,
+      0xe2a0b5dc971f303aULL, 0x2e44ae64840fd61dULL, 0x8da471a9de737e24ULL, 0x5ceaecfed289e5d2ULL,
+      0xb10d8e1456105dadULL, 0x7425a83e872c5f47ULL, 0xdd50f1996b947518ULL, 0xd12f124e28f77719ULL,
+      0x8a5296ffe33cc92fULL, 0x82bd6b70d99aaa6fULL, 0xace73cbfdc0bfb7bULL, 0x636cc64d1001550bULL,
+      0xd8210befd30efa5aULL, 0x3c47f7e05401aa4eULL, 0x8714a775e3e95c78ULL, 0x65acfaec34810a71ULL,
+      0xa8d9d1535ce3b396ULL, 0x7f1839a741a14d0dULL, 0xd31045a8341ca07cULL, 0x1ede48111209a050ULL,
+      0x83ea2b892091e44dULL, 0x934aed0aab460432ULL, 0xa4e4b66b68b65d60ULL, 0xf81da84d5617853fULL,
+      0xce1de40642e3f4b9ULL, 0x36251260ab9d668eULL, 0x80d2ae83e9ce78f3ULL, 0xc1d72b7c6b426019ULL,
+      0xa1075a24e4421730ULL, 0xb24cf65b8612f81fULL, 0xc94930ae1d529cfcULL, 0xdee033f26797b627ULL,
+      0xfb9b7cd9a4a7443cULL, 0x169840ef017da3b1ULL, 0x9d412e0806e88aa5ULL, 0x8e1f289560ee864eULL,
+      0xc491798a08a2ad4eULL, 0xf1a6f2bab92a27e2ULL, 0xf5b5d7ec8acb58a2ULL, 0xae10af696774b1dbULL,
+      0x9991a6f3d6bf1765ULL, 0xacca6da1e0a8ef29ULL, 0xbff610b0cc6edd3fULL, 0x17fd090a58d32af3ULL,
+      0xeff394dcff8a948eULL, 0xddfc4b4cef07f5b0ULL, 0x95f83d0a1fb69cd9ULL, 0x4abdaf101564f98eULL,
+      0xbb764c4ca7a4440fULL, 0x9d6d1ad41abe37f1ULL, 0xea53df5fd18d5513ULL, 0x84c86189216dc5edULL,
+      0x92746b9be2f8552cULL, 0x32fd3cf5b4e49bb4ULL, 0xb7118682dbb66a77ULL, 0x3fbc8c33221dc2a1ULL,
+      0xe4d5e82392a40515ULL, 0x0fabaf3feaa5334aULL, 0x8f05b1163ba6832dULL, 0x29cb4d87f2a7400eULL,
+      0xb2c71d5bca9023f8ULL, 0x743e20e9ef511012ULL, 0xdf78e4b2bd342cf6ULL, 0x914da9246b255416ULL,
+      0x8bab8eefb6409c1aULL, 0x1ad089b6c2f7548eULL, 0xae9672aba3d0c320ULL, 0xa184ac2473b529b1ULL,
+      0xda3c0f568cc4f3e8ULL, 0xc9e5d72d90a2741eULL, 0x8865899617fb1871ULL, 0x7e2fa67c7a658892ULL,
+      0xaa7eebfb9df9de8dULL, 0xddbb901b98feeab7ULL, 0xd51ea6fa85785631ULL, 0x552a74227f3ea565ULL,
+      0x8533285c936b35deULL, 0xd53a88958f87275fULL, 0xa67ff273b8460356ULL, 0x8a892abaf368f137ULL,
+      0xd01fef10a657842cULL, 0x2d2b7569b0432d85ULL, 0x8213f56a67f6b29bULL, 0x9c3b29620e29fc73ULL,
+      0xa298f2c501f45f42ULL, 0x8349f3ba91b47b8fULL, 0xcb3f2f7642717713ULL, 0x241c70a936219a73ULL,
+      0xfe0efb53d30dd4d7ULL, 0xed238cd383aa0110ULL, 0x9ec95d1463e8a506ULL, 0xf4363804324a40aaULL,
+      0xc67bb4597ce2ce48ULL, 0xb143c6053edcd0d5ULL, 0xf81aa16fdc1b81daULL, 0xdd94b7868e94050aULL,
+      0x9b10a4e5e9913128ULL, 0xca7cf2b4191c8326ULL, 0xc1d4ce1f63f57d72ULL, 0xfd1c2f611f63a3f0ULL,
+      0xf24a01a73cf2dccfULL, 0xbc633b39673c8cecULL, 0x976e41088617ca01ULL, 0xd5be0503e085d813ULL,
+      0xbd49d14aa79dbc82ULL, 0x4b2d8644d8a74e18ULL, 0xec9c459d51852ba2ULL, 0xddf8e7d60ed1219eULL,
+      0x93e1ab8252f33b45ULL, 0xcabb90e5c942b503ULL, 0xb8da1662e7b00a17ULL, 0x3d6a751f3b936243ULL,
+      0xe7109bfba19c0c9dULL, 0x0cc512670a783ad4ULL, 0x906a617d450187e2ULL, 0x27fb2b80668b24c5ULL,
+      0xb484f9dc9641e9daULL, 0xb1f9f660802dedf6ULL, 0xe1a63853bbd26451ULL, 0x5e7873f8a0396973ULL,
+      0x8d07e33455637eb2ULL, 0xdb0b487b6423e1e8ULL, 0xb049dc016abc5e5fULL, 0x91ce1a9a3d2cda62ULL,
+      0xdc5c5301c56b75f7ULL, 0x7641a140cc7810fbULL, 0x89b9b3e11b6329baULL, 0xa9e904c87fcb0a9dULL,
+      0xac2820d9623bf429ULL, 0x546345fa9fbdcd44ULL, 0xd732290fbacaf133ULL, 0xa97c177947ad4095ULL,
+      0x867f59a9d4bed6c0ULL, 0x49ed8eabcccc485dULL, 0xa81f301449ee8c70ULL, 0x5c68f256bfff5a74ULL,
+      0xd226fc195c6a2f8cULL, 0x73832eec6fff3111ULL, 0x83585d8fd9c25db7ULL, 0xc831fd53c5ff7eabULL,
+      0xa42e74f3d032f525ULL, 0xba3e7ca8b77f5e55ULL, 0xcd3a1230c43fb26fULL, 0x28ce1bd2e55f35ebULL,
+      0x80444b5e7aa7cf85ULL, 0x7980d163cf5b81b3ULL, 0xa0555e361951c366ULL, 0xd7e105bcc332621fULL,
+      0xc86ab5c39fa63440ULL, 0x8dd9472bf3fefaa7ULL, 0xfa856334878fc150ULL, 0xb14f98f6f0feb951ULL,
+      0x9c935e00d4b9d8d2ULL, 0x6ed1bf9a569f33d3ULL, 0xc3b8358109e84f07ULL, 0x0a862f80ec4700c8ULL,
+      0xf4a642e14c6262c8ULL, 0xcd27bb612758c0faULL, 0x98e7e9cccfbd7dbdULL, 0x8038d51cb897789cULL,
+      0xbf21e44003acdd2cULL, 0xe0470a63e6bd56c3ULL, 0xeeea5d5004981478ULL, 0x1858ccfce06cac74ULL,
+      0x95527a5202df0ccbULL, 0x0f37801e0c43ebc8ULL, 0xbaa718e68396cffdULL, 0xd30560258f54e6baULL,
+      0xe950df20247c83fdULL, 0x47c6b82ef32a2069ULL, 0x91d28b7416cdd27eULL, 0x4cdc331d57fa5441ULL,
+      0xb6472e511c81471dULL, 0xe0133fe4adf8e952ULL, 0xe3d8f9e563a198e5ULL, 0x58180fddd97723a6ULL,
+      0x8e679c2f5e44ff8fULL, 0x570f09eaa7ea7648ULL
+  };
+
+  // Eisel-Lemire: w * 10^q correctly rounded to the bits of a double, for w of at most 19 digits.
+  // "Number Parsing at a Gigabyte per Second", Lemire 2021; the truncated product is always precise
+  // enough when w is exact (Mushtak and Lemire, "Fast Number Parsing Without Fallback").
+  static uint64_t eisel_lemire(uint64_t w, int64_t q) {
+    const int mantissa_bits = 52;
+    const int minimum_exponent = -1023;
+    const int infinite_power = 0x7FF;
+    if (w == 0 || q < powers_of_five<>::smallest_power) return 0;
+    if (q > powers_of_five<>::largest_power) return static_cast<uint64_t>(infinite_power) << mantissa_bits;
+
+    const int lz = leading_zeroes(w);
+    w <<= lz;
+    const uint64_t* power = powers_of_five<>::table + 2 * (q - powers_of_five<>::smallest_power);
+    uint64_t high;
+    uint64_t low = full_multiplication(w, power[0], &high);
+    const uint64_t precision_mask = 0xFFFFFFFFFFFFFFFFULL >> (mantissa_bits + 3);
+    if ((high & precision_mask) == precision_mask) {
+      // the lower bits are all ones, the next word of the power decides on the carry
+      uint64_t second_high;
+      full_multiplication(w, power[1], &second_high);
+      low += second_high;
+      if (second_high > low) ++high;
+    }
+
+    const int upper_bit = static_cast<int>(high >> 63);
+    const int shift = upper_bit + 64 - mantissa_bits - 3;
+    uint64_t mantissa = high >> shift;
+    // floor(log2(10^q)) + 63, exact over the whole table
+    int power2 = static_cast<int>((((152170 + 65536) * q) >> 16) + 63) + upper_bit - lz - minimum_exponent;
+
+    if (power2 <= 0) {
+      // subnormal
+      if (-power2 + 1 >= 64) return 0;
+      mantissa >>= -power2 + 1;
+      mantissa += mantissa & 1;
+      mantissa >>= 1;
+      power2 = mantissa < (1ULL << mantissa_bits) ? 0 : 1;
+      return (static_cast<uint64_t>(power2) << mantissa_bits) | (mantissa & ((1ULL << mantissa_bits) - 1));
+    }
+
+    // exactly halfway between two doubles only happens for small q, where the product is exact.
+    // round to even by not rounding up.
+    if (low <= 1 && q >= -4 && q <= 23 && (mantissa & 3) == 1 && (mantissa << shift) == high) {
+      mantissa &= ~1ULL;
+    }
+
+    mantissa += mantissa & 1;
+    mantissa >>= 1;
+    if (mantissa >= (2ULL << mantissa_bits)) {
+      mantissa = 1ULL << mantissa_bits;
+      ++power2;
+    }
+    mantissa &= ~(1ULL << mantissa_bits);
+    if (power2 >= infinite_power) {
+      return static_cast<uint64_t>(infinite_power) << mantissa_bits;
+    }
+    return (static_cast<uint64_t>(power2) << mantissa_bits) | mantissa;
+  }
+
+  // arbitrary precision fallback for numbers with more than 19 significant digits, the
+  // "simple decimal conversion" of Go's strconv. slow, but those numbers are rare.
+  class decimal {
+  public:
+    static const int max_digits = 800;
+
+    decimal() : nd(0), dp(0), negative(false), truncated(false) {}
+
+    // s must already be a valid number
+    void assign(const char* s, const char* s_end) {
+      if (s != s_end && (*s == '-' || *s == '+')) negative = *s++ == '-';
+      bool dot = false;
+      for (; s != s_end; ++s) {
+        if (*s == '.') {
+          dot = true;
+          dp = nd;
+        } else if (is_digit(*s)) {
+          if (*s == '0' && nd == 0) {
+            // leading zeros only move the decimal point
+            --dp;
+          } else if (nd < max_digits) {
+            d[nd++] = static_cast<uint8_t>(*s - '0');
+          } else if (*s != '0') {
+            truncated = true;
+          }
+        } else {
+          break;
+        }
+      }
+      if (!dot) dp = nd;
+      if (s != s_end && (*s == 'e' || *s == 'E')) {
+        ++s;
+        int sign = 1;
+        if (s != s_end && (*s == '+' || *s == '-')) sign = *s++ == '-' ? -1 : 1;
+        int e = 0;
+        for (; s != s_end && is_digit(*s); ++s) {
+          if (e < 10000) e = e * 10 + (*s - '0');
+        }
+        dp += sign * e;
+      }
+      trim();
+    }
+
+    double to_double() {
+      // NOTE: declared up front, the gotos must not jump over definitions
+      static const int powtab[] = {1, 3, 6, 9, 13, 16, 19, 23, 26};
+      const int bias = -1023;
+      uint64_t mantissa = 0;
+      int exp = 0;
+      uint64_t bits;
+
+      if (nd == 0) {
+        exp = bias;
+        goto assemble;
+      }
+      if (dp > 310) goto overflow;
+      if (dp < -330) {
+        exp = bias;
+        goto assemble;
+      }
+
+      // scale by powers of two until the value is in [0.5, 1)
+      while (dp > 0) {
+        const int n = dp >= 9 ? 27 : powtab[dp];
+        shift(-n);
+        exp += n;
+      }
+      while (dp < 0 || (dp == 0 && d[0] < 5)) {
+        const int n = -dp >= 9 ? 27 : powtab[-dp];
+        shift(n);
+        exp -= n;
+      }
+      // doubles are in [1, 2)
+      --exp;
+      if (exp < bias + 1) {
+        const int n = bias + 1 - exp;
+        shift(-n);
+        exp += n;
+      }
+      if (exp - bias >= 0x7FF) goto overflow;
+
+      shift(53);
+      mantissa = rounded_integer();
+      if (mantissa == (2ULL << 52)) {
+        // rounding carried into a new bit
+        mantissa >>= 1;
+        ++exp;
+        if (exp - bias >= 0x7FF) goto overflow;
+      }
+      if ((mantissa & (1ULL << 52)) == 0) exp = bias;
+      goto assemble;
+
+      overflow:
+      mantissa = 0;
+      exp = 0x7FF + bias;
+
+      assemble:
+      bits = mantissa & ((1ULL << 52) - 1);
+      bits |= static_cast<uint64_t>((exp - bias) & 0x7FF) << 52;
+      if (negative) bits |= 1ULL << 63;
+      return double_from_bits(bits);
+    }
+
+  private:
+    static const int max_shift = 60;
+
+    void shift(int k) {
+      if (nd == 0) return;
+      if (k > 0) {
+        for (; k > max_shift; k -= max_shift) left_shift(max_shift);
+        left_shift(k);
+      } else if (k < 0) {
+        for (; k < -max_shift; k += max_shift) right_shift(max_shift);
+        right_shift(-k);
+      }
+    }
+
+    // multiply by 2^k. the result is built right aligned in a scratch buffer since at most
+    // 19 digits (2^60 < 10^19) can be added in front.
+    void left_shift(int k) {
+      uint8_t out[max_digits + 19];
+      int w = nd + 19;
+      uint64_t n = 0;
+      for (int r = nd - 1; r >= 0; --r) {
+        n += static_cast<uint64_t>(d[r]) << k;
+        const uint64_t quo = n / 10;
+        out[--w] = static_cast<uint8_t>(n - 10 * quo);
+        n = quo;
+      }
+      for (; n > 0; n /= 10) {
+        out[--w] = static_cast<uint8_t>(n % 10);
+      }
+      int count = nd + 19 - w;
+      const int delta = count - nd;
+      if (count > max_digits) {
+        for (int i = max_digits; i < count; ++i) {
+          if (out[w + i]) truncated = true;
+        }
+        count = max_digits;
+      }
+      memcpy(d, out + w, count);
+      nd = count;
+      dp += delta;
+      trim();
+    }
+
+    // divide by 2^k
+    void right_shift(int k) {
+      int r = 0;
+      int w = 0;
+      uint64_t n = 0;
+      // pick up enough leading digits to cover the first shift
+      for (; (n >> k) == 0; ++r) {
+        if (r >= nd) {
+          if (n == 0) {
+            nd = 0;
+            return;
+          }
+          while ((n >> k) == 0) {
+            n *= 10;
+            ++r;
+          }
+          break;
+        }
+        n = n * 10 + d[r];
+      }
+      dp -= r - 1;
+
+      const uint64_t mask = (1ULL << k) - 1;
+      for (; r < nd; ++r) {
+        d[w++] = static_cast<uint8_t>(n >> k);
+        n = (n & mask) * 10 + d[r];
+      }
+      for (; n > 0; n = (n & mask) * 10) {
+        if (w < max_digits) {
+          d[w++] = static_cast<uint8_t>(n >> k);
+        } else if (n >> k) {
+          truncated = true;
+        }
+      }
+      nd = w;
+      trim();
+    }
+
+    void trim() {
+      while (nd > 0 && d[nd - 1] == 0) --nd;
+      if (nd == 0) dp = 0;
+    }
+
+    // integer part, rounded half to even
+    uint64_t rounded_integer() const {
+      if (dp > 20) return 0xFFFFFFFFFFFFFFFFULL;
+      int i = 0;
+      uint64_t n = 0;
+      for (; i < dp && i < nd; ++i) n = n * 10 + d[i];
+      for (; i < dp; ++i) n *= 10;
+      if (dp >= 0 && dp < nd) {
+        bool round_up;
+        if (d[dp] == 5 && dp + 1 == nd) {
+          round_up = truncated || (dp > 0 && (d[dp - 1] & 1));
+        } else {
+          round_up = d[dp] >= 5;
+        }
+        if (round_up) ++n;
+      }
+      return n;
+    }
+
+    uint8_t d[max_digits];
+    int nd;
+    int dp;
+    bool negative;
+    bool truncated;
+  };
+
+  // reads a whole number token. besides json numbers a leading '+' and a bare leading or trailing
+  // dot are accepted, like before. doubles are correctly rounded.
+  static bool read_number(const char* s, const char* s_end, number_value* result) {
+    static const double exact_powers[] = {
+      1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+      1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+    const char* p = s;
+    bool negative = false;
+    if (p != s_end && (*p == '-' || *p == '+')) negative = *p++ == '-';
+
+    // the digits are gathered modulo 2^64, more than 19 of them are dealt with below
+    uint64_t w = 0;
+    const char* int_begin = p;
+    for (; p != s_end && is_digit(*p); ++p) w = 10 * w + static_cast<uint64_t>(*p - '0');
+    const char* int_end = p;
+    int64_t digits = int_end - int_begin;
+    int64_t exponent = 0;
+    bool integral = true;
+
+    if (p != s_end && *p == '.') {
+      integral = false;
+      const char* frac_begin = ++p;
+      for (; p != s_end && is_digit(*p); ++p) w = 10 * w + static_cast<uint64_t>(*p - '0');
+      exponent = frac_begin - p;
+      digits += p - frac_begin;
+    }
+    if (digits == 0) return false;
+
+    if (p != s_end && (*p == 'e' || *p == 'E')) {
+      integral = false;
+      ++p;
+      bool exp_negative = false;
+      if (p != s_end && (*p == '+' || *p == '-')) exp_negative = *p++ == '-';
+      if (p == s_end || !is_digit(*p)) return false;
+      int64_t e = 0;
+      for (; p != s_end && is_digit(*p); ++p) {
+        if (e < 0x10000000) e = 10 * e + (*p - '0');
+      }
+      exponent += exp_negative ? -e : e;
+    }
+    if (p != s_end) return false;
+
+    if (digits > 19) {
+      // leading zeros are not significant
+      for (const char* z = int_begin; z != p && (*z == '0' || *z == '.'); ++z) {
+        if (*z == '0') --digits;
+      }
+    }
+
+    if (integral) {
+      bool fits = digits <= 19;
+      if (!fits && digits == 20) {
+        // 20 digits may still fit, redo it with overflow checks
+        w = 0;
+        fits = true;
+        for (const char* c = int_begin; c != int_end; ++c) {
+          const uint64_t digit = static_cast<uint64_t>(*c - '0');
+          if (w > (0xFFFFFFFFFFFFFFFFULL - digit) / 10) {
+            fits = false;
+            break;
+          }
+          w = 10 * w + digit;
+        }
+      }
+      if (fits && !negative) {
+        if (w <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+          result->kind = number_kind::signed_integer;
+          result->int_val = static_cast<int64_t>(w);
+        } else {
+          result->kind = number_kind::unsigned_integer;
+          result->uint_val = w;
+        }
+        return true;
+      }
+      // -0 stays a double to keep its sign
+      if (fits && w != 0 && w <= (1ULL << 63)) {
+        result->kind = number_kind::signed_integer;
+        result->int_val = static_cast<int64_t>(0 - w);
+        return true;
+      }
+    }
+
+    result->kind = number_kind::real;
+    if (digits > 19) {
+      decimal slow;
+      slow.assign(s, s_end);
+      result->real = slow.to_double();
+      return true;
+    }
+
+    double value;
+    if (exponent >= -22 && exponent <= 22 && w <= (1ULL << 53)) {
+      // both operands are exact, so the one rounding of the multiply or divide is the correct one
+      value = static_cast<double>(w);
+      value = exponent < 0 ? value / exact_powers[-exponent] : value * exact_powers[exponent];
+    } else {
+      value = double_from_bits(eisel_lemire(w, exponent));
+    }
+    result->real = negative ? -value : value;
+    return true;
+  }
+
+  static const int MAX_NUMBER_STRING_SIZE = 32;
+
+  // two digits at a time from a table, a division per digit pair instead of per digit
+  FORCE_INLINE const char* digit_pairs() {
+    return "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+           "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+           "8081828384858687888990919293949596979899";
+  }
+
+  FORCE_INLINE int count_digits(uint64_t n) {
+    int digits = 1;
+    for (;;) {
+      if (n < 10) return digits;
+      if (n < 100) return digits + 1;
+      if (n < 1000) return digits + 2;
+      if (n < 10000) return digits + 3;
+      n /= 10000;
+      digits += 4;
+    }
+  }
+
+  // decimal digits of an integer, returns the end of the output
+  static char* utoa(char* s, uint64_t n) {
+    const char* pairs = digit_pairs();
+    char* end = s + count_digits(n);
+    char* p = end;
+    while (n >= 100) {
+      const uint64_t q = n / 100;
+      const char* pair = pairs + 2 * (n - q * 100);
+      *--p = pair[1];
+      *--p = pair[0];
+      n = q;
+    }
+    if (n >= 10) {
+      *--p = pairs[2 * n + 1];
+      *--p = pairs[2 * n];
+    } else {
+      *--p = static_cast<char>('0' + n);
+    }
+    return end;
+  }
+
+  static char* itoa(char* s, int64_t n) {
+    if (n < 0) {
+      *s++ = '-';
+      return utoa(s, 0 - static_cast<uint64_t>(n));
+    }
+    return utoa(s, static_cast<uint64_t>(n));
+  }
+
+  // Grisu2, "Printing Floating-Point Numbers Quickly and Accurately with Integers", Loitsch 2010.
+  // the output always reads back to the same double and is the shortest such string for all but
+  // a tiny fraction of inputs, where it is one digit longer.
+  class grisu2 {
+  public:
+    // writes the digits of a finite positive double to buf and returns their count.
+    // the value is digits * 10^decimal_exponent.
+    static int digits(double value, char* buf, int& decimal_exponent) {
+      diyfp minus, plus;
+      const diyfp v = boundaries(value, minus, plus);
+      const cached_power& cached = cached_power_for(plus.e);
+      const diyfp c(cached.f, cached.e);
+      const diyfp w = multiply(v, c);
+      diyfp w_minus = multiply(minus, c);
+      diyfp w_plus = multiply(plus, c);
+      // shrink the interval by one ulp of the approximation on each side, anything inside reads back as v
+      ++w_minus.f;
+      --w_plus.f;
+      decimal_exponent = -cached.k;
+      int length = 0;
+      generate(buf, length, decimal_exponent, w_minus, w, w_plus);
+      return length;
+    }
+
+  private:
+    // f * 2^e
+    struct diyfp {
+      FORCE_INLINE diyfp() : f(0), e(0) {}
+      FORCE_INLINE diyfp(uint64_t f, int e) : f(f), e(e) {}
+      uint64_t f;
+      int e;
+    };
+
+    struct cached_power {
+      uint64_t f;
+      int e;
+      int k;
+    };
+
+    // the digit loop needs the scaled exponent in [alpha, gamma]
+    static const int alpha = -60;
+    static const int gamma = -32;
+
+    static FORCE_INLINE diyfp multiply(const diyfp& x, const diyfp& y) {
+      uint64_t high;
+      const uint64_t low = full_multiplication(x.f, y.f, &high);
+      // round the dropped half
+      return diyfp(high + (low >> 63), x.e + y.e + 64);
+    }
+
+    static FORCE_INLINE diyfp normalize(diyfp x) {
+      const int shift = leading_zeroes(x.f);
+      return diyfp(x.f << shift, x.e - shift);
+    }
+
+    // v, and the halfway points to its neighbours, normalized to the exponent of the upper one
+    static FORCE_INLINE diyfp boundaries(double value, diyfp& minus, diyfp& plus) {
+      const uint64_t hidden_bit = 1ULL << 52;
+      const int bias = 1075;
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      const uint64_t fraction = bits & (hidden_bit - 1);
+      const int exponent = static_cast<int>(bits >> 52);
+      const diyfp v = exponent == 0 ? diyfp(fraction, 1 - bias) : diyfp(fraction + hidden_bit, exponent - bias);
+      // the gap below a power of two is half the one above
+      const bool lower_is_closer = fraction == 0 && exponent > 1;
+      plus = normalize(diyfp(2 * v.f + 1, v.e - 1));
+      minus = lower_is_closer ? diyfp(4 * v.f - 1, v.e - 2) : diyfp(2 * v.f - 1, v.e - 1);
+      minus = diyfp(minus.f << (minus.e - plus.e), plus.e);
+      return normalize(v);
+    }
+
+    // a power of ten c = f * 2^e ~ 10^k such that e + exponent lands in [alpha, gamma]
+    static const cached_power& cached_power_for(int exponent) {
+      static const cached_power powers[] = {
+      { 0xAB70FE17C79AC6CAULL, -1060, -300 }, { 0xFF77B1FCBEBCDC4FULL, -1034, -292 },
+      { 0xBE5691EF416BD60CULL, -1007, -284 }, { 0x8DD01FAD907FFC3CULL,  -980, -276 },
+      { 0xD3515C2831559A83ULL,  -954, -268 }, { 0x9D71AC8FADA6C9B5ULL,  -927, -260 },
+      { 0xEA9C227723EE8BCBULL,  -901, -252 }, { 0xAECC49914078536DULL,  -874, -244 },
+      { 0x823C12795DB6CE57ULL,  -847, -236 }, { 0xC21094364DFB5637ULL,  -821, -228 },
+      { 0x9096EA6F3848984FULL,  -794, -220 }, { 0xD77485CB25823AC7ULL,  -768, -212 },
+      { 0xA086CFCD97BF97F4ULL,  -741, -204 }, { 0xEF340A98172AACE5ULL,  -715, -196 },
+      { 0xB23867FB2A35B28EULL,  -688, -188 }, { 0x84C8D4DFD2C63F3BULL,  -661, -180 },
+      { 0xC5DD44271AD3CDBAULL,  -635, -172 }, { 0x936B9FCEBB25C996ULL,  -608, -164 },
+      { 0xDBAC6C247D62A584ULL,  -582, -156 }, { 0xA3AB66580D5FDAF6ULL,  -555, -148 },
+      { 0xF3E2F893DEC3F126ULL,  -529, -140 }, { 0xB5B5ADA8AAFF80B8ULL,  -502, -132 },
+      { 0x87625F056C7C4A8BULL,  -475, -124 }, { 0xC9BCFF6034C13053ULL,  -449, -116 },
+      { 0x964E858C91BA2655ULL,  -422, -108 }, { 0xDFF9772470297EBDULL,  -396, -100 },
+      { 0xA6DFBD9FB8E5B88FULL,  -369,  -92 }, { 0xF8A95FCF88747D94ULL,  -343,  -84 },
+      { 0xB94470938FA89BCFULL,  -316,  -76 }, { 0x8A08F0F8BF0F156BULL,  -289,  -68 },
+      { 0xCDB02555653131B6ULL,  -263,  -60 }, { 0x993FE2C6D07B7FACULL,  -236,  -52 },
+      { 0xE45C10C42A2B3B06ULL,  -210,  -44 }, { 0xAA242499697392D3ULL,  -183,  -36 },
+      { 0xFD87B5F28300CA0EULL,  -157,  -28 }, { 0xBCE5086492111AEBULL,  -130,  -20 },
+      { 0x8CBCCC096F5088CCULL,  -103,  -12 }, { 0xD1B71758E219652CULL,   -77,   -4 },
+      { 0x9C40000000000000ULL,   -50,    4 }, { 0xE8D4A51000000000ULL,   -24,   12 },
+      { 0xAD78EBC5AC620000ULL,     3,   20 }, { 0x813F3978F8940984ULL,    30,   28 },
+      { 0xC097CE7BC90715B3ULL,    56,   36 }, { 0x8F7E32CE7BEA5C70ULL,    83,   44 },
+      { 0xD5D238A4ABE98068ULL,   109,   52 }, { 0x9F4F2726179A2245ULL,   136,   60 },
+      { 0xED63A231D4C4FB27ULL,   162,   68 }, { 0xB0DE65388CC8ADA8ULL,   189,   76 },
+      { 0x83C7088E1AAB65DBULL,   216,   84 }, { 0xC45D1DF942711D9AULL,   242,   92 },
+      { 0x924D692CA61BE758ULL,   269,  100 }, { 0xDA01EE641A708DEAULL,   295,  108 },
+      { 0xA26DA3999AEF774AULL,   322,  116 }, { 0xF209787BB47D6B85ULL,   348,  124 },
+      { 0xB454E4A179DD1877ULL,   375,  132 }, { 0x865B86925B9BC5C2ULL,   402,  140 },
+      { 0xC83553C5C8965D3DULL,   428,  148 }, { 0x952AB45CFA97A0B3ULL,   455,  156 },
+      { 0xDE469FBD99A05FE3ULL,   481,  164 }, { 0xA59BC234DB398C25ULL,   508,  172 },
+      { 0xF6C69A72A3989F5CULL,   534,  180 }, { 0xB7DCBF5354E9BECEULL,   561,  188 },
+      { 0x88FCF317F22241E2ULL,   588,  196 }, { 0xCC20CE9BD35C78A5ULL,   614,  204 },
+      { 0x98165AF37B2153DFULL,   641,  212 }, { 0xE2A0B5DC971F303AULL,   667,  220 },
+      { 0xA8D9D1535CE3B396ULL,   694,  228 }, { 0xFB9B7CD9A4A7443CULL,   720,  236 },
+      { 0xBB764C4CA7A44410ULL,   747,  244 }, { 0x8BAB8EEFB6409C1AULL,   774,  252 },
+      { 0xD01FEF10A657842CULL,   800,  260 }, { 0x9B10A4E5E9913129ULL,   827,  268 },
+      { 0xE7109BFBA19C0C9DULL,   853,  276 }, { 0xAC2820D9623BF429ULL,   880,  284 },
+      { 0x80444B5E7AA7CF85ULL,   907,  292 }, { 0xBF21E44003ACDD2DULL,   933,  300 },
+      { 0x8E679C2F5E44FF8FULL,   960,  308 }, { 0xD433179D9C8CB841ULL,   986,  316 },
+      { 0x9E19DB92B4E31BA9ULL,  1013,  324 }
+      };
+      const int min_decimal_exponent = -300;
+      const int decimal_step = 8;
+      // ceil((alpha - exponent - 1) * log10(2))
+      const int f = alpha - exponent - 1;
+      const int k = (f * 78913) / (1 << 18) + (f > 0);
+      const int index = (-min_decimal_exponent + k + (decimal_step - 1)) / decimal_step;
+      return powers[index];
+    }
+
+    static FORCE_INLINE int largest_pow10(uint32_t n, uint32_t& pow10) {
+      static const uint32_t powers[] = {
+        1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+      };
+      int digits = 10;
+      while (digits > 1 && n < powers[digits - 1]) --digits;
+      pow10 = powers[digits - 1];
+      return digits;
+    }
+
+    // moves the last digit towards w while that stays inside the interval
+    static FORCE_INLINE void round_weed(char* buf, int length, uint64_t dist, uint64_t delta, uint64_t rest, uint64_t ten_k) {
+      while (rest < dist && delta - rest >= ten_k && (rest + ten_k < dist || dist - rest > rest + ten_k - dist)) {
+        --buf[length - 1];
+        rest += ten_k;
+      }
+    }
+
+    // emits digits of plus until the remainder falls inside the interval (minus, plus)
+    static void generate(char* buf, int& length, int& decimal_exponent, const diyfp& minus, const diyfp& w, const diyfp& plus) {
+      uint64_t delta = plus.f - minus.f;
+      uint64_t dist = plus.f - w.f;
+      const int shift = -plus.e;
+      const uint64_t one = 1ULL << shift;
+      uint32_t p1 = static_cast<uint32_t>(plus.f >> shift);
+      uint64_t p2 = plus.f & (one - 1);
+
+      // integral part
+      uint32_t pow10;
+      int n = largest_pow10(p1, pow10);
+      while (n > 0) {
+        const uint32_t d = p1 / pow10;
+        p1 %= pow10;
+        buf[length++] = static_cast<char>('0' + d);
+        --n;
+        const uint64_t rest = (static_cast<uint64_t>(p1) << shift) + p2;
+        if (rest <= delta) {
+          decimal_exponent += n;
+          round_weed(buf, length, dist, delta, rest, static_cast<uint64_t>(pow10) << shift);
+          return;
+        }
+        pow10 /= 10;
+      }
+
+      // fractional part
+      int m = 0;
+      for (;;) {
+        p2 *= 10;
+        buf[length++] = static_cast<char>('0' + (p2 >> shift));
+        p2 &= one - 1;
+        ++m;
+        delta *= 10;
+        dist *= 10;
+        if (p2 <= delta) break;
+      }
+      decimal_exponent -= m;
+      round_weed(buf, length, dist, delta, p2, one);
+    }
+  };
+
+  // shortest text that reads back as the same double. plain notation for exponents in [-5, 15),
+  // integral values keep a ".0" so they stay doubles on the way back. json has no nan or
+  // infinity, those become null. returns the end of the output.
+  static char* dtoa(char* s, double n) {
+    if (!std::isfinite(n)) {
+      memcpy(s, "null", 4);
+      return s + 4;
+    }
+    if (std::signbit(n)) {
+      *s++ = '-';
+      n = -n;
+    }
+    if (n == 0) {
+      memcpy(s, "0.0", 3);
+      return s + 3;
+    }
+
+    int exponent;
+    const int k = grisu2::digits(n, s, exponent);
+    // the decimal point goes after the first point digits
+    const int point = k + exponent;
+    if (k <= point && point <= 15) {
+      // digits[000].0
+      memset(s + k, '0', point - k);
+      s[point] = '.';
+      s[point + 1] = '0';
+      return s + point + 2;
+    }
+    if (0 < point && point <= 15) {
+      // dig.its
+      memmove(s + point + 1, s + point, k - point);
+      s[point] = '.';
+      return s + k + 1;
+    }
+    if (-5 < point && point <= 0) {
+      // 0.[000]digits
+      memmove(s + 2 - point, s, k);
+      s[0] = '0';
+      s[1] = '.';
+      memset(s + 2, '0', -point);
+      return s + 2 - point + k;
+    }
+
+    // d.igitse+x
+    if (k > 1) {
+      memmove(s + 2, s + 1, k - 1);
+      s[1] = '.';
+      s += k + 1;
+    } else {
+      s += 1;
+    }
+    *s++ = 'e';
+    int e = point - 1;
+    if (e < 0) {
+      *s++ = '-';
+      e = -e;
+    } else {
+      *s++ = '+';
+    }
+    return utoa(s, static_cast<uint64_t>(e));
+  }
+
+  FORCE_INLINE bool read_hex4(const char* s, const char* s_end, uint32_t* result) {
+    if (s_end - s < 4) return false;
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+      const char c = s[i];
+      value <<= 4;
+      if (is_digit(c)) value |= c - '0';
+      else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+      else return false;
+    }
+    *result = value;
+    return true;
+  }
+
+  // decodes the escape sequences of a string body into out, which needs as much room as the input.
+  // \u escapes become utf-8. returns the end of the output, or nullptr for a malformed escape.
+  static char* unescape(const char* s, const char* s_end, char* out) {
+    while (s != s_end) {
+      const char* slash = static_cast<const char*>(memchr(s, '\\', s_end - s));
+      if (!slash) slash = s_end;
+      memcpy(out, s, slash - s);
+      out += slash - s;
+      s = slash;
+      if (s == s_end) break;
+      if (++s == s_end) return nullptr;
+
+      switch (*s++) {
+        case '\"': *out++ = '\"'; break;
+        case '\\': *out++ = '\\'; break;
+        case '/': *out++ = '/'; break;
+        case 'b': *out++ = '\b'; break;
+        case 'f': *out++ = '\f'; break;
+        case 'n': *out++ = '\n'; break;
+        case 'r': *out++ = '\r'; break;
+        case 't': *out++ = '\t'; break;
+        case 'u': {
+          uint32_t code_point;
+          if (!read_hex4(s, s_end, &code_point)) return nullptr;
+          s += 4;
+          if (code_point >= 0xD800 && code_point <= 0xDBFF) {
+            // high surrogate, the low half has to follow right away
+            uint32_t low;
+            if (s_end - s < 6 || s[0] != '\\' || s[1] != 'u' || !read_hex4(s + 2, s_end, &low)
+              || low < 0xDC00 || low > 0xDFFF) return nullptr;
+            code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+            s += 6;
+          } else if (code_point >= 0xDC00 && code_point <= 0xDFFF) {
+            return nullptr;
+          }
+
+          if (code_point < 0x80) {
+            *out++ = static_cast<char>(code_point);
+          } else if (code_point < 0x800) {
+            *out++ = static_cast<char>(0xC0 | (code_point >> 6));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+          } else if (code_point < 0x10000) {
+            *out++ = static_cast<char>(0xE0 | (code_point >> 12));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+          } else {
+            *out++ = static_cast<char>(0xF0 | (code_point >> 18));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            *out++ = static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            *out++ = static_cast<char>(0x80 | (code_point & 0x3F));
+          }
+          break;
+        }
+        default:
+          return nullptr;
+      }
+    }
+    return out;
+  }
+
+  // growable output for serialize. clear() keeps the memory, so one buffer per thread can serve
+  // every response without allocating again.
+  class output_buffer {
+  public:
+    output_buffer() : buf(nullptr), len(0), cap(0) {}
+    explicit output_buffer(size_t capacity) : buf(nullptr), len(0), cap(0) {
+      reserve(capacity);
+    }
+    output_buffer(const output_buffer&) = delete;
+    output_buffer& operator=(const output_buffer&) = delete;
+    output_buffer(output_buffer&& other) : buf(other.buf), len(other.len), cap(other.cap) {
+      other.buf = nullptr;
+      other.len = other.cap = 0;
+    }
+    ~output_buffer() {
+      std::free(buf);
+    }
+
+    FORCE_INLINE void clear() { len = 0; }
+    FORCE_INLINE void reserve(size_t size) {
+      if (size > cap) grow(size);
+    }
+    FORCE_INLINE const json_char* data() const { return buf; }
+    FORCE_INLINE size_t size() const { return len; }
+    FORCE_INLINE size_t capacity() const { return cap; }
+    FORCE_INLINE bool empty() const { return len == 0; }
+    FORCE_INLINE std::basic_string<json_char> str() const { return std::basic_string<json_char>(buf, len); }
+
+    FORCE_INLINE void put(json_char c) {
+      if (len == cap) grow(len + 1);
+      buf[len++] = c;
+    }
+    FORCE_INLINE void write(const json_char* s, size_t n) {
+      if (cap - len < n) grow(len + n);
+      memcpy(buf + len, s, n * sizeof(json_char));
+      len += n;
+    }
+    FORCE_INLINE void fill(json_char c, size_t n) {
+      if (cap - len < n) grow(len + n);
+      std::fill_n(buf + len, n, c);
+      len += n;
+    }
+
+  private:
+    void grow(size_t size) {
+      size_t capacity = cap ? cap * 2 : 256;
+      while (capacity < size) capacity *= 2;
+      json_char* p = static_cast<json_char*>(std::realloc(buf, capacity * sizeof(json_char)));
+      if (!p) throw std::bad_alloc();
+      buf = p;
+      cap = capacity;
+    }
+
+    json_char* buf;
+    size_t len;
+    size_t cap;
+  };
+
+  // sinks take the serialized text chunk by chunk through bool write(const json_char*, size_t)
+  // and return false to give up.
+  class file_sink {
+  public:
+    explicit file_sink(FILE* file) : file(file) {}
+    FORCE_INLINE bool write(const json_char* s, size_t n) {
+      return fwrite(s, sizeof(json_char), n, file) == n;
+    }
+
+  private:
+    FILE* file;
+  };
+
+  class fd_sink {
+  public:
+    explicit fd_sink(int fd) : fd(fd) {}
+    bool write(const json_char* s, size_t n) {
+      const char* p = reinterpret_cast<const char*>(s);
+      size_t left = n * sizeof(json_char);
+      while (left > 0) {
+#if defined(_WIN32)
+        const int written = _write(fd, p, static_cast<unsigned int>(left));
+#else
+        const ssize_t written = ::write(fd, p, left);
+#endif
+        if (written < 0) {
+          if (errno == EINTR) continue;
+          return false;
+        }
+        p += written;
+        left -= written;
+      }
+      return true;
+    }
+    // several pieces in order, gathered into as few system calls as possible
+    bool write_parts(const basic_string_view<json_char>* parts, size_t count) {
+#if defined(_WIN32)
+      for (size_t i = 0; i < count; ++i) {
+        if (!write(parts[i].data(), parts[i].size())) return false;
+      }
+      return true;
+#else
+      iovec vec[64];
+      size_t i = 0;
+      while (i < count) {
+        size_t n = 0;
+        for (; n < 64 && i + n < count; ++n) {
+          vec[n].iov_base = const_cast<json_char*>(parts[i + n].data());
+          vec[n].iov_len = parts[i + n].size() * sizeof(json_char);
+        }
+        const ssize_t written = ::writev(fd, vec, static_cast<int>(n));
+        if (written < 0) {
+          if (errno == EINTR) continue;
+          return false;
+        }
+        // a short write finishes the piece it stopped in with plain writes
+        size_t left = static_cast<size_t>(written);
+        size_t done = 0;
+        for (; done < n && left >= vec[done].iov_len; ++done) left -= vec[done].iov_len;
+        i += done;
+        if (done < n && left > 0) {
+          if (!write(parts[i].data() + left / sizeof(json_char), parts[i].size() - left / sizeof(json_char))) return false;
+          ++i;
+        }
+      }
+      return true;
+#endif
+    }
+
+  private:
+    int fd;
+  };
+
+  // a read only file mapped into memory, for parsing without copying it into a string first. the
+  // parser is bounded by the length, so no terminating nul or padding is needed. the kernel is told
+  // the file is read once front to back, and to back it with huge pages where it can. where mmap is
+  // missing the file is read into memory instead.
+  class mapped_file {
+  public:
+    mapped_file() : addr(nullptr), len(0), mapped(false) {}
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator=(const mapped_file&) = delete;
+    ~mapped_file() {
+      close();
+    }
+
+    bool open(const std::string& path, std::string& err) {
+      close();
+#if defined(_WIN32)
+      FILE* file = fopen(path.c_str(), "rb");
+      if (!file) {
+        err = "can not open file.";
+        return false;
+      }
+      char buf[1 << 16];
+      size_t n;
+      while ((n = fread(buf, 1, sizeof(buf), file)) > 0) copy.append(buf, n);
+      const bool failed = ferror(file) != 0;
+      fclose(file);
+      if (failed) {
+        err = "can not read file.";
+        return false;
+      }
+      addr = copy.data();
+      len = copy.size();
+      return true;
+#else
+      int fd;
+      do {
+        fd = ::open(path.c_str(), O_RDONLY);
+      } while (fd < 0 && errno == EINTR);
+      if (fd < 0) {
+        err = "can not open file.";
+        return false;
+      }
+      struct stat st;
+      if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        err = "can not map file.";
+        return false;
+      }
+      len = static_cast<size_t>(st.st_size);
+      // an empty file can not be mapped, it parses as an empty buffer
+      if (len == 0) {
+        ::close(fd);
+        addr = "";
+        return true;
+      }
+      void* p = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+      ::close(fd);
+      if (p == MAP_FAILED) {
+        len = 0;
+        err = "can not map file.";
+        return false;
+      }
+      // only advice, failures change nothing
+#if defined(MADV_HUGEPAGE)
+      madvise(p, len, MADV_HUGEPAGE);
+#endif
+      madvise(p, len, MADV_SEQUENTIAL);
+      madvise(p, len, MADV_WILLNEED);
+      addr = static_cast<const char*>(p);
+      mapped = true;
+      return true;
+#endif
+    }
+
+    void close() {
+#if !defined(_WIN32)
+      if (mapped) munmap(const_cast<char*>(addr), len);
+#endif
+      std::string().swap(copy);
+      addr = nullptr;
+      len = 0;
+      mapped = false;
+    }
+
+    FORCE_INLINE const char* data() const { return addr; }
+    FORCE_INLINE size_t size() const { return len; }
+    FORCE_INLINE bool is_open() const { return addr != nullptr; }
+
+  private:
+    const char* addr;
+    size_t len;
+    bool mapped;
+    std::string copy;
+  };
+
+  // calls f(const json_char*, size_t) for every chunk, f returns false to give up
+  template <typename F>
+  class callback_sink {
+  public:
+    explicit callback_sink(F f) : f(f) {}
+    FORCE_INLINE bool write(const json_char* s, size_t n) { return f(s, n); }
+
+  private:
+    F f;
+  };
+
+  template <typename F>
+  FORCE_INLINE callback_sink<F> make_callback_sink(F f) {
+    return callback_sink<F>(f);
+  }
+
+  // the writers serialize goes through, they only ever append in bulk
+  template <typename String>
+  class string_writer {
+  public:
+    explicit string_writer(String& s) : s(s) {}
+    FORCE_INLINE void put(json_char c) { s.push_back(c); }
+    FORCE_INLINE void write(const json_char* p, size_t n) { s.append(p, n); }
+    FORCE_INLINE void fill(json_char c, size_t n) { s.append(n, c); }
+
+  private:
+    String& s;
+  };
+
+  // collects the output in a fixed chunk and hands every full one to the sink, so a big document
+  // streams out without ever being held in memory as a whole
+  template <typename Sink>
+  class chunked_writer {
+  public:
+    static const size_t chunk_size = 16 * 1024;
+
+    explicit chunked_writer(Sink& sink) : sink(sink), len(0), ok(true) {}
+
+    FORCE_INLINE void put(json_char c) {
+      if (len == chunk_size) flush();
+      chunk[len++] = c;
+    }
+    FORCE_INLINE void write(const json_char* s, size_t n) {
+      while (n > chunk_size - len) {
+        const size_t part = chunk_size - len;
+        memcpy(chunk + len, s, part * sizeof(json_char));
+        len = chunk_size;
+        s += part;
+        n -= part;
+        flush();
+      }
+      memcpy(chunk + len, s, n * sizeof(json_char));
+      len += n;
+    }
+    FORCE_INLINE void fill(json_char c, size_t n) {
+      while (n > chunk_size - len) {
+        const size_t part = chunk_size - len;
+        std::fill_n(chunk + len, part, c);
+        len = chunk_size;
+        n -= part;
+        flush();
+      }
+      std::fill_n(chunk + len, n, c);
+      len += n;
+    }
+    // false once the sink gave up, everything after that is dropped
+    bool flush() {
+      TINYJSON_STAT(json_stats::local().serialized_bytes += len);
+      if (ok && len) ok = sink.write(chunk, len);
+      len = 0;
+      return ok;
+    }
+
+  private:
+    Sink& sink;
+    size_t len;
+    bool ok;
+    json_char chunk[chunk_size];
+  };
+
+  // a quoted json string, quotes, backslashes and control characters escaped
+  template <typename Writer>
+  FORCE_INLINE void write_escaped(Writer& out, const json_char* str, size_t length) {
+    static const char* hex = "0123456789abcdef";
+    out.put('\"');
+    const json_char* run = str;
+    const json_char* end = str + length;
+    for (const json_char* c = run; c != end; ++c) {
+      if (static_cast<typename std::make_unsigned<json_char>::type>(*c) >= 0x20 && *c != '\"' && *c != '\\') continue;
+      out.write(run, c - run);
+      run = c + 1;
+      out.put('\\');
+      switch (*c) {
+        case '\"': out.put('\"'); break;
+        case '\\': out.put('\\'); break;
+        case '\b': out.put('b'); break;
+        case '\f': out.put('f'); break;
+        case '\n': out.put('n'); break;
+        case '\r': out.put('r'); break;
+        case '\t': out.put('t'); break;
+        default:
+          out.put('u');
+          out.put('0');
+          out.put('0');
+          out.put(hex[(*c >> 4) & 0xF]);
+          out.put(hex[*c & 0xF]);
+          break;
+      }
+    }
+    out.write(run, end - run);
+    out.put('\"');
+  }
+
+  // a line break followed by the indentation of the given level
+  template <typename Writer>
+  FORCE_INLINE void write_indent(Writer& out, int indent, unsigned int indent_size) {
+    out.put('\n');
+    out.fill(' ', indent * indent_size);
+  }
+
+  template <typename Alloc, typename String = std::basic_string<json_char, std::char_traits<json_char>,
+    typename std::allocator_traits<Alloc>::template rebind_alloc<json_char>>>
+  class basic_json_node {
+    friend class json_parser;
+    template <typename> friend class basic_json_document;
+    template <typename> friend class dom_builder;
+    template <typename, typename> friend struct json_binding;
+    friend class parallel_serializer;
+  public:
+    typedef Alloc allocator_type;
+    typedef bool boolean;
+    typedef double number;
+    typedef int64_t integer;
+    typedef json_char char_type;
+    // an owning std::basic_string, or a string_view for documents that point into their input
+    typedef String string;
+    typedef std::vector<basic_json_node*,
+      typename std::allocator_traits<Alloc>::template rebind_alloc<basic_json_node*>> array;
+    typedef linked_hash_map<string, basic_json_node*,
+      typename std::allocator_traits<Alloc>::template rebind_alloc<std::pair<string, basic_json_node*>>> object;
+    union Storage {
+      boolean bool_val;
+      number num_val;
+      integer int_val;
+      uint64_t uint_val;
+      string* str_val;
+      array* array_val;
+      object* object_val;
+    };
+
+    FORCE_INLINE basic_json_node() : storage(), type(node_type::null_type), num_kind(), alloc() {}
+    FORCE_INLINE explicit basic_json_node(const allocator_type& alloc) : storage(), type(node_type::null_type), num_kind(), alloc(alloc) {}
+    FORCE_INLINE basic_json_node(const basic_json_node& other) : storage(), type(), num_kind(), alloc(other.alloc) { *this = other; }
+    FORCE_INLINE basic_json_node(basic_json_node&& other) noexcept
+      : storage(other.storage), type(other.type), num_kind(other.num_kind), alloc(other.alloc) { other.type = node_type::null_type; }
+    // copies or moves other into a tree drawn from alloc, a move is a copy when the allocators differ
+    FORCE_INLINE basic_json_node(const basic_json_node& other, const allocator_type& alloc)
+      : storage(), type(), num_kind(), alloc(alloc) { *this = other; }
+    FORCE_INLINE basic_json_node(basic_json_node&& other, const allocator_type& alloc)
+      : storage(), type(), num_kind(), alloc(alloc) { *this = std::move(other); }
+    explicit basic_json_node(boolean val, const allocator_type& alloc = allocator_type())
+      : storage(), type(node_type::boolean_type), num_kind(), alloc(alloc) { storage.bool_val = val; }
+    explicit basic_json_node(number val, const allocator_type& alloc = allocator_type())
+      : storage(), type(node_type::number_type), num_kind(), alloc(alloc) { storage.num_val = val; }
+    // any integer type, kept exact
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, boolean>::value>::type>
+    explicit basic_json_node(T val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set_integer(val); }
+    explicit basic_json_node(const string& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(val); }
+    explicit basic_json_node(string&& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(std::move(val)); }
+
+#if USE_UNICODE
+    explicit basic_json_node(const char16_t* val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(val); }
+#else
+    explicit basic_json_node(const char* val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(val); }
+#endif
+    explicit basic_json_node(const array& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(val); }
+    explicit basic_json_node(const object& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(val); }
+    // an rvalue array or object hands its elements over to the node instead of being deep copied,
+    // so they have to come from the node's allocator (plain new for json_node)
+    explicit basic_json_node(array&& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(std::move(val)); }
+    explicit basic_json_node(object&& val, const allocator_type& alloc = allocator_type())
+      : storage(), type(), num_kind(), alloc(alloc) { set(std::move(val)); }
+    ~basic_json_node() {
+      clear();
+    }
+
+    FORCE_INLINE basic_json_node& get_node(const string& key) {
+      static basic_json_node null_node;
+      if (!is_object()) return null_node;
+      typename object::iterator iter = storage.object_val->find(key);
+      return iter != storage.object_val->end() ? *(iter->second) : null_node;
+    }
+    FORCE_INLINE const basic_json_node& get_node(const string& key) const {
+      static const basic_json_node null_node;
+      if (!is_object()) return null_node;
+      typename object::const_iterator citer = storage.object_val->find(key);
+      return citer != storage.object_val->cend() ? *(citer->second) : null_node;
+    }
+    FORCE_INLINE basic_json_node& get_element(const size_t index) {
+      static basic_json_node null_node;
+      if (!is_array()) return null_node;
+      return index < storage.array_val->size() ? *(*storage.array_val)[index] : null_node;
+    }
+    FORCE_INLINE const basic_json_node& get_element(const size_t index) const {
+      static const basic_json_node null_node;
+      if (!is_array()) return null_node;
+      return index < storage.array_val->size() ? *(*storage.array_val)[index] : null_node;
+    }
+    FORCE_INLINE boolean get_boolean() const {
+      _ASSERT(is_boolean());
+      return storage.bool_val;
+    }
+    FORCE_INLINE number get_number() const {
+      _ASSERT(is_number());
+      switch (num_kind) {
+        case number_kind::signed_integer:
+          return static_cast<number>(storage.int_val);
+        case number_kind::unsigned_integer:
+          return static_cast<number>(storage.uint_val);
+        default:
+          return storage.num_val;
+      }
+    }
+    // the exact value of an integer in range, doubles are truncated. anything the type can not hold
+    // saturates at its limits: integers above INT64_MAX read as INT64_MAX here, negative ones as 0
+    // from get_unsigned.
+    FORCE_INLINE integer get_integer() const {
+      _ASSERT(is_number());
+      switch (num_kind) {
+        case number_kind::real: return saturate_int64(storage.num_val);
+        case number_kind::unsigned_integer: return std::numeric_limits<integer>::max();
+        default: return storage.int_val;
+      }
+    }
+    FORCE_INLINE uint64_t get_unsigned() const {
+      _ASSERT(is_number());
+      switch (num_kind) {
+        case number_kind::real: return saturate_uint64(storage.num_val);
+        case number_kind::signed_integer: return storage.int_val < 0 ? 0 : static_cast<uint64_t>(storage.int_val);
+        default: return storage.uint_val;
+      }
+    }
+    FORCE_INLINE string& get_string() const {
+      _ASSERT(is_string());
+      return *(storage.str_val);
+    }
+    FORCE_INLINE array& get_array() const {
+      _ASSERT(is_array());
+      return *(storage.array_val);
+    }
+    FORCE_INLINE object& get_object() const {
+      _ASSERT(is_object());
+      return *(storage.object_val);
+    }
+    FORCE_INLINE allocator_type get_allocator() const { return alloc; }
+    FORCE_INLINE basic_json_node& operator[](size_t index) { return this->get_element(index); }
+    FORCE_INLINE const basic_json_node& operator[](size_t index) const { return this->get_element(index); }
+    FORCE_INLINE basic_json_node& operator[](const string& key) { return this->get_node(key); }
+    FORCE_INLINE const basic_json_node& operator[](const string& key) const { return this->get_node(key); }
+    FORCE_INLINE bool has(const string& key) const {
+      if(!is_object()) return false;
+      return storage.object_val->find(key) != storage.object_val->cend();
+    }
+    // lookups with a key out of a key_table, which is hashed already
+    FORCE_INLINE const basic_json_node& get_node(const key_table::symbol& key) const {
+      static const basic_json_node null_node;
+      if (!is_object()) return null_node;
+      typename object::const_iterator citer = storage.object_val->find(key.str, key.length, key.hash);
+      return citer != storage.object_val->cend() ? *(citer->second) : null_node;
+    }
+    FORCE_INLINE const basic_json_node& operator[](const key_table::symbol& key) const { return get_node(key); }
+    FORCE_INLINE bool has(const key_table::symbol& key) const {
+      if(!is_object()) return false;
+      return storage.object_val->find(key.str, key.length, key.hash) != storage.object_val->cend();
+    }
+    FORCE_INLINE size_t length() const {
+      switch (type) {
+        case node_type::string_type:
+          return storage.str_val->size();
+        case node_type::array_type:
+          return storage.array_val->size();
+        case node_type::object_type:
+          return storage.object_val->size();
+        default:
+          return 0;
+      }
+    }
+    FORCE_INLINE std::string to_string() const {
+      switch (type) {
+        case node_type::string_type:
+          return "string";
+        case node_type::object_type:
+          return "object";
+        case node_type::array_type:
+          return "array";
+        case node_type::null_type:
+          return "null";
+        case node_type::number_type:
+          return "number";
+        case node_type::boolean_type:
+          return "boolean";
+      }
+    }
+    FORCE_INLINE bool to_boolean() const {
+      switch (type) {
+        case node_type::null_type:
+          return false;
+        case node_type::boolean_type:
+          return storage.bool_val;
+        case node_type::number_type:
+          return num_kind == number_kind::real ? storage.num_val != 0 : storage.int_val != 0;
+        case node_type::string_type:
+          return !storage.str_val->empty();
+        default:
+          return true;
+      }
+    }
+    FORCE_INLINE std::basic_string<char_type> serialize(bool prettify = false, unsigned int indent_size = 2) const {
+      std::basic_string<char_type> s;
+      string_writer<std::basic_string<char_type>> out(s);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      TINYJSON_STAT(json_stats::local().serialized_bytes += s.size());
+      return s;
+    }
+    // appends to out, which is not cleared first
+    FORCE_INLINE void serialize(output_buffer& out, bool prettify = false, unsigned int indent_size = 2) const {
+      TINYJSON_STAT(const size_t before = out.size());
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      TINYJSON_STAT(json_stats::local().serialized_bytes += out.size() - before);
+    }
+    // streams to a sink such as file_sink, fd_sink or a callback_sink. false when the sink failed
+    template <typename Sink>
+    bool serialize_to(Sink& sink, bool prettify = false, unsigned int indent_size = 2) const {
+      chunked_writer<Sink> out(sink);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      return out.flush();
+    }
+    basic_json_node& operator=(const basic_json_node& other) {
+      if (this != &other) {
+        clear();
+
+        switch (other.type) {
+          case node_type::string_type:
+            set(*other.storage.str_val);
+            break;
+          case node_type::array_type:
+            set(*other.storage.array_val);
+            break;
+          case node_type::object_type:
+            set(*other.storage.object_val);
+            break;
+          default:
+            type = other.type;
+            num_kind = other.num_kind;
+            storage = other.storage;
+            break;
+        }
+      }
+
+      return *this;
+    }
+    // the allocator stays with the node, so a move between trees with different allocators is a copy
+    // and can throw. only allocators that always compare equal make it noexcept.
+    basic_json_node& operator=(basic_json_node&& other) noexcept(std::allocator_traits<Alloc>::is_always_equal::value) {
+      if (this == &other) return *this;
+      if (alloc != other.alloc) return *this = static_cast<const basic_json_node&>(other);
+
+      // other may live inside this tree, so it is detached before the old value goes
+      const Storage taken = other.storage;
+      const node_type taken_type = other.type;
+      const number_kind taken_kind = other.num_kind;
+      other.type = node_type::null_type;
+      clear();
+      storage = taken;
+      type = taken_type;
+      num_kind = taken_kind;
+      return *this;
+    }
+    FORCE_INLINE basic_json_node& operator=(const boolean other) {
+      clear();
+      set(other);
+      return *this;
+    }
+    FORCE_INLINE basic_json_node& operator=(const double other) {
+      clear();
+      set(other);
+      return *this;
+    }
+    template <typename T>
+    FORCE_INLINE typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, boolean>::value, basic_json_node&>::type
+    operator=(const T other) {
+      clear();
+      set_integer(other);
+      return *this;
+    }
+    FORCE_INLINE basic_json_node& operator=(const string& other) {
+      clear();
+      set(other);
+      return *this;
+    }
+    FORCE_INLINE basic_json_node& operator=(string&& other) {
+      clear();
+      set(std::move(other));
+      return *this;
+    }
+#if USE_UNICODE
+    FORCE_INLINE basic_json_node& operator=(const char16_t* other) {
+      clear();
+      set(other);
+      return *this;
+    }
+#else
+    FORCE_INLINE basic_json_node& operator=(const char* other) {
+      clear();
+      set(other);
+      return *this;
+    }
+#endif
+    basic_json_node& operator=(const array& other) {
+      clear();
+      set(other);
+      return *this;
+    }
+    basic_json_node& operator=(const object& other) {
+      clear();
+      set(other);
+      return *this;
+    }
+    basic_json_node& operator=(array&& other) {
+      clear();
+      set(std::move(other));
+      return *this;
+    }
+    basic_json_node& operator=(object&& other) {
+      clear();
+      set(std::move(other));
+      return *this;
+    }
+    // builds a new element at the end of an array in place, from anything a node can be made of.
+    // a null node becomes an empty array first.
+    template <typename... Args>
+    basic_json_node& emplace_back(Args&&... args) {
+      if (is_null()) set(create<array>(alloc));
+      _ASSERT(is_array());
+      basic_json_node* elem = create_node(std::forward<Args>(args)...);
+      storage.array_val->emplace_back(elem);
+      return *elem;
+    }
+    // adds a member to an object the same way, a null node becomes an empty object first.
+    // like insert() on the object, a duplicated key is appended but lookups find the first one.
+    template <typename... Args>
+    basic_json_node& emplace(const string& key, Args&&... args) {
+      return emplace_member(string_traits<string>::copy(key.data(), key.size(), alloc), std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    basic_json_node& emplace(string&& key, Args&&... args) {
+      return emplace_member(string_traits<string>::take(std::move(key), alloc), std::forward<Args>(args)...);
+    }
+    template <typename... Args>
+    basic_json_node& emplace(const char_type* key, Args&&... args) {
+      return emplace_member(string_traits<string>::copy(key, std::char_traits<char_type>::length(key), alloc), std::forward<Args>(args)...);
+    }
+    // room for size elements or members, ahead of emplace_back() or emplace()
+    void reserve(size_t size) {
+      if (is_array()) storage.array_val->reserve(size);
+      else if (is_object()) storage.object_val->reserve(size);
+    }
+    bool operator==(const basic_json_node& other) const {
+      if (type != other.type) {
+        return false;
+      }
+
+      switch (type) {
+        case node_type::string_type:
+          return *(storage.str_val) == *(other.storage.str_val);
+        case node_type::number_type:
+          // integers compare exactly, anything else as doubles
+          if (num_kind != number_kind::real && other.num_kind != number_kind::real) {
+            return num_kind == other.num_kind && storage.int_val == other.storage.int_val;
+          }
+          return is_equal(get_number(), other.get_number());
+        case node_type::boolean_type:
+          return storage.bool_val == other.storage.bool_val;
+        case node_type::object_type: {
+          const object* l = this->storage.object_val;
+          const object* r = other.storage.object_val;
+
+          return (l->size() == r->size()) && std::equal(l->cbegin(), l->cend(), r->cbegin(),
+                  [](const auto& left, const auto& right) {
+                    return (left.first == right.first) && (*left.second == *right.second);
+                  });
+        }
+        case node_type::array_type: {
+          const array* l = this->storage.array_val;
+          const array* r = other.storage.array_val;
+
+          return (l->size() == r->size()) && std::equal(l->cbegin(), l->cend(), r->cbegin(),
+                  [](const auto& left, const auto& right) {
+                    return (*left == *right);
+                  });
+        }
+        default:
+          return true;
+      }
+    }
+    FORCE_INLINE bool operator!=(const basic_json_node& other) const {
+      return !(*this == other);
+    }
+    FORCE_INLINE bool operator==(const string& other) const {
+      if (type != node_type::string_type) {
+        return false;
+      }
+
+      return *(storage.str_val) == other;
+    }
+    FORCE_INLINE bool operator!=(const string& other) const {
+      return !(*this == other);
+    }
+    FORCE_INLINE bool operator==(const double other) const {
+      if (type != node_type::number_type) {
+        return false;
+      }
+
+      return is_equal(get_number(), other);
+    }
+    FORCE_INLINE bool operator!=(const double other) const {
+      return !(*this == other);
+    }
+    template <typename T>
+    FORCE_INLINE typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, boolean>::value, bool>::type
+    operator==(const T other) const {
+      if (type != node_type::number_type) {
+        return false;
+      }
+
+      switch (num_kind) {
+        case number_kind::signed_integer:
+          return other < 0 ? storage.int_val == static_cast<integer>(other)
+                           : storage.int_val >= 0 && static_cast<uint64_t>(storage.int_val) == static_cast<uint64_t>(other);
+        case number_kind::unsigned_integer:
+          return other >= 0 && storage.uint_val == static_cast<uint64_t>(other);
+        default:
+          return is_equal(storage.num_val, static_cast<number>(other));
+      }
+    }
+    template <typename T>
+    FORCE_INLINE typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, boolean>::value, bool>::type
+    operator!=(const T other) const {
+      return !(*this == other);
+    }
+    FORCE_INLINE bool is_null() const { return type == node_type::null_type; }
+    FORCE_INLINE bool is_boolean() const { return type == node_type::boolean_type; }
+    FORCE_INLINE bool is_number() const { return type == node_type::number_type; }
+    // a number held as an exact 64 bit integer
+    FORCE_INLINE bool is_integer() const { return type == node_type::number_type && num_kind != number_kind::real; }
+    FORCE_INLINE bool is_string() const { return type == node_type::string_type; }
+    FORCE_INLINE bool is_array() const { return type == node_type::array_type; }
+    FORCE_INLINE bool is_object() const { return type == node_type::object_type; }
+
+  private:
+    template <typename T, typename... Args>
+    FORCE_INLINE T* create(Args&&... args) const {
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T> a(alloc);
+      T* p = a.allocate(1);
+      ::new (static_cast<void*>(p)) T(std::forward<Args>(args)...);
+      return p;
+    }
+    template <typename T>
+    FORCE_INLINE void destroy(T* p) const {
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T> a(alloc);
+      p->~T();
+      a.deallocate(p, 1);
+    }
+    template <typename... Args>
+    FORCE_INLINE basic_json_node* create_node(Args&&... args) const { return create<basic_json_node>(std::forward<Args>(args)..., alloc); }
+    template <typename... Args>
+    basic_json_node& emplace_member(string&& key, Args&&... args) {
+      if (is_null()) set(create<object>(alloc));
+      _ASSERT(is_object());
+      basic_json_node* elem = create_node(std::forward<Args>(args)...);
+      storage.object_val->insert(std::make_pair(std::move(key), elem));
+      return *elem;
+    }
+    void clear() {
+      // arena backed trees are given back all at once by their owner
+      if (releases_in_bulk(alloc)) {
+        type = node_type::null_type;
+        return;
+      }
+
+      switch (type) {
+        case node_type::string_type:
+          destroy(storage.str_val);
+          break;
+        case node_type::array_type:
+          for (basic_json_node* elem : *(storage.array_val)) {
+            destroy(elem);
+          }
+          destroy(storage.array_val);
+          break;
+        case node_type::object_type:
+          for (const auto& elem : *(storage.object_val)) {
+            destroy(elem.second);
+          }
+          destroy(storage.object_val);
+          break;
+        default:
+          break;
+      }
+      type = node_type::null_type;
+    }
+    FORCE_INLINE void set(boolean val) { type = node_type::boolean_type; storage.bool_val = val; }
+    FORCE_INLINE void set(number val) { type = node_type::number_type; num_kind = number_kind::real; storage.num_val = val; }
+    FORCE_INLINE void set(const number_value& val) {
+      type = node_type::number_type;
+      num_kind = val.kind;
+      if (val.kind == number_kind::real) storage.num_val = val.real;
+      else storage.uint_val = val.uint_val;
+    }
+    template <typename T>
+    FORCE_INLINE void set_integer(T val) {
+      type = node_type::number_type;
+      if (std::is_signed<T>::value || static_cast<uint64_t>(val) <= static_cast<uint64_t>(std::numeric_limits<integer>::max())) {
+        num_kind = number_kind::signed_integer;
+        storage.int_val = static_cast<integer>(val);
+      } else {
+        num_kind = number_kind::unsigned_integer;
+        storage.uint_val = static_cast<uint64_t>(val);
+      }
+    }
+    FORCE_INLINE void set(const string& val) { set(val.data(), val.size()); }
+    FORCE_INLINE void set(string&& val) {
+      type = node_type::string_type;
+      storage.str_val = create<string>(string_traits<string>::take(std::move(val), alloc));
+    }
+#if USE_UNICODE
+    FORCE_INLINE void set(const char16_t* val) { set(val, std::char_traits<char16_t>::length(val)); }
+#else
+    FORCE_INLINE void set(const char* val) { set(val, strlen(val)); }
+#endif
+    FORCE_INLINE void set(const char_type* val, size_t length) {
+      type = node_type::string_type;
+      storage.str_val = create<string>(string_traits<string>::copy(val, length, alloc));
+    }
+    void set(const array& val) {
+      type = node_type::array_type;
+      storage.array_val = create<array>(alloc);
+      storage.array_val->reserve(val.size());
+      // deep copy
+      for (auto e : val) {
+        basic_json_node* elem = create_node();
+        *elem = *e;
+        storage.array_val->emplace_back(elem);
+      }
+    }
+    void set(const object& val) {
+      type = node_type::object_type;
+      storage.object_val = create<object>(val.size(), alloc);
+      // deep copy
+      auto begin = val.cbegin();
+      auto end = val.cend();
+      for (; begin != end; ++begin) {
+        basic_json_node* elem = create_node();
+        *elem = *(begin->second);
+        storage.object_val->insert(std::make_pair(string_traits<string>::copy(begin->first.data(), begin->first.size(), alloc), elem));
+      }
+    }
+    // takes the element nodes over when the allocators agree, copies them otherwise
+    void set(array&& val) {
+      if (val.get_allocator() != alloc) return set(static_cast<const array&>(val));
+      type = node_type::array_type;
+      storage.array_val = create<array>(std::move(val));
+    }
+    void set(object&& val) {
+      if (val.get_allocator() != alloc) return set(static_cast<const object&>(val));
+      type = node_type::object_type;
+      storage.object_val = create<object>(std::move(val));
+    }
+    FORCE_INLINE void set(string* val) { type = node_type::string_type; storage.str_val = val; }
+    FORCE_INLINE void set(array* val) { type = node_type::array_type; storage.array_val = val; }
+    FORCE_INLINE void set(object* val) { type = node_type::object_type; storage.object_val = val; }
+    template <typename Writer>
+    void _serialize(int indent, Writer& out, unsigned int indent_size) const {
+      switch (type) {
+        case node_type::string_type:
+          write_escaped(out, storage.str_val->data(), storage.str_val->size());
+          break;
+        case node_type::object_type: {
+          out.put('{');
+          if (indent != -1) {
+            ++indent;
+          }
+          auto cbegin = storage.object_val->cbegin();
+          auto cend = storage.object_val->cend();
+          for (auto citer = cbegin; citer != cend; ++citer) {
+            if (citer != cbegin) {
+              out.put(',');
+            }
+            if (indent != -1) {
+              write_indent(out, indent, indent_size);
+            }
+            write_escaped(out, citer->first.data(), citer->first.size());
+            out.put(':');
+            if (indent != -1) {
+              out.put(' ');
+            }
+            citer->second->_serialize(indent, out, indent_size);
+          }
+          if (indent != -1) {
+            --indent;
+            if (!storage.object_val->empty()) {
+              write_indent(out, indent, indent_size);
+            }
+          }
+          out.put('}');
+          break;
+        }
+        case node_type::array_type: {
+          out.put('[');
+          if (indent != -1) {
+            ++indent;
+          }
+          auto cbegin = storage.array_val->cbegin();
+          auto cend = storage.array_val->cend();
+          for (auto citer = cbegin; citer != cend; ++citer) {
+            if (citer != cbegin) {
+              out.put(',');
+            }
+            if (indent != -1) {
+              write_indent(out, indent, indent_size);
+            }
+            (*citer)->_serialize(indent, out, indent_size);
+          }
+          if (indent != -1) {
+            --indent;
+            if (!storage.array_val->empty()) {
+              write_indent(out, indent, indent_size);
+            }
+          }
+          out.put(']');
+          break;
+        }
+        case node_type::null_type: {
+          out.write("null", 4);
+          break;
+        }
+        case node_type::number_type: {
+          char buf[MAX_NUMBER_STRING_SIZE];
+          const char* e;
+          switch (num_kind) {
+            case number_kind::signed_integer:
+              e = itoa(buf, storage.int_val);
+              break;
+            case number_kind::unsigned_integer:
+              e = utoa(buf, storage.uint_val);
+              break;
+            default:
+              e = dtoa(buf, storage.num_val);
+              break;
+          }
+          out.write(buf, e - buf);
+          break;
+        }
+        case node_type::boolean_type: {
+          if (storage.bool_val) {
+            out.write("true", 4);
+          } else {
+            out.write("false", 5);
+          }
+          break;
+        }
+      }
+    }
+
+    Storage storage;
+    node_type type;
+    number_kind num_kind;
+    allocator_type alloc;
+  };
+
+  typedef basic_json_node<std::allocator<char>> json_node;
+  // nodes of a json_document, everything they own lives in the document's arena
+  typedef basic_json_node<arena_allocator<char>> document_node;
+  // nodes of a json_view_document, their strings and keys point into the parsed buffer
+  typedef basic_json_node<arena_allocator<char>, string_view> view_node;
+  // nodes whose memory comes from a memory_resource picked at runtime
+  typedef basic_json_node<resource_allocator<char>> resource_node;
+
+  typedef json_node::boolean boolean;
+  typedef json_node::number number;
+  typedef json_node::string string;
+  typedef json_node::array array;
+  typedef json_node::object object;
+
+  enum class simd_level {
+    scalar = 0,
+    sse42,
+    avx2
+  };
+
+  FORCE_INLINE int trailing_zeroes(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+  }
+
+  // one bit per byte of a 64 byte block
+  struct block_masks {
+    uint64_t quote;
+    uint64_t backslash;
+    uint64_t op;
+    uint64_t whitespace;
+  };
+
+  // turns the character classes of consecutive blocks into structural bits. escapes, strings and
+  // scalar runs are tracked across block boundaries, so a block is never looked at twice.
+  class structural_scanner {
+  public:
+    FORCE_INLINE structural_scanner() : prev_escaped(0), prev_in_string(0), prev_scalar(0) {}
+
+    // operators and scalar starts outside of strings, plus the opening and closing quote of every string
+    FORCE_INLINE uint64_t next(const block_masks& m) {
+      const uint64_t quote = m.quote & ~escaped(m.backslash);
+      const uint64_t in_string = prefix_xor(quote) ^ prev_in_string;
+      prev_in_string = static_cast<uint64_t>(static_cast<int64_t>(in_string) >> 63);
+
+      const uint64_t scalar = ~(m.op | m.whitespace | quote);
+      const uint64_t scalar_start = scalar & ~((scalar << 1) | prev_scalar);
+      prev_scalar = scalar >> 63;
+
+      return ((m.op | scalar_start) & ~in_string) | quote;
+    }
+
+    FORCE_INLINE bool in_string() const { return prev_in_string != 0; }
+
+  private:
+    // characters preceded by an odd run of backslashes
+    FORCE_INLINE uint64_t escaped(uint64_t backslash) {
+      if (!backslash && !prev_escaped) return 0;
+      const uint64_t even_bits = 0x5555555555555555ULL;
+      backslash &= ~prev_escaped;
+      const uint64_t follows_escape = (backslash << 1) | prev_escaped;
+      const uint64_t odd_sequence_starts = backslash & ~even_bits & ~follows_escape;
+      const uint64_t sequences_starting_on_even_bits = odd_sequence_starts + backslash;
+      prev_escaped = sequences_starting_on_even_bits < odd_sequence_starts ? 1 : 0;
+      const uint64_t invert_mask = sequences_starting_on_even_bits << 1;
+      return (even_bits ^ invert_mask) & follows_escape;
+    }
+
+    static FORCE_INLINE uint64_t prefix_xor(uint64_t bits) {
+      bits ^= bits << 1;
+      bits ^= bits << 2;
+      bits ^= bits << 4;
+      bits ^= bits << 8;
+      bits ^= bits << 16;
+      bits ^= bits << 32;
+      return bits;
+    }
+
+    uint64_t prev_escaped;
+    uint64_t prev_in_string;
+    uint64_t prev_scalar;
+  };
+
+  // stage 1 of the parser: a single pass over the input that records where every token starts,
+  // so the recursive descent never has to skip whitespace or search for the end of a string.
+  class structural_index {
+  public:
+    static const size_t block_size = 64;
+
+    // best instruction set of the running cpu, detected once
+    static simd_level best_level() {
+      static const simd_level level = detect();
+      return level;
+    }
+
+    // writes the offset of every structural character into out, which needs room for length entries.
+    // returns false when the input ends inside a string.
+    static bool scan(const char* json, size_t length, uint32_t* out, size_t& count, simd_level level = best_level()) {
+      TINYJSON_STAT(json_stats::local().bytes_scanned += length);
+      structural_scanner scanner;
+      uint32_t* end;
+      switch (level) {
+#if TINYJSON_X86
+        case simd_level::avx2:
+          end = scan_avx2(scanner, json, length, out);
+          break;
+        case simd_level::sse42:
+          end = scan_sse42(scanner, json, length, out);
+          break;
+#endif
+        default:
+          end = scan_scalar(scanner, json, length, out);
+          break;
+      }
+      count = end - out;
+      return !scanner.in_string();
+    }
+
+  private:
+    static simd_level detect() {
+#if TINYJSON_X86
+#if defined(_MSC_VER)
+      int info[4];
+      __cpuid(info, 0);
+      const int max_leaf = info[0];
+      __cpuid(info, 1);
+      const bool sse42 = (info[2] >> 20) & 1;
+      const bool os_avx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 6) == 6;
+      bool avx2 = false;
+      if (max_leaf >= 7 && os_avx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] >> 5) & 1;
+      }
+#else
+      __builtin_cpu_init();
+      const bool sse42 = __builtin_cpu_supports("sse4.2");
+      const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+      if (avx2) return simd_level::avx2;
+      if (sse42) return simd_level::sse42;
+#endif
+      return simd_level::scalar;
+    }
+
+    static FORCE_INLINE uint32_t* flatten(uint32_t* out, uint32_t base, uint64_t bits) {
+      while (bits) {
+        *out++ = base + trailing_zeroes(bits);
+        bits &= bits - 1;
+      }
+      return out;
+    }
+
+    // the last partial block is copied out and padded with whitespace so it classifies like a full one
+    static FORCE_INLINE const char* pad_tail(const char* json, size_t length, size_t offset, char* tail) {
+      memset(tail, ' ', block_size);
+      memcpy(tail, json + offset, length - offset);
+      return tail;
+    }
+
+    static FORCE_INLINE void classify_scalar(const char* block, block_masks& m) {
+      m.quote = m.backslash = m.op = m.whitespace = 0;
+      for (size_t i = 0; i < block_size; ++i) {
+        const uint64_t bit = 1ULL << i;
+        switch (block[i]) {
+          case '\"': m.quote |= bit; break;
+          case '\\': m.backslash |= bit; break;
+          case '{': case '}': case '[': case ']': case ':': case ',': m.op |= bit; break;
+          case ' ': case '\t': case '\n': case '\r': m.whitespace |= bit; break;
+          default: break;
+        }
+      }
+    }
+
+    static uint32_t* scan_scalar(structural_scanner& scanner, const char* json, size_t length, uint32_t* out) {
+      block_masks m;
+      size_t i = 0;
+      for (; i + block_size <= length; i += block_size) {
+        classify_scalar(json + i, m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      if (i < length) {
+        char tail[block_size];
+        classify_scalar(pad_tail(json, length, i, tail), m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      return out;
+    }
+
+#if TINYJSON_X86
+    // whitespace and operators are found with a shuffle on the low nibble, '[' and ']' are
+    // folded onto '{' and '}' by setting bit 5 before comparing
+    TARGET_ISA("sse4.2") static FORCE_INLINE void classify_sse42(const char* block, block_masks& m) {
+      const __m128i ws_table = _mm_setr_epi8(' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100);
+      const __m128i op_table = _mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+      m.quote = m.backslash = m.op = m.whitespace = 0;
+      for (int i = 0; i < 4; ++i) {
+        const __m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i * 16));
+        const int shift = i * 16;
+        m.quote |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('\"'))))) << shift;
+        m.backslash |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_set1_epi8('\\'))))) << shift;
+        m.whitespace |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(in, _mm_shuffle_epi8(ws_table, in))))) << shift;
+        m.op |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(
+          _mm_cmpeq_epi8(_mm_or_si128(in, _mm_set1_epi8(0x20)), _mm_shuffle_epi8(op_table, in))))) << shift;
+      }
+    }
+
+    TARGET_ISA("sse4.2") static uint32_t* scan_sse42(structural_scanner& scanner, const char* json, size_t length, uint32_t* out) {
+      block_masks m;
+      size_t i = 0;
+      for (; i + block_size <= length; i += block_size) {
+        classify_sse42(json + i, m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      if (i < length) {
+        char tail[block_size];
+        classify_sse42(pad_tail(json, length, i, tail), m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      return out;
+    }
+
+    TARGET_ISA("avx2") static FORCE_INLINE void classify_avx2(const char* block, block_masks& m) {
+      const __m256i ws_table = _mm256_setr_epi8(
+        ' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100,
+        ' ', 100, 100, 100, 17, 100, 113, 2, 100, '\t', '\n', 112, 100, '\r', 100, 100);
+      const __m256i op_table = _mm256_setr_epi8(
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0,
+        0, 0, 0, 0, 0, 0, 0, 0, 0, 0, ':', '{', ',', '}', 0, 0);
+      const __m256i lo = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block));
+      const __m256i hi = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + 32));
+      const __m256i quote = _mm256_set1_epi8('\"');
+      const __m256i backslash = _mm256_set1_epi8('\\');
+      const __m256i curly = _mm256_set1_epi8(0x20);
+      m.quote = combine(_mm256_cmpeq_epi8(lo, quote), _mm256_cmpeq_epi8(hi, quote));
+      m.backslash = combine(_mm256_cmpeq_epi8(lo, backslash), _mm256_cmpeq_epi8(hi, backslash));
+      m.whitespace = combine(_mm256_cmpeq_epi8(lo, _mm256_shuffle_epi8(ws_table, lo)),
+                             _mm256_cmpeq_epi8(hi, _mm256_shuffle_epi8(ws_table, hi)));
+      m.op = combine(_mm256_cmpeq_epi8(_mm256_or_si256(lo, curly), _mm256_shuffle_epi8(op_table, lo)),
+                     _mm256_cmpeq_epi8(_mm256_or_si256(hi, curly), _mm256_shuffle_epi8(op_table, hi)));
+    }
+
+    TARGET_ISA("avx2") static FORCE_INLINE uint64_t combine(__m256i lo, __m256i hi) {
+      return static_cast<uint32_t>(_mm256_movemask_epi8(lo)) | (static_cast<uint64_t>(static_cast<uint32_t>(_mm256_movemask_epi8(hi))) << 32);
+    }
+
+    TARGET_ISA("avx2") static uint32_t* scan_avx2(structural_scanner& scanner, const char* json, size_t length, uint32_t* out) {
+      block_masks m;
+      size_t i = 0;
+      for (; i + block_size <= length; i += block_size) {
+        classify_avx2(json + i, m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      if (i < length) {
+        char tail[block_size];
+        classify_avx2(pad_tail(json, length, i, tail), m);
+        out = flatten(out, static_cast<uint32_t>(i), scanner.next(m));
+      }
+      return out;
+    }
+#endif
+  };
+
+  // walks the structural index of a document, one token at a time. the index ends in sentinels
+  // at offset length, which read as a nul without touching the input, so it needs no terminator.
+  class structural_iterator {
+  public:
+    FORCE_INLINE structural_iterator(const char* json, size_t length, const uint32_t* index)
+      : json(json), length(length), index(index) {}
+
+    FORCE_INLINE char peek() const { return *index < length ? json[*index] : '\0'; }
+    FORCE_INLINE const char* position() const { return json + *index; }
+    // characters left from the current token to the end of the input
+    FORCE_INLINE size_t remaining() const { return length - *index; }
+    FORCE_INLINE void advance() { ++index; }
+    // the index entry of the current token, an iterator made from it resumes here
+    FORCE_INLINE const uint32_t* cursor() const { return index; }
+    FORCE_INLINE bool expect(token_type type) {
+      if (peek() == type) {
+        ++index;
+        return true;
+      }
+
+      return false;
+    }
+
+  private:
+    const char* json;
+    size_t length;
+    const uint32_t* index;
+  };
+
+  // the events json_parser::sax_parse reports, in document order. each one returns false to stop the
+  // parse. strings and keys arrive unescaped; copy is true when the text sits in a scratch buffer
+  // that is only valid during the call, otherwise it points into the input.
+  // every event is ignored here, derive and hide the ones you need.
+  struct json_handler {
+    FORCE_INLINE bool null() { return true; }
+    FORCE_INLINE bool boolean(bool) { return true; }
+    FORCE_INLINE bool number(const number_value&) { return true; }
+    FORCE_INLINE bool string(const char*, size_t, bool) { return true; }
+    FORCE_INLINE bool key(const char*, size_t, bool) { return true; }
+    FORCE_INLINE bool start_object() { return true; }
+    FORCE_INLINE bool end_object(size_t) { return true; }
+    FORCE_INLINE bool start_array() { return true; }
+    FORCE_INLINE bool end_array(size_t) { return true; }
+    // not an event: sax_parse calls it once before the first event with the length of the input and
+    // the number of tokens in it, so a handler can size its buffers. the push parser never calls it.
+    FORCE_INLINE bool size_hint(size_t, size_t) { return true; }
+  };
+
+  // bounds for parsing untrusted input, checked as the parse goes so it stops at the first value
+  // over a limit. depth counts the open objects and arrays, nodes every value including containers.
+  // only the parse is free of recursion: trees are still freed and serialized one call per level, so
+  // keep max_depth near the default when parsing into a node or a document. far deeper limits are
+  // for sax handlers.
+  struct parse_limits {
+    static const size_t default_max_depth = 1024;
+
+    explicit parse_limits(size_t max_depth = default_max_depth, size_t max_length = std::numeric_limits<size_t>::max(),
+                          size_t max_nodes = std::numeric_limits<size_t>::max())
+      : max_depth(max_depth), max_length(max_length), max_nodes(max_nodes) {}
+
+    size_t max_depth;
+    size_t max_length;
+    size_t max_nodes;
+  };
+
+  // what stopped a parse
+  enum class json_error : uint8_t {
+    none,
+    too_large,
+    unclosed_string,
+    empty,                  // no object or array at the root
+    invalid_token,
+    invalid_escape,
+    invalid_value,          // not a number, string or literal
+    invalid_end_of_object,
+    invalid_end_of_array,
+    too_deep,
+    too_many_nodes,
+    cancelled               // the handler returned false
+  };
+
+  // the text the std::string overloads report
+  inline const char* error_message(json_error error) {
+    switch (error) {
+      case json_error::none: return "";
+      case json_error::too_large: return "json too large.";
+      case json_error::unclosed_string: return "unclosed string.";
+      case json_error::empty: return "invalid or empty json.";
+      case json_error::invalid_token: return "invalid token.";
+      case json_error::invalid_escape: return "invalid escape.";
+      case json_error::invalid_value: return "parse error.";
+      case json_error::invalid_end_of_object: return "invalid end of object.";
+      case json_error::invalid_end_of_array: return "invalid end of array.";
+      case json_error::too_deep: return "json too deep.";
+      case json_error::too_many_nodes: return "too many nodes.";
+      case json_error::cancelled: return "parse cancelled.";
+    }
+    return "";
+  }
+
+  // why a parse stopped and the byte offset in the input where it did. a failed parse only fills in
+  // the code and the offset; line and column are counted from the input when they are asked for, so
+  // the input has to be still around by then.
+  struct parse_error {
+    parse_error() : code(json_error::none), offset(0), input(nullptr) {}
+
+    FORCE_INLINE explicit operator bool() const { return code != json_error::none; }
+    FORCE_INLINE const char* message() const { return error_message(code); }
+    // 1 based, 0 when there is no error
+    size_t line() const {
+      if (!input) return 0;
+      size_t lines = 1;
+      for (const char* p = input, *end = input + offset; (p = static_cast<const char*>(memchr(p, '\n', end - p))); ++p) ++lines;
+      return lines;
+    }
+    // 1 based and counted in bytes, 0 when there is no error
+    size_t column() const {
+      if (!input) return 0;
+      const char* p = input + offset;
+      while (p != input && p[-1] != '\n') --p;
+      return input + offset - p + 1;
+    }
+    // "line 3, column 14: invalid token." for logs
+    std::string to_string() const {
+      return "line " + std::to_string(line()) + ", column " + std::to_string(column()) + ": " + message();
+    }
+
+    json_error code;
+    size_t offset;
+    const char* input;
+  };
+
+  // the handler behind json_parser::parse, it grows a node tree out of the events.
+  // containers are attached before they are filled, so a parse that stops half way leaks nothing.
+  template <typename Node>
+  class dom_builder : public json_handler {
+    typedef typename Node::string string_type;
+    typedef string_traits<string_type> traits;
+  public:
+    // with a key_table, keys are interned there rather than copied into the tree
+    explicit dom_builder(Node& root, key_table* keys = nullptr)
+      : root(root), open(nullptr), open_is_array(false), pending_key(traits::empty(root.alloc)), pending_symbol(nullptr), keys(keys) {}
+
+    FORCE_INLINE bool null() {
+      TINYJSON_STAT(++json_stats::local().null_nodes);
+      slot();
+      return true;
+    }
+    FORCE_INLINE bool boolean(bool val) {
+      TINYJSON_STAT(++json_stats::local().boolean_nodes);
+      slot()->set(val);
+      return true;
+    }
+    FORCE_INLINE bool number(const number_value& val) {
+      TINYJSON_STAT(++json_stats::local().number_nodes);
+      slot()->set(val);
+      return true;
+    }
+    FORCE_INLINE bool string(const char* str, size_t length, bool copy) {
+      TINYJSON_STAT(++json_stats::local().string_nodes);
+      Node* node = slot();
+      string_type* val = node->template create<string_type>(traits::empty(node->alloc));
+      node->set(val);
+      traits::assign(*val, str, length, copy, node->alloc);
+      return true;
+    }
+    FORCE_INLINE bool key(const char* str, size_t length, bool copy) {
+      if (keys && (pending_symbol = keys->intern(str, length))) {
+        traits::assign(pending_key, pending_symbol->str, length, false, open->alloc);
+      } else {
+        traits::assign(pending_key, str, length, copy, open->alloc);
+      }
+      return true;
+    }
+    FORCE_INLINE bool start_object() {
+      TINYJSON_STAT(++json_stats::local().object_nodes);
+      Node* node = slot();
+      node->set(node->template create<typename Node::object>(node->alloc));
+      push(node, false);
+      return true;
+    }
+    FORCE_INLINE bool end_object(size_t) {
+      pop();
+      return true;
+    }
+    FORCE_INLINE bool start_array() {
+      TINYJSON_STAT(++json_stats::local().array_nodes);
+      Node* node = slot();
+      node->set(node->template create<typename Node::array>(node->alloc));
+      push(node, true);
+      return true;
+    }
+    FORCE_INLINE bool end_array(size_t) {
+      pop();
+      return true;
+    }
+
+  private:
+    // the node the next value goes into: the root first, then a new member or element of the open container
+    FORCE_INLINE Node* slot() {
+      if (!open) return &root;
+      Node* node = open->create_node();
+      if (open_is_array) {
+        open->storage.array_val->emplace_back(node);
+      } else if (pending_symbol) {
+        open->storage.object_val->insert(std::make_pair(std::move(pending_key), node), pending_symbol->hash);
+      } else {
+        open->storage.object_val->insert(std::make_pair(std::move(pending_key), node));
+      }
+      return node;
+    }
+    // only the enclosing containers go on the stack, the innermost one is kept at hand
+    FORCE_INLINE void push(Node* node, bool is_array) {
+      if (open) stack.push_back(open);
+      open = node;
+      open_is_array = is_array;
+    }
+    FORCE_INLINE void pop() {
+      if (stack.empty()) {
+        open = nullptr;
+        return;
+      }
+      open = stack.back();
+      open_is_array = open->type == node_type::array_type;
+      stack.pop_back();
+    }
+    Node& root;
+    Node* open;
+    bool open_is_array;
+    string_type pending_key;
+    const key_table::symbol* pending_symbol;
+    key_table* keys;
+    std::vector<Node*> stack;
+  };
+
+  template <typename String>
+  class basic_json_document;
+  class lazy_document;
+  class lazy_view;
+  class json_path;
+  class json_reader;
+  class parallel_parser;
+
+  class json_parser {
+    friend class lazy_document;
+    friend class lazy_view;
+    friend class json_path;
+    friend class json_reader;
+    friend class parallel_parser;
+  public:
+    template <typename Alloc, typename String>
+    FORCE_INLINE static bool parse(basic_json_node<Alloc, String>& value, const std::string& json, std::string& err) {
+      return parse(value, json.data(), json.size(), err);
+    }
+    // the buffer does not need to be nul terminated
+    template <typename Alloc, typename String>
+    FORCE_INLINE static bool parse(basic_json_node<Alloc, String>& value, const char* json, size_t length, std::string& err) {
+      return parse(value, json, length, nullptr, err);
+    }
+    // interns the keys of objects in keys, when it is not null
+    template <typename Alloc, typename String>
+    FORCE_INLINE static bool parse(basic_json_node<Alloc, String>& value, const char* json, size_t length, key_table* keys, std::string& err) {
+      parse_error error;
+      if (!parse(value, json, length, keys, parse_limits(), error)) return make_err_msg(error.code, err);
+      err.clear();
+      return true;
+    }
+    // error gets a code and an offset instead of a message, nothing is formatted on the way
+    template <typename Alloc, typename String>
+    FORCE_INLINE static bool parse(basic_json_node<Alloc, String>& value, const char* json, size_t length, parse_error& error) {
+      return parse(value, json, length, nullptr, parse_limits(), error);
+    }
+    // stops at the first value over limits
+    template <typename Alloc, typename String>
+    FORCE_INLINE static bool parse(basic_json_node<Alloc, String>& value, const char* json, size_t length, const parse_limits& limits,
+                                   parse_error& error) {
+      return parse(value, json, length, nullptr, limits, error);
+    }
+    template <typename String>
+    static bool parse(basic_json_document<String>& doc, const std::string& json, std::string& err);
+    template <typename String>
+    static bool parse(basic_json_document<String>& doc, const char* json, size_t length, std::string& err);
+    template <typename String>
+    static bool parse(basic_json_document<String>& doc, const char* json, size_t length, parse_error& error);
+    template <typename String>
+    static bool parse(basic_json_document<String>& doc, const char* json, size_t length, const parse_limits& limits, parse_error& error);
+
+    // maps the file and parses it, into a node or a json_document. a view document would keep
+    // pointing into the mapping, for those open a mapped_file and keep it around instead.
+    template <typename Value>
+    static bool parse_file(Value& value, const std::string& path, std::string& err) {
+      static_assert(!std::is_same<typename Value::string, string_view>::value,
+                    "a view points into the file, parse a mapped_file that outlives it");
+      mapped_file file;
+      if (!file.open(path, err)) return false;
+      return parse(value, file.data(), file.size(), err);
+    }
+
+    // reports the document to handler event by event without building anything, see json_handler
+    template <typename Handler>
+    FORCE_INLINE static bool sax_parse(Handler& handler, const std::string& json, std::string& err) {
+      return sax_parse(handler, json.data(), json.size(), err);
+    }
+    template <typename Handler>
+    FORCE_INLINE static bool sax_parse(Handler& handler, const char* json, size_t length, std::string& err) {
+      parse_error error;
+      if (!sax_parse(handler, json, length, parse_limits(), error)) return make_err_msg(error.code, err);
+      err.clear();
+      return true;
+    }
+    template <typename Handler>
+    FORCE_INLINE static bool sax_parse(Handler& handler, const char* json, size_t length, parse_error& error) {
+      return sax_parse(handler, json, length, parse_limits(), error);
+    }
+    template <typename Handler>
+    static bool sax_parse(Handler& handler, const char* json, size_t length, const parse_limits& limits, parse_error& error) {
+      error = parse_error();
+
+      // offsets are 32 bit
+      if (length >= std::numeric_limits<uint32_t>::max() || length > limits.max_length) {
+        return failed(json, std::min(length, limits.max_length), json_error::too_large, error);
+      }
+      index_buffer index(length);
+      size_t count = 0;
+      if (!structural_index::scan(json, length, index.data, count)) {
+        // at the opening quote of the last string
+        return failed(json, count ? index.data[count - 1] : 0, json_error::unclosed_string, error);
+      }
+      index.data[count] = index.data[count + 1] = static_cast<uint32_t>(length);
+      if (!handler.size_hint(length, count)) {
+        return failed(json, 0, json_error::cancelled, error);
+      }
+      structural_iterator token(json, length, index.data);
+      scratch_buffer scratch;
+
+      // RFC 4627: only objects or arrays were allowed as root
+      const char* at = token.position();
+      json_error code = json_error::empty;
+      if ((token.peek() == token_type::start_object || token.peek() == token_type::start_array)
+        && parse_element(handler, token, scratch, limits, code, at)) {
+        return true;
+      }
+      return failed(json, std::min(static_cast<size_t>(at - json), length), code, error);
+    }
+
+    // the counters of the parses on this thread, zero unless TINYJSON_STATS is 1
+    FORCE_INLINE static const json_stats& stats() { return json_stats::local(); }
+    FORCE_INLINE static void reset_stats() { json_stats::local().reset(); }
+
+    // reads the document straight into value through its json_binding, no tree is built
+    template <typename T>
+    FORCE_INLINE static bool decode(T& value, const std::string& json, std::string& err) {
+      return decode(value, json.data(), json.size(), err);
+    }
+    template <typename T>
+    static bool decode(T& value, const char* json, size_t length, std::string& err);
+
+  private:
+    template <typename Alloc, typename String>
+    static bool parse(basic_json_node<Alloc, String>& value, const char* json, size_t length, key_table* keys,
+                      const parse_limits& limits, parse_error& error) {
+      value.clear();
+      dom_builder<basic_json_node<Alloc, String>> builder(value, keys);
+      return sax_parse(builder, json, length, limits, error);
+    }
+
+    // scratch space for the structural index, with room for two sentinels. small indices reuse a
+    // per thread buffer, big ones are given back once the parse is done. a parse started while
+    // another one on the same thread holds the buffer, from a handler or a binding, gets its own.
+    struct index_buffer {
+      static const size_t max_cached = 1 << 20;
+
+      explicit index_buffer(size_t length) : data(nullptr), owned(), busy(nullptr) {
+        const size_t size = length + 2;
+        thread_local std::unique_ptr<uint32_t[]> cached;
+        thread_local size_t capacity = 0;
+        thread_local bool in_use = false;
+        if (size > max_cached || in_use) {
+          owned.reset(new uint32_t[size]);
+          data = owned.get();
+          return;
+        }
+        if (capacity < size) {
+          capacity = std::max(size, static_cast<size_t>(1024));
+          cached.reset(new uint32_t[capacity]);
+        }
+        data = cached.get();
+        busy = &in_use;
+        in_use = true;
+      }
+      index_buffer(const index_buffer&) = delete;
+      index_buffer& operator=(const index_buffer&) = delete;
+      ~index_buffer() {
+        if (busy) *busy = false;
+      }
+
+      uint32_t* data;
+      std::unique_ptr<uint32_t[]> owned;
+      bool* busy;
+    };
+    // where strings with escapes are decoded before they are handed out, only ever grows
+    struct scratch_buffer {
+      FORCE_INLINE char* reserve(size_t length) {
+        if (chars.size() < length) chars.resize(length);
+        return chars.data();
+      }
+
+      std::vector<char> chars;
+    };
+    FORCE_INLINE static bool make_err_msg(const char* msg, std::string& err) {
+      err.assign(msg);
+      return false;
+    }
+    FORCE_INLINE static bool make_err_msg(json_error code, std::string& err) {
+      return make_err_msg(error_message(code), err);
+    }
+    FORCE_INLINE static bool cancelled(std::string& err) {
+      return make_err_msg(json_error::cancelled, err);
+    }
+    FORCE_INLINE static bool fail(json_error code, json_error& error) {
+      error = code;
+      return false;
+    }
+    static bool failed(const char* json, size_t offset, json_error code, parse_error& error) {
+      error.code = code;
+      error.offset = offset;
+      error.input = json;
+      return false;
+    }
+    FORCE_INLINE static bool is_space(const char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+    // a literal has to end where its scalar does, "truex" is not true
+    FORCE_INLINE static bool match_literal(const structural_iterator& token, const char* literal, size_t length) {
+      const size_t remaining = token.remaining();
+      if (remaining < length || 0 != memcmp(token.position(), literal, length)) return false;
+      if (remaining == length) return true;
+      const char c = token.position()[length];
+      return is_space(c) || c == token_type::double_quote || c == token_type::comma || c == token_type::colon
+        || c == token_type::end_object || c == token_type::end_array || c == token_type::start_object || c == token_type::start_array;
+    }
+    FORCE_INLINE static bool parse_number(number_value* number, structural_iterator& token) {
+      TINYJSON_STAT(stats_timer timer(json_stats::local().number_ns));
+      const char* begin = token.position();
+      token.advance();
+      // a scalar runs up to the next token, minus the whitespace in between
+      const char* end = token.position();
+      while (end != begin && is_space(end[-1])) --end;
+      return end != begin && read_number(begin, end, number);
+    }
+    // false for a malformed escape sequence. strings without escapes are handed out as they are
+    // in the input, the others are decoded into scratch.
+    FORCE_INLINE static bool parse_string(structural_iterator& token, scratch_buffer& scratch, const char*& str, size_t& length, bool& copy) {
+      TINYJSON_STAT(stats_timer timer(json_stats::local().string_ns));
+      // both quotes are in the index, the next token is always the closing one
+      const char* begin = token.position() + 1;
+      token.advance();
+      const char* end = token.position();
+      token.advance();
+      if (!memchr(begin, '\\', end - begin)) {
+        str = begin;
+        length = end - begin;
+        copy = false;
+        return true;
+      }
+      char* out = scratch.reserve(end - begin);
+      char* out_end = unescape(begin, end, out);
+      if (!out_end) return false;
+      str = out;
+      length = out_end - out;
+      copy = true;
+      return true;
+    }
+    template <typename Handler>
+    FORCE_INLINE static bool parse_value(Handler& handler, structural_iterator& token, scratch_buffer& scratch, json_error& error) {
+      const char current = token.peek();
+      bool ok;
+      if (current == token_type::double_quote) {
+        // string, empty ones are allowed
+        const char* str;
+        size_t length;
+        bool copy;
+        if (!parse_string(token, scratch, str, length, copy)) {
+          return fail(json_error::invalid_escape, error);
+        }
+        ok = handler.string(str, length, copy);
+      } else if ((current == 't') && match_literal(token, "true", 4)) {
+        token.advance();
+        ok = handler.boolean(true);
+      } else if ((current == 'f') && match_literal(token, "false", 5)) {
+        token.advance();
+        ok = handler.boolean(false);
+      } else if ((current == 'n') && match_literal(token, "null", 4)) {
+        token.advance();
+        ok = handler.null();
+      } else {
+        number_value number;
+        if (!parse_number(&number, token)) {
+          return fail(json_error::invalid_value, error);
+        }
+        ok = handler.number(number);
+      }
+
+      return ok || fail(json_error::cancelled, error);
+    }
+    template <typename Handler>
+    FORCE_INLINE static bool parse_value(Handler& handler, structural_iterator& token, scratch_buffer& scratch, std::string& err) {
+      json_error error;
+      return parse_value(handler, token, scratch, error) || make_err_msg(error, err);
+    }
+    template <typename Handler>
+    FORCE_INLINE static bool parse_element(Handler& handler, structural_iterator& token, scratch_buffer& scratch, std::string& err) {
+      json_error error;
+      const char* at;
+      return parse_element(handler, token, scratch, parse_limits(), error, at) || make_err_msg(error, err);
+    }
+    // the objects and arrays a parse is inside of, with their element counts so far. the first levels
+    // are kept inline, deeper documents move the stack to the heap, never past the depth limit.
+    class frame_stack {
+    public:
+      struct frame {
+        uint32_t count;
+        bool object;
+      };
+
+      explicit frame_stack(size_t max_depth)
+        : frames(inline_frames), size(0), capacity(max_depth < inline_depth ? max_depth : inline_depth), max_depth(max_depth) {}
+
+      FORCE_INLINE bool empty() const { return size == 0; }
+      FORCE_INLINE size_t depth() const { return size; }
+      FORCE_INLINE const frame& top() const { return frames[size - 1]; }
+      FORCE_INLINE void pop() { --size; }
+      // false past the depth limit
+      FORCE_INLINE bool push(uint32_t count, bool object) {
+        if (size == capacity && !grow()) return false;
+        frames[size].count = count;
+        frames[size].object = object;
+        ++size;
+        return true;
+      }
+
+    private:
+      static const size_t inline_depth = 64;
+
+      bool grow() {
+        if (size >= max_depth) return false;
+        capacity = std::min(std::max(capacity * 4, static_cast<size_t>(1024)), max_depth);
+        frame* bigger = new frame[capacity];
+        memcpy(bigger, frames, size * sizeof(frame));
+        heap.reset(bigger);
+        frames = bigger;
+        return true;
+      }
+
+      frame inline_frames[inline_depth];
+      std::unique_ptr<frame[]> heap;
+      frame* frames;
+      size_t size;
+      size_t capacity;
+      size_t max_depth;
+    };
+    // parses one value, containers and all, in a single loop. nesting lives on a frame_stack instead
+    // of the call stack, so hostile depth is an error rather than a crash. the container being filled
+    // is kept in count and object, the stack only holds the ones around it. at is left on the token
+    // the parse stopped at.
+    template <typename Handler>
+    static bool parse_element(Handler& handler, structural_iterator& token, scratch_buffer& scratch, const parse_limits& limits,
+                              json_error& error, const char*& at) {
+      frame_stack stack(limits.max_depth);
+      uint32_t count = 0;
+      bool object = false;
+      // counts down, stops the parse when it reaches zero
+      size_t nodes_left = limits.max_nodes;
+      const char* here;
+
+    value:
+      here = token.position();
+      if (nodes_left-- == 0) {
+        at = here;
+        return fail(json_error::too_many_nodes, error);
+      }
+      if (token.peek() == token_type::start_object) {
+        if (!stack.push(count, object)) {
+          at = here;
+          return fail(json_error::too_deep, error);
+        }
+        TINYJSON_STAT(json_stats::reached(stack.depth()));
+        count = 0;
+        object = true;
+        token.advance();
+        if (!handler.start_object()) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+        if (!token.expect(token_type::end_object)) goto key;
+        // empty object
+        if (!handler.end_object(0)) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+        goto close;
+      }
+      if (token.peek() == token_type::start_array) {
+        if (!stack.push(count, object)) {
+          at = here;
+          return fail(json_error::too_deep, error);
+        }
+        TINYJSON_STAT(json_stats::reached(stack.depth()));
+        count = 0;
+        object = false;
+        token.advance();
+        if (!handler.start_array()) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+        if (!token.expect(token_type::end_array)) goto value;
+        // empty array
+        if (!handler.end_array(0)) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+        goto close;
+      }
+      if (!parse_value(handler, token, scratch, error)) {
+        at = here;
+        return false;
+      }
+
+    next:
+      // a value is complete, go on with the container around it
+      if (stack.empty()) return true;
+      ++count;
+      here = token.position();
+      if (token.expect(token_type::comma)) {
+        if (object) goto key;
+        goto value;
+      }
+      if (object) {
+        if (!token.expect(token_type::end_object)) {
+          at = here;
+          return fail(json_error::invalid_end_of_object, error);
+        }
+        if (!handler.end_object(count)) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+      } else {
+        if (!token.expect(token_type::end_array)) {
+          at = here;
+          return fail(json_error::invalid_end_of_array, error);
+        }
+        if (!handler.end_array(count)) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+      }
+
+    close:
+      // back to the container around the one that just ended
+      count = stack.top().count;
+      object = stack.top().object;
+      stack.pop();
+      goto next;
+
+    key:
+      here = token.position();
+      {
+        const char* key;
+        size_t length;
+        bool copy;
+        if (token.peek() != token_type::double_quote || !parse_string(token, scratch, key, length, copy) || length == 0) {
+          at = here;
+          return fail(json_error::invalid_token, error);
+        }
+        if (!token.expect(token_type::colon)) {
+          at = token.position();
+          return fail(json_error::invalid_token, error);
+        }
+        if (!handler.key(key, length, copy)) {
+          at = here;
+          return fail(json_error::cancelled, error);
+        }
+      }
+      goto value;
+    }
+  };
+
+  // push parser for input that arrives in pieces. every chunk is parsed as far as it goes and the
+  // handler sees each value as soon as it is complete; a string or number cut off at the end of a chunk
+  // is carried over to the next one. the chunks do not have to outlive feed(), so strings and keys
+  // are always reported with copy set. a dom_builder as the handler grows a tree. the limits bound
+  // the depth and the number of values of a document, and how much of it is fed all together.
+  template <typename Handler>
+  class json_push_parser {
+  public:
+    explicit json_push_parser(Handler& handler, const parse_limits& limits = parse_limits()) : handler(handler), limits(limits) {
+      reset();
+    }
+
+    // false once the input is known to be malformed, the parser stays failed until reset()
+    bool feed(const char* chunk, size_t length, std::string& err) {
+      if (error != json_error::none) return fail(error, err);
+      if (length > limits.max_length - fed) {
+        error = json_error::too_large;
+        return fail(error, err);
+      }
+      fed += length;
+
+      const char* p = chunk;
+      const char* end = chunk + length;
+      while (p != end) {
+        switch (current) {
+          case state::string:
+          case state::key_string:
+            p = scan_string(p, end);
+            break;
+          case state::done:
+          case state::trailing_string:
+            p = scan_trailing(p, end);
+            break;
+          case state::scalar:
+            p = scan_scalar(p, end);
+            break;
+          default:
+            p = scan_structural(p, end);
+            break;
+        }
+        if (error != json_error::none) return fail(error, err);
+      }
+
+      err.clear();
+      return true;
+    }
+    FORCE_INLINE bool feed(const std::string& chunk, std::string& err) {
+      return feed(chunk.data(), chunk.size(), err);
+    }
+
+    // the end of the input, true when a whole document was seen
+    bool finish(std::string& err) {
+      if (error != json_error::none) return fail(error, err);
+      if (current == state::scalar) {
+        // nothing follows the last scalar, whatever came so far is all of it
+        if (!emit_scalar(pending.data(), pending.size())) return fail(error, err);
+      }
+      if (current == state::done) {
+        err.clear();
+        return true;
+      }
+      if (current == state::string || current == state::key_string || current == state::trailing_string) {
+        return fail(json_error::unclosed_string, err);
+      }
+      return fail(unexpected(), err);
+    }
+
+    // ready for a new document
+    void reset() {
+      current = state::root;
+      error = json_error::none;
+      fed = 0;
+      nodes_left = limits.max_nodes;
+      escaped = false;
+      has_escape = false;
+      pending.clear();
+      stack.clear();
+    }
+
+    // the root value is closed, whatever is fed after it is ignored but for an unclosed string
+    FORCE_INLINE bool done() const { return current == state::done || current == state::trailing_string; }
+    FORCE_INLINE size_t depth() const { return stack.size(); }
+    // what stopped the parse, json_error::none while it goes on
+    FORCE_INLINE json_error code() const { return error; }
+
+  private:
+    enum class state : uint8_t {
+      root,          // nothing seen yet
+      value,         // after ':' or a ',' in an array
+      array_first,   // after '['
+      object_first,  // after '{'
+      key,           // after a ',' in an object
+      colon,         // after a key
+      after_value,   // after a member or element
+      string,        // inside a string value
+      key_string,    // inside a key
+      scalar,        // inside a number or literal
+      done,          // after the root value
+      trailing_string  // inside a string after the root value
+    };
+
+    struct container {
+      bool is_object;
+      size_t count;
+    };
+
+    FORCE_INLINE static bool fail(json_error code, std::string& err) {
+      err = error_message(code);
+      return false;
+    }
+    FORCE_INLINE static bool is_space(const char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+    FORCE_INLINE static bool ends_scalar(const char c) {
+      return is_space(c) || c == token_type::double_quote || c == token_type::comma || c == token_type::colon
+        || c == token_type::end_object || c == token_type::end_array || c == token_type::start_object || c == token_type::start_array;
+    }
+    // what the parser over the whole input reports for a token it did not expect here
+    json_error unexpected() const {
+      switch (current) {
+        case state::root:
+          return json_error::empty;
+        case state::object_first:
+        case state::key:
+        case state::colon:
+          return json_error::invalid_token;
+        case state::after_value:
+          return stack.back().is_object ? json_error::invalid_end_of_object : json_error::invalid_end_of_array;
+        default:
+          return json_error::invalid_value;
+      }
+    }
+    FORCE_INLINE bool check(bool ok) {
+      if (!ok) error = json_error::cancelled;
+      return ok;
+    }
+    // every value counts, containers included
+    FORCE_INLINE bool count_node() {
+      if (nodes_left-- != 0) return true;
+      error = json_error::too_many_nodes;
+      return false;
+    }
+
+    // a value is complete, the container it is in decides what comes next
+    FORCE_INLINE void value_done() {
+      if (stack.empty()) {
+        current = state::done;
+        return;
+      }
+      ++stack.back().count;
+      current = state::after_value;
+    }
+    FORCE_INLINE void open(bool is_object) {
+      if (stack.size() >= limits.max_depth) {
+        error = json_error::too_deep;
+        return;
+      }
+      if (!check(is_object ? handler.start_object() : handler.start_array())) return;
+      container c = { is_object, 0 };
+      stack.push_back(c);
+      current = is_object ? state::object_first : state::array_first;
+    }
+    FORCE_INLINE void close() {
+      const container c = stack.back();
+      stack.pop_back();
+      if (!check(c.is_object ? handler.end_object(c.count) : handler.end_array(c.count))) return;
+      value_done();
+    }
+
+    const char* scan_structural(const char* p, const char* end) {
+      while (p != end && is_space(*p)) ++p;
+      if (p == end) return p;
+
+      const char c = *p;
+      switch (current) {
+        case state::root:
+          if (c != token_type::start_object && c != token_type::start_array) error = unexpected();
+          else if (count_node()) open(c == token_type::start_object);
+          return p + 1;
+        case state::array_first:
+          if (c == token_type::end_array) {
+            close();
+            return p + 1;
+          }
+          return begin_value(p);
+        case state::value:
+          return begin_value(p);
+        case state::object_first:
+          if (c == token_type::end_object) {
+            close();
+            return p + 1;
+          }
+          // fall through
+        case state::key:
+          if (c == token_type::double_quote) begin_string(state::key_string);
+          else error = unexpected();
+          return p + 1;
+        case state::colon:
+          if (c == token_type::colon) current = state::value;
+          else error = unexpected();
+          return p + 1;
+        case state::after_value: {
+          const bool is_object = stack.back().is_object;
+          if (c == token_type::comma) current = is_object ? state::key : state::value;
+          else if (c == (is_object ? '}' : ']')) close();
+          else error = unexpected();
+          return p + 1;
+        }
+        default:
+          return p;
+      }
+    }
+
+    FORCE_INLINE const char* begin_value(const char* p) {
+      if (!count_node()) return p + 1;
+      switch (*p) {
+        case '{':
+          open(true);
+          return p + 1;
+        case '[':
+          open(false);
+          return p + 1;
+        case '\"':
+          begin_string(state::string);
+          return p + 1;
+        case ',': case ':': case ']': case '}':
+          error = unexpected();
+          return p + 1;
+        default:
+          current = state::scalar;
+          pending.clear();
+          return p;
+      }
+    }
+
+    // text after the root is not parsed, but a string opened in it has to be closed, as it has for
+    // the parser over the whole input. its first stage sees every quote that is not escaped, in a
+    // string or not.
+    const char* scan_trailing(const char* p, const char* end) {
+      if (escaped) {
+        escaped = false;
+        ++p;
+      }
+      while (p != end) {
+        const char c = *p++;
+        if (c == '\\') {
+          if (p == end) {
+            escaped = true;
+            break;
+          }
+          ++p;
+        } else if (c == '\"') {
+          current = current == state::done ? state::trailing_string : state::done;
+        }
+      }
+      return p;
+    }
+
+    FORCE_INLINE void begin_string(state s) {
+      current = s;
+      pending.clear();
+      escaped = false;
+      has_escape = false;
+    }
+
+    // looks for the closing quote. the part of the string in this chunk is kept when there is none.
+    const char* scan_string(const char* p, const char* end) {
+      const char* begin = p;
+      if (escaped) {
+        // the chunk starts with an escaped character
+        escaped = false;
+        ++p;
+      }
+      while (p != end) {
+        const char* quote = static_cast<const char*>(memchr(p, '\"', end - p));
+        const char* slash = static_cast<const char*>(memchr(p, '\\', (quote ? quote : end) - p));
+        if (slash) {
+          has_escape = true;
+          if (slash + 1 == end) {
+            escaped = true;
+            p = end;
+            break;
+          }
+          p = slash + 2;
+          continue;
+        }
+        if (!quote) {
+          p = end;
+          break;
+        }
+
+        if (pending.empty()) {
+          emit_string(begin, quote - begin);
+        } else {
+          pending.append(begin, quote);
+          emit_string(pending.data(), pending.size());
+        }
+        return quote + 1;
+      }
+      pending.append(begin, end);
+      return end;
+    }
+
+    void emit_string(const char* str, size_t length) {
+      if (has_escape) {
+        if (scratch.size() < length) scratch.resize(length);
+        char* out_end = unescape(str, str + length, &scratch[0]);
+        if (!out_end) {
+          error = current == state::key_string ? json_error::invalid_token : json_error::invalid_escape;
+          return;
+        }
+        str = scratch.data();
+        length = out_end - str;
+      }
+
+      if (current == state::key_string) {
+        if (length == 0) {
+          error = json_error::invalid_token;
+          return;
+        }
+        if (check(handler.key(str, length, true))) current = state::colon;
+        return;
+      }
+      if (check(handler.string(str, length, true))) value_done();
+    }
+
+    // a number or literal runs up to whitespace or the next structural character
+    const char* scan_scalar(const char* p, const char* end) {
+      const char* q = p;
+      while (q != end && !ends_scalar(*q)) ++q;
+      if (q == end) {
+        pending.append(p, q);
+        return end;
+      }
+      if (pending.empty()) {
+        emit_scalar(p, q - p);
+      } else {
+        pending.append(p, q);
+        emit_scalar(pending.data(), pending.size());
+      }
+      return q;
+    }
+
+    bool emit_scalar(const char* s, size_t length) {
+      bool ok;
+      if (length == 4 && memcmp(s, "true", 4) == 0) {
+        ok = handler.boolean(true);
+      } else if (length == 5 && memcmp(s, "false", 5) == 0) {
+        ok = handler.boolean(false);
+      } else if (length == 4 && memcmp(s, "null", 4) == 0) {
+        ok = handler.null();
+      } else {
+        number_value number;
+        if (!read_number(s, s + length, &number)) {
+          error = json_error::invalid_value;
+          return false;
+        }
+        ok = handler.number(number);
+      }
+      if (!check(ok)) return false;
+      value_done();
+      return true;
+    }
+
+    Handler& handler;
+    const parse_limits limits;
+    state current;
+    json_error error;
+    size_t fed;         // bytes of this document so far
+    size_t nodes_left;
+    bool escaped;       // the last chunk ended in the middle of an escape
+    bool has_escape;    // the current string needs decoding
+    std::string pending;
+    std::string scratch;
+    std::vector<container> stack;
+  };
+
+  // a json tree whose nodes, strings, arrays and objects are all drawn from one memory_arena.
+  // nothing is freed node by node: reparsing or destroying the document gives the arena back at once.
+  template <typename String>
+  class basic_json_document : public basic_json_node<arena_allocator<char>, String> {
+    typedef basic_json_node<arena_allocator<char>, String> node_base;
+  public:
+    // the arena member is only constructed after the base, which just keeps its address
+    // chunks of the arena come from upstream when one is given, the global heap otherwise
+    explicit basic_json_document(size_t chunk_size = memory_arena::default_chunk_size, memory_resource* upstream = nullptr)
+      : node_base(arena_allocator<char>(&arena)), arena(chunk_size, upstream), keys(nullptr) {}
+    basic_json_document(const basic_json_document&) = delete;
+    basic_json_document& operator=(const basic_json_document&) = delete;
+    ~basic_json_document() {
+      reset();
+    }
+
+    FORCE_INLINE bool parse(const std::string& json, std::string& err) {
+      return json_parser::parse(*this, json, err);
+    }
+    FORCE_INLINE bool parse(const char* json, size_t length, std::string& err) {
+      return json_parser::parse(*this, json, length, err);
+    }
+    FORCE_INLINE bool parse(const char* json, size_t length, parse_error& error) {
+      return json_parser::parse(*this, json, length, error);
+    }
+    // a view document keeps pointing into what it parsed, a temporary would be gone right away
+    template <typename S = String>
+    FORCE_INLINE bool parse(std::string&& json, std::string& err) {
+      static_assert(!std::is_same<S, string_view>::value, "json_view_document can not parse a temporary string");
+      return json_parser::parse(*this, json, err);
+    }
+
+    // drops the tree and rewinds the arena, keeping its largest chunk for the next parse
+    FORCE_INLINE void reset() {
+      this->clear();
+      arena.reset();
+    }
+
+    FORCE_INLINE memory_arena& get_arena() { return arena; }
+    // keys of the following parses are interned in table, which may be shared with other
+    // documents. nullptr goes back to keeping them per document.
+    FORCE_INLINE void set_key_table(key_table* table) { keys = table; }
+
+    using node_base::operator=;
+
+  private:
+    friend class json_parser;
+    memory_arena arena;
+    key_table* keys;
+  };
+
+  typedef basic_json_document<document_node::string> json_document;
+  // parses in place: strings and keys point into the caller's buffer, which has to outlive the document.
+  // only strings with escape sequences are decoded, into the arena.
+  typedef basic_json_document<string_view> json_view_document;
+
+  template <typename String>
+  FORCE_INLINE bool json_parser::parse(basic_json_document<String>& doc, const std::string& json, std::string& err) {
+    return parse(doc, json.data(), json.size(), err);
+  }
+
+  template <typename String>
+  FORCE_INLINE bool json_parser::parse(basic_json_document<String>& doc, const char* json, size_t length, std::string& err) {
+    doc.reset();
+    return parse(static_cast<basic_json_node<arena_allocator<char>, String>&>(doc), json, length, doc.keys, err);
+  }
+
+  template <typename String>
+  FORCE_INLINE bool json_parser::parse(basic_json_document<String>& doc, const char* json, size_t length, parse_error& error) {
+    return parse(doc, json, length, parse_limits(), error);
+  }
+
+  template <typename String>
+  FORCE_INLINE bool json_parser::parse(basic_json_document<String>& doc, const char* json, size_t length, const parse_limits& limits,
+                                       parse_error& error) {
+    doc.reset();
+    return parse(static_cast<basic_json_node<arena_allocator<char>, String>&>(doc), json, length, doc.keys, limits, error);
+  }
+
+  // a 16 byte json value for big documents that stay in memory. the first 8 bytes hold the value
+  // or a pointer to the children, the next 4 the length and the last byte the type. strings of up to
+  // 15 characters are kept inside the node, and the elements of an array or the members of an
+  // object sit next to each other instead of behind a pointer each.
+  // nodes own nothing, strings and children live in a memory_arena, usually a compact_document's,
+  // so copying a node is shallow and both copies share the children.
+  class compact_node {
+    template <bool> friend class compact_builder;
+  public:
+    struct member;
+    template <typename T>
+    struct range {
+      FORCE_INLINE T* begin() const { return first; }
+      FORCE_INLINE T* end() const { return last; }
+      FORCE_INLINE size_t size() const { return last - first; }
+      FORCE_INLINE bool empty() const { return first == last; }
+      FORCE_INLINE T& operator[](size_t index) const { return first[index]; }
+
+      T* first;
+      T* last;
+    };
+    static const size_t max_inline = 15 / sizeof(json_char);
+
+    FORCE_INLINE compact_node() : data(), len(0), capacity_log2(0), reserved(), tag(null_value) {}
+    explicit compact_node(bool val) : data(), len(0), capacity_log2(0), reserved(), tag(val ? true_value : false_value) {}
+    explicit compact_node(double val) : data(), len(0), capacity_log2(0), reserved(), tag(real_value) { data.real = val; }
+    template <typename T, typename = typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type>
+    explicit compact_node(T val) : data(), len(0), capacity_log2(0), reserved(), tag() { set_integer(val); }
+    explicit compact_node(const number_value& val) : data(), len(0), capacity_log2(0), reserved(), tag() {
+      switch (val.kind) {
+        case number_kind::signed_integer: tag = signed_value; data.int_val = val.int_val; break;
+        case number_kind::unsigned_integer: tag = unsigned_value; data.uint_val = val.uint_val; break;
+        default: tag = real_value; data.real = val.real; break;
+      }
+    }
+    // a string that does not fit inline is copied into arena
+    compact_node(const json_char* str, size_t length, memory_arena& arena)
+      : data(), len(0), capacity_log2(0), reserved(), tag() { set_string(str, length, &arena, false); }
+
+    FORCE_INLINE node_type type() const {
+      static const node_type types[] = {
+        node_type::null_type, node_type::boolean_type, node_type::boolean_type, node_type::number_type, node_type::number_type,
+        node_type::number_type, node_type::string_type, node_type::string_type, node_type::array_type, node_type::object_type
+      };
+      return types[kind()];
+    }
+    FORCE_INLINE bool is_null() const { return tag == null_value; }
+    FORCE_INLINE bool is_boolean() const { return tag == true_value || tag == false_value; }
+    FORCE_INLINE bool is_number() const { return tag >= real_value && tag <= unsigned_value; }
+    FORCE_INLINE bool is_integer() const { return tag == signed_value || tag == unsigned_value; }
+    FORCE_INLINE bool is_string() const { return kind() == inline_string || tag == string_value; }
+    FORCE_INLINE bool is_array() const { return tag == array_value; }
+    FORCE_INLINE bool is_object() const { return tag == object_value; }
+
+    FORCE_INLINE bool get_boolean() const { return tag == true_value; }
+    FORCE_INLINE double get_number() const {
+      switch (tag) {
+        case signed_value: return static_cast<double>(data.int_val);
+        case unsigned_value: return static_cast<double>(data.uint_val);
+        default: return data.real;
+      }
+    }
+    // saturating, like json_node
+    FORCE_INLINE int64_t get_integer() const {
+      switch (tag) {
+        case real_value: return saturate_int64(data.real);
+        case unsigned_value: return std::numeric_limits<int64_t>::max();
+        default: return data.int_val;
+      }
+    }
+    FORCE_INLINE uint64_t get_unsigned() const {
+      switch (tag) {
+        case real_value: return saturate_uint64(data.real);
+        case signed_value: return data.int_val < 0 ? 0 : static_cast<uint64_t>(data.int_val);
+        default: return data.uint_val;
+      }
+    }
+    // an inline string points into the node itself, so the view lives as long as this copy of it
+    FORCE_INLINE string_view get_string() const {
+      _ASSERT(is_string());
+      return kind() == inline_string ? string_view(inline_chars(), inline_length()) : string_view(data.str, len);
+    }
+    FORCE_INLINE range<compact_node> get_array() const {
+      _ASSERT(is_array());
+      return range<compact_node>{data.elements, data.elements + len};
+    }
+    range<member> get_object() const;
+    FORCE_INLINE size_t length() const {
+      if (kind() == inline_string) return inline_length();
+      return tag >= string_value ? len : 0;
+    }
+
+    FORCE_INLINE compact_node& get_element(size_t index) {
+      static compact_node null_node;
+      return is_array() && index < len ? data.elements[index] : null_node;
+    }
+    FORCE_INLINE const compact_node& get_element(size_t index) const {
+      return const_cast<compact_node*>(this)->get_element(index);
+    }
+    // the first member with the key, or a null node
+    compact_node& get_node(string_view key);
+    FORCE_INLINE const compact_node& get_node(string_view key) const {
+      return const_cast<compact_node*>(this)->get_node(key);
+    }
+    FORCE_INLINE compact_node& operator[](size_t index) { return get_element(index); }
+    FORCE_INLINE const compact_node& operator[](size_t index) const { return get_element(index); }
+    FORCE_INLINE compact_node& operator[](string_view key) { return get_node(key); }
+    FORCE_INLINE const compact_node& operator[](string_view key) const { return get_node(key); }
+    FORCE_INLINE bool has(string_view key) const { return find(key) != nullptr; }
+
+    // scalars need no memory, strings and children come from arena. a value that is replaced is
+    // left in its arena until the arena is reset.
+    FORCE_INLINE compact_node& operator=(bool val) { *this = compact_node(val); return *this; }
+    FORCE_INLINE compact_node& operator=(double val) { *this = compact_node(val); return *this; }
+    template <typename T>
+    FORCE_INLINE typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value, compact_node&>::type
+    operator=(T val) { *this = compact_node(val); return *this; }
+    FORCE_INLINE void set_string(const json_char* str, size_t length, memory_arena& arena) {
+      set_string(str, length, &arena, false);
+    }
+    // appends to an array, a null node becomes an empty array first
+    compact_node& push_back(const compact_node& value, memory_arena& arena);
+    // appends a member to an object, a null node becomes an empty object first
+    compact_node& insert(const json_char* key, size_t length, const compact_node& value, memory_arena& arena);
+
+    std::basic_string<json_char> serialize(bool prettify = false, unsigned int indent_size = 2) const {
+      std::basic_string<json_char> s;
+      string_writer<std::basic_string<json_char>> out(s);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      return s;
+    }
+    // appends to out, which is not cleared first
+    FORCE_INLINE void serialize(output_buffer& out, bool prettify = false, unsigned int indent_size = 2) const {
+      _serialize(prettify ? 0 : -1, out, indent_size);
+    }
+    template <typename Sink>
+    bool serialize_to(Sink& sink, bool prettify = false, unsigned int indent_size = 2) const {
+      chunked_writer<Sink> out(sink);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      return out.flush();
+    }
+
+  private:
+    enum : uint8_t {
+      null_value = 0,
+      false_value,
+      true_value,
+      real_value,
+      signed_value,
+      unsigned_value,
+      inline_string,
+      string_value,
+      array_value,
+      object_value,
+      // capacity_log2 of children the parser sized exactly
+      exact_capacity = 0xFF
+    };
+
+    // the type takes the low 4 bits of the tag, the high 4 hold the length of an inline string
+    FORCE_INLINE uint8_t kind() const { return tag & 0xF; }
+    FORCE_INLINE size_t inline_length() const { return tag >> 4; }
+    FORCE_INLINE const json_char* inline_chars() const { return reinterpret_cast<const json_char*>(this); }
+    FORCE_INLINE uint32_t capacity() const { return capacity_log2 == exact_capacity ? len : (1u << capacity_log2); }
+
+    template <typename T>
+    FORCE_INLINE void set_integer(T val) {
+      if (std::is_signed<T>::value || static_cast<uint64_t>(val) <= static_cast<uint64_t>(std::numeric_limits<int64_t>::max())) {
+        tag = signed_value;
+        data.int_val = static_cast<int64_t>(val);
+      } else {
+        tag = unsigned_value;
+        data.uint_val = static_cast<uint64_t>(val);
+      }
+    }
+    // borrow keeps pointing at str instead of copying a string that does not fit inline
+    FORCE_INLINE void set_string(const json_char* str, size_t length, memory_arena* arena, bool borrow) {
+      if (length <= max_inline) {
+        *this = compact_node();
+        std::char_traits<json_char>::copy(reinterpret_cast<json_char*>(this), str, length);
+        tag = static_cast<uint8_t>(inline_string | (length << 4));
+        return;
+      }
+      if (!borrow) {
+        json_char* copy = static_cast<json_char*>(arena->allocate(length * sizeof(json_char), alignof(json_char)));
+        std::char_traits<json_char>::copy(copy, str, length);
+        str = copy;
+      }
+      data.str = str;
+      len = static_cast<uint32_t>(length);
+      capacity_log2 = 0;
+      tag = string_value;
+    }
+    FORCE_INLINE bool key_equal(const json_char* key, size_t length) const {
+      if (length <= max_inline) {
+        return tag == static_cast<uint8_t>(inline_string | (length << 4))
+          && std::char_traits<json_char>::compare(inline_chars(), key, length) == 0;
+      }
+      return tag == string_value && len == length && std::char_traits<json_char>::compare(data.str, key, length) == 0;
+    }
+    const member* find(string_view key) const;
+    // room for one more child, capacities grow in powers of two
+    template <typename T>
+    FORCE_INLINE T* grow(T* items, memory_arena& arena) {
+      if (len < capacity() && items) return items;
+      uint8_t log2 = 2;
+      while ((1u << log2) <= len) ++log2;
+      T* grown = static_cast<T*>(arena.allocate(sizeof(T) << log2, alignof(T)));
+      if (len) memcpy(static_cast<void*>(grown), items, sizeof(T) * len);
+      capacity_log2 = log2;
+      return grown;
+    }
+    template <typename Writer>
+    void _serialize(int indent, Writer& out, unsigned int indent_size) const;
+
+    union payload {
+      double real;
+      int64_t int_val;
+      uint64_t uint_val;
+      const json_char* str;
+      compact_node* elements;
+      member* members;
+    } data;
+    uint32_t len;
+    uint8_t capacity_log2;
+    uint8_t reserved[2];
+    uint8_t tag;
+  };
+
+  struct compact_node::member {
+    compact_node key;
+    compact_node value;
+  };
+
+  static_assert(sizeof(compact_node) == 16, "compact_node is meant to take 16 bytes");
+  static_assert(sizeof(compact_node::member) == 2 * sizeof(compact_node), "members are read as pairs of nodes");
+
+  FORCE_INLINE compact_node::range<compact_node::member> compact_node::get_object() const {
+    _ASSERT(is_object());
+    return range<member>{data.members, data.members + len};
+  }
+
+  FORCE_INLINE const compact_node::member* compact_node::find(string_view key) const {
+    if (!is_object()) return nullptr;
+    for (const member* m = data.members, *end = data.members + len; m != end; ++m) {
+      if (m->key.key_equal(key.data(), key.size())) return m;
+    }
+    return nullptr;
+  }
+
+  FORCE_INLINE compact_node& compact_node::get_node(string_view key) {
+    static compact_node null_node;
+    const member* m = find(key);
+    return m ? const_cast<member*>(m)->value : null_node;
+  }
+
+  inline compact_node& compact_node::push_back(const compact_node& value, memory_arena& arena) {
+    if (is_null()) tag = array_value;
+    _ASSERT(is_array());
+    data.elements = grow(data.elements, arena);
+    data.elements[len] = value;
+    return data.elements[len++];
+  }
+
+  inline compact_node& compact_node::insert(const json_char* key, size_t length, const compact_node& value, memory_arena& arena) {
+    if (is_null()) tag = object_value;
+    _ASSERT(is_object());
+    data.members = grow(data.members, arena);
+    member& m = data.members[len++];
+    m.key.set_string(key, length, &arena, false);
+    m.value = value;
+    return m.value;
+  }
+
+  template <typename Writer>
+  void compact_node::_serialize(int indent, Writer& out, unsigned int indent_size) const {
+    switch (kind()) {
+      case inline_string:
+      case string_value: {
+        const string_view str = get_string();
+        write_escaped(out, str.data(), str.size());
+        break;
+      }
+      case object_value: {
+        out.put('{');
+        if (indent != -1) {
+          ++indent;
+        }
+        for (uint32_t i = 0; i < len; ++i) {
+          if (i) {
+            out.put(',');
+          }
+          if (indent != -1) {
+            write_indent(out, indent, indent_size);
+          }
+          const string_view key = data.members[i].key.get_string();
+          write_escaped(out, key.data(), key.size());
+          out.put(':');
+          if (indent != -1) {
+            out.put(' ');
+          }
+          data.members[i].value._serialize(indent, out, indent_size);
+        }
+        if (indent != -1) {
+          --indent;
+          if (len) {
+            write_indent(out, indent, indent_size);
+          }
+        }
+        out.put('}');
+        break;
+      }
+      case array_value: {
+        out.put('[');
+        if (indent != -1) {
+          ++indent;
+        }
+        for (uint32_t i = 0; i < len; ++i) {
+          if (i) {
+            out.put(',');
+          }
+          if (indent != -1) {
+            write_indent(out, indent, indent_size);
+          }
+          data.elements[i]._serialize(indent, out, indent_size);
+        }
+        if (indent != -1) {
+          --indent;
+          if (len) {
+            write_indent(out, indent, indent_size);
+          }
+        }
+        out.put(']');
+        break;
+      }
+      case real_value:
+      case signed_value:
+      case unsigned_value: {
+        char buf[MAX_NUMBER_STRING_SIZE];
+        const char* e;
+        switch (tag) {
+          case signed_value:
+            e = itoa(buf, data.int_val);
+            break;
+          case unsigned_value:
+            e = utoa(buf, data.uint_val);
+            break;
+          default:
+            e = dtoa(buf, data.real);
+            break;
+        }
+        out.write(buf, e - buf);
+        break;
+      }
+      case true_value:
+        out.write("true", 4);
+        break;
+      case false_value:
+        out.write("false", 5);
+        break;
+      default:
+        out.write("null", 4);
+        break;
+    }
+  }
+
+  // grows compact nodes out of sax events. values wait on a stack until their container ends,
+  // which then moves them into one block of the arena.
+  template <bool Borrow>
+  class compact_builder : public json_handler {
+  public:
+    FORCE_INLINE compact_builder(memory_arena& arena, std::vector<compact_node>& stack) : arena(arena), stack(stack) {}
+
+    FORCE_INLINE bool null() { stack.emplace_back(); return true; }
+    FORCE_INLINE bool boolean(bool val) { stack.emplace_back(val); return true; }
+    FORCE_INLINE bool number(const number_value& val) { stack.emplace_back(val); return true; }
+    FORCE_INLINE bool string(const char* str, size_t length, bool copy) {
+      stack.emplace_back();
+      stack.back().set_string(str, length, &arena, Borrow && !copy);
+      return true;
+    }
+    FORCE_INLINE bool key(const char* str, size_t length, bool copy) { return string(str, length, copy); }
+    FORCE_INLINE bool end_object(size_t members) { return close(compact_node::object_value, members * 2); }
+    FORCE_INLINE bool end_array(size_t elements) { return close(compact_node::array_value, elements); }
+
+  private:
+    FORCE_INLINE bool close(uint8_t tag, size_t count) {
+      compact_node node;
+      node.tag = tag;
+      node.len = static_cast<uint32_t>(tag == compact_node::object_value ? count / 2 : count);
+      node.capacity_log2 = compact_node::exact_capacity;
+      if (count) {
+        void* children = arena.allocate(sizeof(compact_node) * count, alignof(compact_node));
+        memcpy(children, &stack[stack.size() - count], sizeof(compact_node) * count);
+        node.data.elements = static_cast<compact_node*>(children);
+        stack.resize(stack.size() - count);
+      }
+      stack.push_back(node);
+      return true;
+    }
+
+    memory_arena& arena;
+    std::vector<compact_node>& stack;
+  };
+
+  // a tree of compact_nodes drawn from one memory_arena, for documents that are kept around and read a lot.
+  // the view variant keeps strings that need no unescaping pointing into the parsed buffer.
+  template <bool Borrow>
+  class basic_compact_document : public compact_node {
+  public:
+    explicit basic_compact_document(size_t chunk_size = memory_arena::default_chunk_size) : arena(chunk_size) {}
+    basic_compact_document(const basic_compact_document&) = delete;
+    basic_compact_document& operator=(const basic_compact_document&) = delete;
+
+    bool parse(const char* json, size_t length, std::string& err) {
+      reset();
+      compact_builder<Borrow> builder(arena, stack);
+      const bool ok = json_parser::sax_parse(builder, json, length, err);
+      if (ok) static_cast<compact_node&>(*this) = stack.back();
+      stack.clear();
+      return ok;
+    }
+    FORCE_INLINE bool parse(const std::string& json, std::string& err) {
+      return parse(json.data(), json.size(), err);
+    }
+    template <bool B = Borrow>
+    FORCE_INLINE bool parse(std::string&& json, std::string& err) {
+      static_assert(!B, "compact_view_document can not parse a temporary string");
+      return parse(json.data(), json.size(), err);
+    }
+
+    // drops the tree and rewinds the arena, keeping its largest chunk for the next parse
+    FORCE_INLINE void reset() {
+      static_cast<compact_node&>(*this) = compact_node();
+      arena.reset();
+    }
+
+    FORCE_INLINE memory_arena& get_arena() { return arena; }
+
+    using compact_node::operator=;
+
+  private:
+    memory_arena arena;
+    std::vector<compact_node> stack;
+  };
+
+  typedef basic_compact_document<false> compact_document;
+  typedef basic_compact_document<true> compact_view_document;
+
+  class tape_document;
+
+  // read only cursor into a tape_document. it is just a position on the tape, cheap to copy and
+  // valid as long as the document is not parsed again. elements and members are found by skipping
+  // over their siblings, each skip costs the same whatever the size of the sibling.
+  class tape_view {
+    friend class tape_document;
+  public:
+    class iterator {
+    public:
+      FORCE_INLINE tape_view operator*() const { return tape_view(tape, strings, object ? after(tape, index) : index); }
+      FORCE_INLINE iterator& operator++() {
+        index = after(tape, object ? after(tape, index) : index);
+        return *this;
+      }
+      FORCE_INLINE bool operator==(const iterator& other) const { return index == other.index; }
+      FORCE_INLINE bool operator!=(const iterator& other) const { return index != other.index; }
+      // the key of the current member when iterating an object
+      FORCE_INLINE string_view key() const { return tape_view(tape, strings, index).get_string(); }
+
+    private:
+      friend class tape_view;
+      FORCE_INLINE iterator(const tape_view& view, size_t index, bool object)
+        : tape(view.tape), strings(view.strings), index(index), object(object) {}
+
+      const uint64_t* tape;
+      const json_char* strings;
+      size_t index;
+      bool object;
+    };
+
+    FORCE_INLINE node_type type() const {
+      switch (tag()) {
+        case 't': case 'f': return node_type::boolean_type;
+        case 'd': case 'l': case 'u': return node_type::number_type;
+        case '"': return node_type::string_type;
+        case '[': return node_type::array_type;
+        case '{': return node_type::object_type;
+        default: return node_type::null_type;
+      }
+    }
+    FORCE_INLINE bool is_null() const { return tag() == 'n'; }
+    FORCE_INLINE bool is_boolean() const { return tag() == 't' || tag() == 'f'; }
+    FORCE_INLINE bool is_number() const { return tag() == 'd' || is_integer(); }
+    FORCE_INLINE bool is_integer() const { return tag() == 'l' || tag() == 'u'; }
+    FORCE_INLINE bool is_string() const { return tag() == '"'; }
+    FORCE_INLINE bool is_array() const { return tag() == '['; }
+    FORCE_INLINE bool is_object() const { return tag() == '{'; }
+
+    FORCE_INLINE bool get_boolean() const { return tag() == 't'; }
+    FORCE_INLINE double get_number() const {
+      switch (tag()) {
+        case 'l': return static_cast<double>(static_cast<int64_t>(tape[index + 1]));
+        case 'u': return static_cast<double>(tape[index + 1]);
+        default: return double_from_bits(tape[index + 1]);
+      }
+    }
+    // saturating, like json_node
+    FORCE_INLINE int64_t get_integer() const {
+      switch (tag()) {
+        case 'd': return saturate_int64(get_number());
+        case 'u': return std::numeric_limits<int64_t>::max();
+        default: return static_cast<int64_t>(tape[index + 1]);
+      }
+    }
+    FORCE_INLINE uint64_t get_unsigned() const {
+      switch (tag()) {
+        case 'd': return saturate_uint64(get_number());
+        case 'l': return static_cast<int64_t>(tape[index + 1]) < 0 ? 0 : tape[index + 1];
+        default: return tape[index + 1];
+      }
+    }
+    FORCE_INLINE string_view get_string() const {
+      _ASSERT(is_string());
+      return string_view(strings + (payload() & 0xFFFFFFFF), string_length());
+    }
+    // elements of an array or members of an object, characters of a string
+    FORCE_INLINE size_t length() const {
+      switch (tag()) {
+        case '"':
+          return string_length();
+        case '[':
+        case '{': {
+          const size_t count = (payload() >> 32) & max_count;
+          if (count < max_count) return count;
+          size_t n = 0;
+          for (iterator i = begin(), e = end(); i != e; ++i) ++n;
+          return n;
+        }
+        default:
+          return 0;
+      }
+    }
+
+    // a null view when there is no such element
+    FORCE_INLINE tape_view get_element(size_t index) const {
+      if (!is_array()) return null_view();
+      iterator i = begin(), e = end();
+      for (; i != e && index; ++i, --index) {}
+      return i != e ? *i : null_view();
+    }
+    // the first member with the key, or a null view
+    FORCE_INLINE tape_view get_node(string_view key) const {
+      if (!is_object()) return null_view();
+      for (iterator i = begin(), e = end(); i != e; ++i) {
+        if (i.key() == key) return *i;
+      }
+      return null_view();
+    }
+    FORCE_INLINE tape_view operator[](size_t index) const { return get_element(index); }
+    FORCE_INLINE tape_view operator[](string_view key) const { return get_node(key); }
+    FORCE_INLINE bool has(string_view key) const { return !get_node(key).is_missing(); }
+
+    // elements of an array, or members of an object with the key on the iterator
+    FORCE_INLINE iterator begin() const { return iterator(*this, index + 1, is_object()); }
+    FORCE_INLINE iterator end() const {
+      return iterator(*this, is_array() || is_object() ? (payload() & 0xFFFFFFFF) - 1 : index + 1, is_object());
+    }
+
+    std::basic_string<json_char> serialize(bool prettify = false, unsigned int indent_size = 2) const {
+      std::basic_string<json_char> s;
+      string_writer<std::basic_string<json_char>> out(s);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      return s;
+    }
+    // appends to out, which is not cleared first
+    FORCE_INLINE void serialize(output_buffer& out, bool prettify = false, unsigned int indent_size = 2) const {
+      _serialize(prettify ? 0 : -1, out, indent_size);
+    }
+    template <typename Sink>
+    bool serialize_to(Sink& sink, bool prettify = false, unsigned int indent_size = 2) const {
+      chunked_writer<Sink> out(sink);
+      _serialize(prettify ? 0 : -1, out, indent_size);
+      return out.flush();
+    }
+
+  private:
+    // element and member counts are kept up to this, bigger containers are counted on demand
+    static const uint64_t max_count = 0xFFFFFF;
+
+    FORCE_INLINE tape_view(const uint64_t* tape, const json_char* strings, size_t index) : tape(tape), strings(strings), index(index) {}
+
+    static FORCE_INLINE tape_view null_view() {
+      static const uint64_t null_word = static_cast<uint64_t>('n') << 56;
+      return tape_view(&null_word, nullptr, 0);
+    }
+    FORCE_INLINE bool is_missing() const { return tape == null_view().tape; }
+    FORCE_INLINE char tag() const { return static_cast<char>(tape[index] >> 56); }
+    FORCE_INLINE uint64_t payload() const { return tape[index] & 0xFFFFFFFFFFFFFFULL; }
+    // strings too long for the 24 bit length field carry it in the next word
+    FORCE_INLINE size_t string_length() const {
+      const size_t length = (payload() >> 32) & max_count;
+      return length < max_count ? length : static_cast<size_t>(tape[index + 1]);
+    }
+    // position of the value that follows the one at index
+    static FORCE_INLINE size_t after(const uint64_t* tape, size_t index) {
+      const uint64_t word = tape[index];
+      switch (static_cast<char>(word >> 56)) {
+        case '[':
+        case '{':
+          return word & 0xFFFFFFFF;
+        case 'd':
+        case 'l':
+        case 'u':
+          return index + 2;
+        case '"':
+          return ((word >> 32) & max_count) < max_count ? index + 1 : index + 2;
+        default:
+          return index + 1;
+      }
+    }
+    template <typename Writer>
+    void _serialize(int indent, Writer& out, unsigned int indent_size) const {
+      switch (tag()) {
+        case '"': {
+          const string_view str = get_string();
+          write_escaped(out, str.data(), str.size());
+          break;
+        }
+        case '{':
+        case '[': {
+          const bool object = is_object();
+          out.put(object ? '{' : '[');
+          if (indent != -1) {
+            ++indent;
+          }
+          const iterator b = begin(), e = end();
+          for (iterator i = b; i != e; ++i) {
+            if (i != b) {
+              out.put(',');
+            }
+            if (indent != -1) {
+              write_indent(out, indent, indent_size);
+            }
+            if (object) {
+              const string_view key = i.key();
+              write_escaped(out, key.data(), key.size());
+              out.put(':');
+              if (indent != -1) {
+                out.put(' ');
+              }
+            }
+            (*i)._serialize(indent, out, indent_size);
+          }
+          if (indent != -1) {
+            --indent;
+            if (b != e) {
+              write_indent(out, indent, indent_size);
+            }
+          }
+          out.put(object ? '}' : ']');
+          break;
+        }
+        case 'd':
+        case 'l':
+        case 'u': {
+          char buf[MAX_NUMBER_STRING_SIZE];
+          const char* e;
+          switch (tag()) {
+            case 'l':
+              e = itoa(buf, static_cast<int64_t>(tape[index + 1]));
+              break;
+            case 'u':
+              e = utoa(buf, tape[index + 1]);
+              break;
+            default:
+              e = dtoa(buf, double_from_bits(tape[index + 1]));
+              break;
+          }
+          out.write(buf, e - buf);
+          break;
+        }
+        case 't':
+          out.write("true", 4);
+          break;
+        case 'f':
+          out.write("false", 5);
+          break;
+        default:
+          out.write("null", 4);
+          break;
+      }
+    }
+
+    const uint64_t* tape;
+    const json_char* strings;
+    size_t index;
+  };
+
+  // a parsed document laid out flat for reading: one array of tagged 64 bit words, the tape, and one
+  // buffer with the unescaped strings. the top byte of a word is its type. a string word holds the
+  // offset and length of its text, a number is followed by a word with its bits, an array or object
+  // word holds its element count and the position right after its closing word, which points back.
+  // both buffers are sized from the input before parsing and kept for the next parse.
+  class tape_document {
+  public:
+    tape_document() : tape_size(0), tape_capacity(0), string_size(0), string_capacity(0) {}
+    tape_document(const tape_document&) = delete;
+    tape_document& operator=(const tape_document&) = delete;
+
+    bool parse(const char* json, size_t length, std::string& err) {
+      tape_size = string_size = 0;
+      builder b(*this);
+      if (!json_parser::sax_parse(b, json, length, err)) {
+        if (b.too_large) err = "json too large.";
+        tape_size = 0;
+        return false;
+      }
+      return true;
+    }
+    FORCE_INLINE bool parse(const std::string& json, std::string& err) {
+      return parse(json.data(), json.size(), err);
+    }
+
+    // the root value, null before the first successful parse
+    FORCE_INLINE tape_view root() const {
+      return tape_size ? tape_view(tape.get(), strings.get(), 0) : tape_view::null_view();
+    }
+    FORCE_INLINE tape_view operator[](size_t index) const { return root().get_element(index); }
+    FORCE_INLINE tape_view operator[](string_view key) const { return root().get_node(key); }
+    FORCE_INLINE bool has(string_view key) const { return root().has(key); }
+    FORCE_INLINE size_t length() const { return root().length(); }
+    FORCE_INLINE std::basic_string<json_char> serialize(bool prettify = false, unsigned int indent_size = 2) const {
+      return root().serialize(prettify, indent_size);
+    }
+
+    // words on the tape and bytes of strings of the last parse
+    FORCE_INLINE size_t tape_length() const { return tape_size; }
+    FORCE_INLINE size_t string_bytes() const { return string_size * sizeof(json_char); }
+
+  private:
+    // writes the events onto the tape. a container word is completed once its end is known.
+    class builder : public json_handler {
+    public:
+      explicit builder(tape_document& doc) : too_large(false), doc(doc) {}
+
+      bool too_large;
+
+      // a token becomes at most two words, unescaped strings never outgrow the input.
+      // positions on the tape are 32 bit.
+      bool size_hint(size_t length, size_t tokens) {
+        too_large = tokens * 2 + 2 > std::numeric_limits<uint32_t>::max();
+        if (too_large) return false;
+        doc.reserve(tokens * 2 + 2, length);
+        return true;
+      }
+      FORCE_INLINE bool null() { return put('n', 0); }
+      FORCE_INLINE bool boolean(bool val) { return put(val ? 't' : 'f', 0); }
+      FORCE_INLINE bool number(const number_value& val) {
+        switch (val.kind) {
+          case number_kind::signed_integer:
+            put('l', 0);
+            doc.tape[doc.tape_size++] = static_cast<uint64_t>(val.int_val);
+            break;
+          case number_kind::unsigned_integer:
+            put('u', 0);
+            doc.tape[doc.tape_size++] = val.uint_val;
+            break;
+          default:
+            put('d', 0);
+            doc.tape[doc.tape_size++] = bits_from_double(val.real);
+            break;
+        }
+        return true;
+      }
+      FORCE_INLINE bool string(const char* str, size_t length, bool) {
+        const uint64_t offset = doc.string_size;
+        std::char_traits<json_char>::copy(doc.strings.get() + offset, str, length);
+        doc.string_size += length;
+        if (length < tape_view::max_count) return put('"', (static_cast<uint64_t>(length) << 32) | offset);
+        put('"', (tape_view::max_count << 32) | offset);
+        doc.tape[doc.tape_size++] = length;
+        return true;
+      }
+      FORCE_INLINE bool key(const char* str, size_t length, bool copy) { return string(str, length, copy); }
+      FORCE_INLINE bool start_object() { return start(); }
+      FORCE_INLINE bool end_object(size_t members) { return end('{', '}', members); }
+      FORCE_INLINE bool start_array() { return start(); }
+      FORCE_INLINE bool end_array(size_t elements) { return end('[', ']', elements); }
+
+    private:
+      FORCE_INLINE bool put(char tag, uint64_t payload) {
+        doc.tape[doc.tape_size++] = (static_cast<uint64_t>(static_cast<uint8_t>(tag)) << 56) | payload;
+        return true;
+      }
+      FORCE_INLINE bool start() {
+        open.push_back(doc.tape_size);
+        return put(0, 0);
+      }
+      FORCE_INLINE bool end(char open_tag, char close_tag, size_t count) {
+        const size_t begin = open.back();
+        open.pop_back();
+        const uint64_t saturated = count < tape_view::max_count ? count : tape_view::max_count;
+        doc.tape[begin] = (static_cast<uint64_t>(static_cast<uint8_t>(open_tag)) << 56) | (saturated << 32) | (doc.tape_size + 1);
+        return put(close_tag, begin);
+      }
+
+      tape_document& doc;
+      std::vector<size_t> open;
+    };
+
+    void reserve(size_t words, size_t chars) {
+      if (tape_capacity < words) {
+        tape.reset(new uint64_t[words]);
+        tape_capacity = words;
+      }
+      if (string_capacity < chars) {
+        strings.reset(new json_char[chars]);
+        string_capacity = chars;
+      }
+    }
+
+    std::unique_ptr<uint64_t[]> tape;
+    std::unique_ptr<json_char[]> strings;
+    size_t tape_size;
+    size_t tape_capacity;
+    size_t string_size;
+    size_t string_capacity;
+  };
+
+  // read only cursor into a lazy_document: the position of a token of the input. nothing below it
+  // has been decoded, numbers and strings are read from the input every time they are asked for.
+  class lazy_view {
+    friend class lazy_document;
+  public:
+    class iterator {
+    public:
+      FORCE_INLINE lazy_view operator*() const { return lazy_view(doc, object ? token + 3 : token); }
+      FORCE_INLINE iterator& operator++() {
+        token = lazy_view(doc, object ? token + 3 : token).after();
+        // skip the comma, the last child is followed by the closing token
+        if (token != end) ++token;
+        return *this;
+      }
+      FORCE_INLINE bool operator==(const iterator& other) const { return token == other.token; }
+      FORCE_INLINE bool operator!=(const iterator& other) const { return token != other.token; }
+      // the key of the current member when iterating an object
+      FORCE_INLINE string_view key() const { return lazy_view(doc, token).get_string(); }
+
+    private:
+      friend class lazy_view;
+      FORCE_INLINE iterator(const lazy_document* doc, uint32_t token, uint32_t end, bool object)
+        : doc(doc), token(token), end(end), object(object) {}
+
+      const lazy_document* doc;
+      uint32_t token;
+      uint32_t end;
+      bool object;
+    };
+
+    FORCE_INLINE lazy_view() : doc(nullptr), token(0) {}
+
+    FORCE_INLINE node_type type() const {
+      switch (peek()) {
+        case 't': case 'f': return node_type::boolean_type;
+        case '\"': return node_type::string_type;
+        case '[': return node_type::array_type;
+        case '{': return node_type::object_type;
+        case 'n': return node_type::null_type;
+        default: return node_type::number_type;
+      }
+    }
+    // a missing element or member is null as well
+    FORCE_INLINE bool is_null() const { return peek() == 'n'; }
+    FORCE_INLINE bool is_boolean() const { return peek() == 't' || peek() == 'f'; }
+    FORCE_INLINE bool is_number() const { return type() == node_type::number_type; }
+    FORCE_INLINE bool is_string() const { return peek() == '\"'; }
+    FORCE_INLINE bool is_array() const { return peek() == '['; }
+    FORCE_INLINE bool is_object() const { return peek() == '{'; }
+
+    FORCE_INLINE bool get_boolean() const { return peek() == 't'; }
+    // false when this is not a number or the number is malformed, which the parse does not check
+    bool get_number(number_value& value) const;
+    FORCE_INLINE double get_number() const {
+      number_value value;
+      if (!get_number(value)) return 0;
+      switch (value.kind) {
+        case number_kind::signed_integer: return static_cast<double>(value.int_val);
+        case number_kind::unsigned_integer: return static_cast<double>(value.uint_val);
+        default: return value.real;
+      }
+    }
+    FORCE_INLINE bool is_integer() const {
+      number_value value;
+      return get_number(value) && value.kind != number_kind::real;
+    }
+    // saturating, like json_node
+    FORCE_INLINE int64_t get_integer() const {
+      number_value value;
+      if (!get_number(value)) return 0;
+      return saturate_int64(value);
+    }
+    FORCE_INLINE uint64_t get_unsigned() const {
+      number_value value;
+      if (!get_number(value)) return 0;
+      return saturate_uint64(value);
+    }
+    // strings without escapes point into the input, the others are decoded into the document the
+    // first time they are read, which is the one read that writes to it: threads sharing a document
+    // have to take turns for those. empty for a malformed escape, which the parse does not check either.
+    string_view get_string() const;
+    // elements of an array or members of an object, counted by skipping over them
+    FORCE_INLINE size_t length() const {
+      if (is_string()) return get_string().size();
+      size_t n = 0;
+      for (iterator i = begin(), e = end(); i != e; ++i) ++n;
+      return n;
+    }
+
+    FORCE_INLINE lazy_view get_element(size_t index) const {
+      if (!is_array()) return lazy_view();
+      iterator i = begin(), e = end();
+      for (; i != e && index; ++i, --index) {}
+      return i != e ? *i : lazy_view();
+    }
+    // the first member with the key, or a null view. escaped keys are compared without being kept.
+    lazy_view get_node(string_view key) const;
+    FORCE_INLINE lazy_view operator[](size_t index) const { return get_element(index); }
+    FORCE_INLINE lazy_view operator[](string_view key) const { return get_node(key); }
+    FORCE_INLINE bool has(string_view key) const { return get_node(key).doc != nullptr; }
+
+    // elements of an array, or members of an object with the key on the iterator
+    iterator begin() const;
+    iterator end() const;
+
+    // the text of the value in the input, as it was written
+    string_view raw() const;
+    // parses an array or object into a tree when it is needed as one after all
+    template <typename Node>
+    FORCE_INLINE bool materialize(Node& node, std::string& err) const {
+      const string_view text = raw();
+      return json_parser::parse(node, text.data(), text.size(), err);
+    }
+
+  private:
+    FORCE_INLINE lazy_view(const lazy_document* doc, uint32_t token) : doc(doc), token(token) {}
+
+    FORCE_INLINE char peek() const;
+    // the token after this value
+    FORCE_INLINE uint32_t after() const;
+
+    const lazy_document* doc;
+    uint32_t token;
+  };
+
+  // parses on demand. parse() only finds the tokens of the input and checks that they form valid
+  // json, which is several times faster than building a tree; a value is decoded when it is read
+  // through a lazy_view. the content of numbers and string escapes is left for then as well.
+  // the input has to outlive the document, like for json_view_document.
+  class lazy_document {
+    friend class lazy_view;
+  public:
+    lazy_document() : json(nullptr), json_length(0), count(0), capacity(0) {}
+    lazy_document(const lazy_document&) = delete;
+    lazy_document& operator=(const lazy_document&) = delete;
+
+    bool parse(const char* input, size_t input_length, std::string& err) {
+      err.clear();
+      strings.reset();
+      decoded.clear();
+      json = input;
+      json_length = input_length;
+      count = 0;
+      if (json_length >= std::numeric_limits<uint32_t>::max()) {
+        return json_parser::make_err_msg("json too large.", err);
+      }
+      if (capacity < json_length + 2) {
+        capacity = std::max(json_length + 2, static_cast<size_t>(1024));
+        index.reset(new uint32_t[capacity]);
+        match.reset(new uint32_t[capacity]);
+      }
+      size_t tokens = 0;
+      if (!structural_index::scan(json, json_length, index.get(), tokens)) {
+        return json_parser::make_err_msg("unclosed string.", err);
+      }
+      index[tokens] = index[tokens + 1] = static_cast<uint32_t>(json_length);
+      if (!validate(err)) return false;
+      count = tokens;
+      return true;
+    }
+    FORCE_INLINE bool parse(const std::string& input, std::string& err) {
+      return parse(input.data(), input.size(), err);
+    }
+    bool parse(std::string&& input, std::string& err) = delete;
+
+    // the root value, null before the first successful parse
+    FORCE_INLINE lazy_view root() const { return count ? lazy_view(this, 0) : lazy_view(); }
+    FORCE_INLINE lazy_view operator[](size_t i) const { return root().get_element(i); }
+    FORCE_INLINE lazy_view operator[](string_view key) const { return root().get_node(key); }
+    FORCE_INLINE bool has(string_view key) const { return root().has(key); }
+    FORCE_INLINE size_t length() const { return root().length(); }
+
+  private:
+    FORCE_INLINE char at(uint32_t token) const {
+      return index[token] < json_length ? json[index[token]] : '\0';
+    }
+
+    // one pass over the tokens with the grammar of json_parser and its messages. every array and
+    // object gets the position of its closing token, so a lazy_view skips it in one step.
+    bool validate(std::string& err) {
+      uint32_t t = 0;
+      open.clear();
+      const char first = at(0);
+      if (first != token_type::start_object && first != token_type::start_array) {
+        return json_parser::make_err_msg("invalid or empty json.", err);
+      }
+      for (;;) {
+        // a value starts at t
+        const char c = at(t);
+        if (c == token_type::start_object || c == token_type::start_array) {
+          open.push_back(t++);
+          if (at(t) == (c == token_type::start_object ? token_type::end_object : token_type::end_array)) {
+            match[open.back()] = t++;
+            open.pop_back();
+          } else if (c == token_type::start_object) {
+            if (!member_key(t)) return json_parser::make_err_msg("invalid token.", err);
+            continue;
+          } else {
+            continue;
+          }
+        } else if (c == token_type::double_quote) {
+          match[t] = 0;
+          t += 2;
+        } else if (c == 't' || c == 'f' || c == 'n') {
+          structural_iterator literal(json, json_length, index.get() + t);
+          if (!json_parser::match_literal(literal, c == 't' ? "true" : c == 'f' ? "false" : "null", c == 'f' ? 5 : 4)) {
+            return json_parser::make_err_msg("parse error.", err);
+          }
+          ++t;
+        } else {
+          if (c != '-' && c != '+' && c != '.' && (c < '0' || c > '9')) return json_parser::make_err_msg("parse error.", err);
+          ++t;
+        }
+
+        // after a value: the next sibling or the end of the innermost container
+        for (;;) {
+          if (open.empty()) return true;
+          const bool object = at(open.back()) == token_type::start_object;
+          if (at(t) == token_type::comma) {
+            ++t;
+            if (object && !member_key(t)) return json_parser::make_err_msg("invalid token.", err);
+            break;
+          }
+          if (at(t) != (object ? token_type::end_object : token_type::end_array)) {
+            return json_parser::make_err_msg(object ? "invalid end of object." : "invalid end of array.", err);
+          }
+          match[open.back()] = t++;
+          open.pop_back();
+        }
+      }
+    }
+    // a non empty key and its colon
+    FORCE_INLINE bool member_key(uint32_t& t) const {
+      if (at(t) != token_type::double_quote || index[t + 1] == index[t] + 1 || at(t + 2) != token_type::colon) return false;
+      match[t] = 0;
+      t += 3;
+      return true;
+    }
+
+    const char* json;
+    size_t json_length;
+    size_t count;
+    size_t capacity;
+    std::unique_ptr<uint32_t[]> index;
+    // closing token of the container opened by a token. for a string, 1 + its entry in decoded once
+    // it has been read, 0 before.
+    std::unique_ptr<uint32_t[]> match;
+    std::vector<uint32_t> open;
+    // strings with escapes, decoded as they are read
+    mutable memory_arena strings;
+    mutable std::vector<string_view> decoded;
+  };
+
+  FORCE_INLINE char lazy_view::peek() const {
+    return doc ? doc->at(token) : 'n';
+  }
+
+  FORCE_INLINE uint32_t lazy_view::after() const {
+    switch (peek()) {
+      case '[':
+      case '{':
+        return doc->match[token] + 1;
+      case '\"':
+        return token + 2;
+      default:
+        return token + 1;
+    }
+  }
+
+  FORCE_INLINE lazy_view::iterator lazy_view::begin() const {
+    if (!is_array() && !is_object()) return iterator(doc, token, token, false);
+    const uint32_t close = doc->match[token];
+    return iterator(doc, token + 1, close, is_object());
+  }
+
+  FORCE_INLINE lazy_view::iterator lazy_view::end() const {
+    if (!is_array() && !is_object()) return iterator(doc, token, token, false);
+    const uint32_t close = doc->match[token];
+    return iterator(doc, close, close, is_object());
+  }
+
+  inline bool lazy_view::get_number(number_value& value) const {
+    if (!is_number() || !doc) return false;
+    structural_iterator scalar(doc->json, doc->json_length, doc->index.get() + token);
+    return json_parser::parse_number(&value, scalar);
+  }
+
+  inline string_view lazy_view::get_string() const {
+    if (!is_string()) return string_view();
+    const char* begin = doc->json + doc->index[token] + 1;
+    const char* end = doc->json + doc->index[token + 1];
+    if (!memchr(begin, '\\', end - begin)) return string_view(begin, end - begin);
+    // decoded once, later reads find it again through the token
+    uint32_t& slot = doc->match[token];
+    if (slot) return doc->decoded[slot - 1];
+    char* out = static_cast<char*>(doc->strings.allocate(end - begin, 1));
+    char* out_end = unescape(begin, end, out);
+    doc->decoded.push_back(out_end ? string_view(out, out_end - out) : string_view());
+    slot = static_cast<uint32_t>(doc->decoded.size());
+    return doc->decoded.back();
+  }
+
+  inline lazy_view lazy_view::get_node(string_view key) const {
+    if (!is_object()) return lazy_view();
+    // keys with escapes are decoded here, on the stack while they are short
+    char buffer[128];
+    std::string spill;
+    for (iterator i = begin(), e = end(); i != e; ++i) {
+      const char* begin = doc->json + doc->index[i.token] + 1;
+      const size_t size = doc->index[i.token + 1] - doc->index[i.token] - 1;
+      bool equal;
+      if (!memchr(begin, '\\', size)) {
+        equal = size == key.size() && memcmp(begin, key.data(), size) == 0;
+      } else if (size < key.size()) {
+        // escapes only ever make a key shorter
+        equal = false;
+      } else {
+        char* out = buffer;
+        if (size > sizeof(buffer)) {
+          spill.resize(size);
+          out = &spill[0];
+        }
+        char* out_end = unescape(begin, begin + size, out);
+        equal = out_end && static_cast<size_t>(out_end - out) == key.size() && memcmp(out, key.data(), key.size()) == 0;
+      }
+      if (equal) return *i;
     }
-    FORCE_INLINE json_node& operator=(const double other) {
-      clear();
-      set(other);
-      return *this;
+    return lazy_view();
+  }
+
+  inline string_view lazy_view::raw() const {
+    if (!doc) return string_view("null", 4);
+    const char* begin = doc->json + doc->index[token];
+    if (is_array() || is_object()) return string_view(begin, doc->index[doc->match[token]] + 1 - doc->index[token]);
+    if (is_string()) return string_view(begin, doc->index[token + 1] + 1 - doc->index[token]);
+    const char* end = doc->json + doc->index[token + 1];
+    while (end != begin && json_parser::is_space(end[-1])) --end;
+    return string_view(begin, end - begin);
+  }
+
+  // a compiled query over a json tree or over json text. compile() takes a path expression:
+  //   $.store.book[0].title      members and elements, $ is optional
+  //   $.store.*  $..author       every child, every member named author at any depth
+  //   $.list[-1]  $.list[1:5:2]  counting from the end, slices with an optional step
+  //   $['odd.key']  $..[0]       quoted keys, descent with a bracket selector
+  // compile_pointer() takes a JSON Pointer (RFC 6901) such as /store/book/0/title.
+  // keys are hashed once when compiling, so compile a path once and evaluate it as often as needed.
+  class json_path {
+  public:
+    json_path() : singular(true) {}
+
+    FORCE_INLINE bool compile(const std::string& expr, std::string& err) {
+      return compile(expr.data(), expr.size(), err);
     }
-    FORCE_INLINE json_node& operator=(const int other) {
-      clear();
-      set((number)other);
-      return *this;
+    bool compile(const char* expr, size_t length, std::string& err) {
+      err.clear();
+      steps.clear();
+      const char* p = expr;
+      const char* e = expr + length;
+      if (p != e && *p == '$') ++p;
+      while (p != e) {
+        step s;
+        if (*p == '.') {
+          if (++p != e && *p == '.') {
+            s.descend = true;
+            ++p;
+          }
+          if (p != e && *p == '[' && s.descend) {
+            if (!parse_bracket(p, e, s)) return json_parser::make_err_msg("invalid path.", err);
+          } else if (p != e && *p == '*') {
+            s.kind = step::wildcard;
+            ++p;
+          } else {
+            const char* name = p;
+            while (p != e && *p != '.' && *p != '[') ++p;
+            if (p == name) return json_parser::make_err_msg("invalid path.", err);
+            s.key.assign(name, p);
+          }
+        } else if (*p != '[' || !parse_bracket(p, e, s)) {
+          return json_parser::make_err_msg("invalid path.", err);
+        }
+        steps.push_back(std::move(s));
+      }
+      hash_keys();
+      return true;
     }
-    FORCE_INLINE json_node& operator=(const string& other) {
-      clear();
-      set(other);
-      return *this;
+
+    FORCE_INLINE bool compile_pointer(const std::string& pointer, std::string& err) {
+      return compile_pointer(pointer.data(), pointer.size(), err);
     }
-#if USE_UNICODE
-    FORCE_INLINE json_node& operator=(const char16_t* other) {
-      clear();
-      set(other);
-      return *this;
+    // "" is the whole document. a token of digits is an index on arrays and a key on objects.
+    bool compile_pointer(const char* pointer, size_t length, std::string& err) {
+      err.clear();
+      steps.clear();
+      const char* p = pointer;
+      const char* e = pointer + length;
+      if (p != e && *p != '/') return json_parser::make_err_msg("invalid pointer.", err);
+      while (p != e) {
+        step s;
+        for (++p; p != e && *p != '/'; ++p) {
+          if (*p != '~') {
+            s.key += *p;
+          } else if (++p != e && (*p == '0' || *p == '1')) {
+            s.key += *p == '0' ? '~' : '/';
+          } else {
+            return json_parser::make_err_msg("invalid pointer.", err);
+          }
+        }
+        // no leading zeros, and "-" is the element after the last which never exists
+        const size_t n = s.key.size();
+        if (n && n < 20 && (n == 1 || s.key[0] != '0')
+          && std::all_of(s.key.begin(), s.key.end(), [](char c) { return c >= '0' && c <= '9'; })) {
+          s.position = std::stoull(s.key);
+        }
+        steps.push_back(std::move(s));
+      }
+      hash_keys();
+      return true;
     }
-#else
-    FORCE_INLINE json_node& operator=(const char* other) {
-      clear();
-      set(other);
-      return *this;
+
+    // true when at most one value can match
+    FORCE_INLINE bool is_singular() const { return singular; }
+
+    // every match in a tree. matches come in document order, except that the elements an index or
+    // slice picks out of an array come before anything further down that array. false when the walk
+    // has to go below limits.max_depth, out keeps the matches found up to there.
+    template <typename Node>
+    FORCE_INLINE bool select(Node& root, std::vector<Node*>& out, const parse_limits& limits = parse_limits()) const {
+      auto visit = [&out](Node& node) { out.push_back(&node); return true; };
+      tree_cursor cur{limits.max_depth, false};
+      walk(root, 0, cur, visit);
+      return !cur.too_deep;
     }
-#endif
-    FORCE_INLINE json_node& operator=(const array& other) {
-      clear();
-      set(other);
-      return *this;
+    // the first match in a tree, or nullptr. nullptr as well when the walk has to go below
+    // limits.max_depth before it finds one.
+    template <typename Node>
+    FORCE_INLINE Node* find(Node& root, const parse_limits& limits = parse_limits()) const {
+      if (singular) {
+        Node* node = &root;
+        for (size_t i = 0; node && i < steps.size(); ++i) node = child(*node, steps[i]);
+        return node;
+      }
+      Node* found = nullptr;
+      auto visit = [&found](Node& node) { found = &node; return false; };
+      tree_cursor cur{limits.max_depth, false};
+      walk(root, 0, cur, visit);
+      return found;
     }
-    FORCE_INLINE json_node& operator=(const object& other) {
-      clear();
-      set(other);
-      return *this;
+
+    // evaluates on json text without building anything, the matches are the text of the values as
+    // they are written in json. only what the path goes through is read, everything else is skipped
+    // over by counting brackets and is not validated. input longer than limits.max_length, or a walk
+    // that has to go below limits.max_depth, fails like the parser does.
+    FORCE_INLINE bool select(const std::string& json, std::vector<string_view>& out, std::string& err) const {
+      return select(json.data(), json.size(), out, parse_limits(), err);
     }
-    FORCE_INLINE bool operator==(const json_node& other) const {
-      if (type != other.type) {
+    bool select(std::string&& json, std::vector<string_view>& out, std::string& err) const = delete;
+    FORCE_INLINE bool select(const char* json, size_t length, std::vector<string_view>& out, std::string& err) const {
+      return select(json, length, out, parse_limits(), err);
+    }
+    bool select(const char* json, size_t length, std::vector<string_view>& out, const parse_limits& limits, std::string& err) const {
+      auto visit = [&out](string_view text) { out.push_back(text); return true; };
+      return walk_text(json, length, limits, visit, err);
+    }
+    // the first match in json text, the rest of the input is not read. false when nothing matches,
+    // or when the input is malformed which sets err as well.
+    FORCE_INLINE bool find(const std::string& json, string_view& out, std::string& err) const {
+      return find(json.data(), json.size(), out, parse_limits(), err);
+    }
+    bool find(std::string&& json, string_view& out, std::string& err) const = delete;
+    FORCE_INLINE bool find(const char* json, size_t length, string_view& out, std::string& err) const {
+      return find(json, length, out, parse_limits(), err);
+    }
+    bool find(const char* json, size_t length, string_view& out, const parse_limits& limits, std::string& err) const {
+      bool found = false;
+      auto visit = [&out, &found](string_view text) { out = text; found = true; return false; };
+      return walk_text(json, length, limits, visit, err) && found;
+    }
+
+  private:
+    struct step {
+      enum kind_type : uint8_t { member, index, wildcard, slice };
+      static const size_t npos = static_cast<size_t>(-1);
+
+      step() : kind(member), descend(false), has_start(false), has_end(false), hash(0),
+               position(npos), start(0), end(0), stride(1) {}
+
+      kind_type kind;
+      bool descend;     // ".." applies the selector at every depth below as well
+      bool has_start;
+      bool has_end;
+      uint32_t hash;
+      size_t position;  // a pointer token that reads as an array index too
+      int64_t start;    // the index, or the slice start:end:stride
+      int64_t end;
+      int64_t stride;
+      std::string key;
+    };
+
+    // the containers a walk may still enter counts down in depth_left, every one it is inside of
+    // holds one. the walks recurse, so this is what keeps them off the end of the stack.
+    struct tree_cursor {
+      size_t depth_left;
+      bool too_deep;
+    };
+    struct text_cursor {
+      const char* end;
+      std::string& err;
+      std::string scratch;
+      size_t depth_left;
+      bool stop;
+    };
+
+    void hash_keys() {
+      singular = true;
+      for (step& s : steps) {
+        s.hash = static_cast<uint32_t>(string_hash::hash(s.key.data(), s.key.size()));
+        if (s.descend || s.kind == step::wildcard || s.kind == step::slice) singular = false;
+      }
+    }
+
+    // the one child a member or index step leads to, or nullptr
+    template <typename Node>
+    static FORCE_INLINE Node* child(Node& node, const step& s) {
+      if (node.is_object()) {
+        if (s.kind != step::member) return nullptr;
+        const auto& members = node.get_object();
+        auto iter = members.find(s.key.data(), s.key.size(), s.hash);
+        return iter != members.cend() ? iter->second : nullptr;
+      }
+      if (!node.is_array()) return nullptr;
+      const auto& elements = node.get_array();
+      size_t k = s.position;
+      if (s.kind == step::index) k = static_cast<size_t>(s.start < 0 ? s.start + static_cast<int64_t>(elements.size()) : s.start);
+      return k < elements.size() ? elements[k] : nullptr;
+    }
+
+    static bool parse_int(const char*& p, const char* e, int64_t& value) {
+      const bool negative = p != e && *p == '-';
+      if (negative) ++p;
+      if (p == e || *p < '0' || *p > '9') return false;
+      value = 0;
+      for (; p != e && *p >= '0' && *p <= '9'; ++p) {
+        if (value > 100000000000000000LL) return false;
+        value = value * 10 + (*p - '0');
+      }
+      if (negative) value = -value;
+      return true;
+    }
+
+    // [*], ['key'], ["key"], [index] or [start:end:stride], p is on the '['
+    static bool parse_bracket(const char*& p, const char* e, step& s) {
+      if (++p == e) return false;
+      if (*p == '*') {
+        s.kind = step::wildcard;
+        ++p;
+      } else if (*p == '\'' || *p == '\"') {
+        const char quote = *p++;
+        for (; p != e && *p != quote; ++p) {
+          if (*p == '\\' && ++p == e) return false;
+          s.key += *p;
+        }
+        if (p == e) return false;
+        ++p;
+      } else {
+        s.kind = step::index;
+        s.has_start = p != e && *p != ':';
+        if (s.has_start && !parse_int(p, e, s.start)) return false;
+        if (p != e && *p == ':') {
+          s.kind = step::slice;
+          s.has_end = ++p != e && *p != ':' && *p != ']';
+          if (s.has_end && !parse_int(p, e, s.end)) return false;
+          if (p != e && *p == ':' && ++p != e && *p != ']' && (!parse_int(p, e, s.stride) || s.stride == 0)) return false;
+        }
+      }
+      if (p == e || *p != ']') return false;
+      ++p;
+      return true;
+    }
+
+    // calls f with the picked element indexes of an array of n, in the order of the selector
+    template <typename F>
+    static bool for_each_picked(const step& s, size_t n, F f) {
+      const int64_t len = static_cast<int64_t>(n);
+      if (s.kind == step::index) {
+        const int64_t k = s.start < 0 ? s.start + len : s.start;
+        return k < 0 || k >= len || f(static_cast<size_t>(k));
+      }
+      // python slice rules, out of range bounds are clamped
+      const int64_t lo = s.stride > 0 ? 0 : -1;
+      const int64_t hi = s.stride > 0 ? len : len - 1;
+      int64_t begin = s.has_start ? (s.start < 0 ? s.start + len : s.start) : (s.stride > 0 ? lo : hi);
+      int64_t end = s.has_end ? (s.end < 0 ? s.end + len : s.end) : (s.stride > 0 ? hi : lo);
+      begin = std::min(std::max(begin, lo), hi);
+      end = std::min(std::max(end, lo), hi);
+      for (int64_t k = begin; s.stride > 0 ? k < end : k > end; k += s.stride) {
+        if (!f(static_cast<size_t>(k))) return false;
+      }
+      return true;
+    }
+
+    template <typename K>
+    static FORCE_INLINE bool key_equal(const K& key, const std::string& other) {
+      return key.size() == other.size() && std::char_traits<char>::compare(key.data(), other.data(), other.size()) == 0;
+    }
+
+    // returns false once visit asked to stop, or the walk went too deep
+    template <typename Node, typename Visit>
+    bool walk(Node& node, size_t i, tree_cursor& cur, Visit& visit) const {
+      if (i == steps.size()) return visit(node);
+      if (!node.is_array() && !node.is_object()) return true;
+      if (cur.depth_left == 0) {
+        cur.too_deep = true;
         return false;
       }
+      --cur.depth_left;
+      const bool more = walk_children(node, i, cur, visit);
+      ++cur.depth_left;
+      return more;
+    }
+    template <typename Node, typename Visit>
+    bool walk_children(Node& node, size_t i, tree_cursor& cur, Visit& visit) const {
+      const step& s = steps[i];
+      if (node.is_array()) {
+        const auto& elements = node.get_array();
+        const size_t n = elements.size();
+        if (s.kind == step::index || s.kind == step::slice) {
+          if (!for_each_picked(s, n, [&](size_t k) { return walk(*elements[k], i + 1, cur, visit); })) return false;
+          for (size_t k = 0; s.descend && k < n; ++k) {
+            if (!walk(*elements[k], i, cur, visit)) return false;
+          }
+          return true;
+        }
+        if (!s.descend) {
+          if (s.kind == step::member) return s.position >= n || walk(*elements[s.position], i + 1, cur, visit);
+        }
+        for (size_t k = 0; k < n; ++k) {
+          if (s.kind == step::wildcard && !walk(*elements[k], i + 1, cur, visit)) return false;
+          if (s.descend && !walk(*elements[k], i, cur, visit)) return false;
+        }
+      } else if (node.is_object()) {
+        const auto& members = node.get_object();
+        if (!s.descend && s.kind == step::member) {
+          auto iter = members.find(s.key.data(), s.key.size(), s.hash);
+          return iter == members.cend() || walk(*iter->second, i + 1, cur, visit);
+        }
+        for (const auto& m : members) {
+          if ((s.kind == step::wildcard || (s.kind == step::member && key_equal(m.first, s.key)))
+            && !walk(*m.second, i + 1, cur, visit)) return false;
+          if (s.descend && !walk(*m.second, i, cur, visit)) return false;
+        }
+      }
+      return true;
+    }
 
-      switch (type) {
-        case node_type::string_type:
-          return *(storage.str_val) == *(other.storage.str_val);
-        case node_type::number_type:
-          return is_equal(storage.num_val, other.storage.num_val);
-        case node_type::boolean_type:
-          return storage.bool_val == other.storage.bool_val;
-        case node_type::object_type: {
-          const object* l = this->storage.object_val;
-          const object* r = other.storage.object_val;
+    template <typename Visit>
+    bool walk_text(const char* json, size_t length, const parse_limits& limits, Visit& visit, std::string& err) const {
+      err.clear();
+      if (length > limits.max_length) return json_parser::make_err_msg(json_error::too_large, err);
+      text_cursor cur{json + length, err, std::string(), limits.max_depth, false};
+      const char* p = skip_space(json, cur.end);
+      if (p == cur.end || (*p != token_type::start_object && *p != token_type::start_array)) {
+        return json_parser::make_err_msg("invalid or empty json.", err);
+      }
+      return walk_text(cur, p, 0, visit) != nullptr;
+    }
+
+    // walks the value at p and returns its end, or nullptr with cur.err set. once visit asked to
+    // stop, cur.stop is set and everything returns right away.
+    template <typename Visit>
+    const char* walk_text(text_cursor& cur, const char* p, size_t i, Visit& visit) const {
+      if (i == steps.size()) {
+        const char* end = skip_value(cur, p);
+        if (end && !visit(string_view(p, end - p))) cur.stop = true;
+        return end;
+      }
+      if (p == cur.end || (*p != token_type::start_array && *p != token_type::start_object)) return skip_value(cur, p);
+      if (cur.depth_left == 0) {
+        json_parser::make_err_msg(json_error::too_deep, cur.err);
+        return nullptr;
+      }
+      --cur.depth_left;
+      const char* end = *p == token_type::start_array ? walk_text_array(cur, p, i, visit) : walk_text_object(cur, p, i, visit);
+      ++cur.depth_left;
+      return end;
+    }
+
+    template <typename Visit>
+    const char* walk_text_array(text_cursor& cur, const char* p, size_t i, Visit& visit) const {
+      const step& s = steps[i];
+      p = skip_space(p + 1, cur.end);
+      if (p != cur.end && *p == token_type::end_array) return p + 1;
+      if (s.kind == step::slice || (s.kind == step::index && (s.start < 0 || s.descend))) {
+        // the elements have to be counted before indexes from the end can be found
+        std::vector<const char*> starts;
+        for (;;) {
+          starts.push_back(p);
+          p = next_element(cur, skip_value(cur, p), token_type::end_array);
+          if (!p) return nullptr;
+          if (*p == token_type::end_array) break;
+        }
+        const char* error = nullptr;
+        for_each_picked(s, starts.size(), [&](size_t k) {
+          if (!walk_text(cur, starts[k], i + 1, visit)) error = p;
+          return !error && !cur.stop;
+        });
+        for (size_t k = 0; s.descend && !error && !cur.stop && k < starts.size(); ++k) {
+          if (!walk_text(cur, starts[k], i, visit)) error = p;
+        }
+        return error ? nullptr : p + 1;
+      }
+      for (size_t k = 0;; ++k) {
+        const char* end = nullptr;
+        if (s.kind == step::wildcard || (!s.descend && (s.kind == step::index ? s.start == static_cast<int64_t>(k) : s.position == k))) {
+          end = walk_text(cur, p, i + 1, visit);
+          if (!end || cur.stop) return end;
+        }
+        if (s.descend) {
+          end = walk_text(cur, p, i, visit);
+          if (!end || cur.stop) return end;
+        }
+        p = next_element(cur, end ? end : skip_value(cur, p), token_type::end_array);
+        if (!p) return nullptr;
+        if (*p == token_type::end_array) return p + 1;
+      }
+    }
+
+    template <typename Visit>
+    const char* walk_text_object(text_cursor& cur, const char* p, size_t i, Visit& visit) const {
+      const step& s = steps[i];
+      p = skip_space(p + 1, cur.end);
+      if (p != cur.end && *p == token_type::end_object) return p + 1;
+      // like find() on a tree, a member step only takes the first of duplicated keys
+      bool found = false;
+      for (;;) {
+        if (p == cur.end || *p != token_type::double_quote) return invalid_token(cur);
+        const char* key = p + 1;
+        p = skip_string(cur, p);
+        if (!p) return nullptr;
+        const char* key_end = p - 1;
+        p = skip_space(p, cur.end);
+        if (p == cur.end || *p != token_type::colon) return invalid_token(cur);
+        p = skip_space(p + 1, cur.end);
+        if (p == cur.end) return skip_value(cur, p);
+
+        const char* end = nullptr;
+        if (s.kind == step::wildcard || (s.kind == step::member && !found && text_key_equal(cur, key, key_end, s.key))) {
+          found = !s.descend;
+          end = walk_text(cur, p, i + 1, visit);
+          if (!end || cur.stop) return end;
+        }
+        if (s.descend) {
+          end = walk_text(cur, p, i, visit);
+          if (!end || cur.stop) return end;
+        }
+        p = next_element(cur, end ? end : skip_value(cur, p), token_type::end_object);
+        if (!p) return nullptr;
+        if (*p == token_type::end_object) return p + 1;
+      }
+    }
+
+    static FORCE_INLINE const char* skip_space(const char* p, const char* end) {
+      while (p != end && json_parser::is_space(*p)) ++p;
+      return p;
+    }
+
+    static const char* invalid_token(text_cursor& cur) {
+      json_parser::make_err_msg("invalid token.", cur.err);
+      return nullptr;
+    }
+
+    // after a value: the start of the next one, or the closing token
+    static FORCE_INLINE const char* next_element(text_cursor& cur, const char* p, token_type close) {
+      if (!p) return nullptr;
+      p = skip_space(p, cur.end);
+      if (p != cur.end && *p == token_type::comma) {
+        p = skip_space(p + 1, cur.end);
+        if (p != cur.end && *p != close) return p;
+      } else if (p != cur.end && *p == close) {
+        return p;
+      }
+      json_parser::make_err_msg(close == token_type::end_array ? "invalid end of array." : "invalid end of object.", cur.err);
+      return nullptr;
+    }
+
+    // p is on the opening quote, returns the position after the closing one
+    static FORCE_INLINE const char* skip_string(text_cursor& cur, const char* p) {
+      const char* q = p + 1;
+      for (;;) {
+        q = static_cast<const char*>(memchr(q, '\"', cur.end - q));
+        if (!q) {
+          json_parser::make_err_msg("unclosed string.", cur.err);
+          return nullptr;
+        }
+        // a quote behind an odd run of backslashes is escaped
+        const char* b = q;
+        while (b[-1] == '\\') --b;
+        if (((q - b) & 1) == 0) return q + 1;
+        ++q;
+      }
+    }
+
+    static const char* skip_value(text_cursor& cur, const char* p) {
+      const char c = p != cur.end ? *p : '\0';
+      if (c == token_type::double_quote) return skip_string(cur, p);
+      if (c == token_type::start_object || c == token_type::start_array) {
+        size_t depth = 0;
+        for (; p != cur.end; ++p) {
+          switch (*p) {
+            case '\"':
+              p = skip_string(cur, p);
+              if (!p) return nullptr;
+              --p;
+              break;
+            case '{': case '[':
+              ++depth;
+              break;
+            case '}': case ']':
+              if (--depth == 0) return p + 1;
+              break;
+            default:
+              break;
+          }
+        }
+        json_parser::make_err_msg(c == token_type::start_array ? "invalid end of array." : "invalid end of object.", cur.err);
+        return nullptr;
+      }
+      const char* start = p;
+      while (p != cur.end && *p != ',' && *p != ']' && *p != '}' && !json_parser::is_space(*p)) ++p;
+      if (p == start) {
+        json_parser::make_err_msg("parse error.", cur.err);
+        return nullptr;
+      }
+      return p;
+    }
+
+    static bool text_key_equal(text_cursor& cur, const char* key, const char* key_end, const std::string& other) {
+      const size_t n = key_end - key;
+      if (!memchr(key, '\\', n)) return n == other.size() && memcmp(key, other.data(), n) == 0;
+      // escapes only ever make a key shorter
+      if (n < other.size()) return false;
+      cur.scratch.resize(n);
+      char* out = unescape(key, key_end, &cur.scratch[0]);
+      return out && static_cast<size_t>(out - &cur.scratch[0]) == other.size() && memcmp(cur.scratch.data(), other.data(), other.size()) == 0;
+    }
+
+    std::vector<step> steps;
+    bool singular;
+  };
+
+  // reads newline delimited json (json lines): one document per line, blank lines are skipped.
+  // the input is cut into batches at line ends and the batches are parsed on several threads,
+  // each thread drawing its records from its own memory_arena.
+  template <typename String>
+  class basic_ndjson_parser {
+  public:
+    typedef basic_json_node<arena_allocator<char>, String> node_type;
+    static const size_t default_batch_size = 1 << 20;
+
+    // threads = 0 uses every core
+    explicit basic_ndjson_parser(unsigned threads = 0, size_t batch_size = default_batch_size)
+      : thread_count(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+        batch_size(batch_size ? batch_size : default_batch_size), interning(false) {}
+    basic_ndjson_parser(const basic_ndjson_parser&) = delete;
+    basic_ndjson_parser& operator=(const basic_ndjson_parser&) = delete;
+
+    // parses every record of the input, the i-th one is (*this)[i] afterwards. records stay valid
+    // until the next parse; for json_view_document like strings the input has to outlive them too.
+    // on failure err names the line of the first bad record, e.g. "line 3: invalid token.".
+    bool parse(const char* json, size_t length, std::string& err) {
+      records.clear();
+      for (auto& w : workers) w->arena.reset();
+      const size_t batch_count = (length + batch_size - 1) / batch_size;
+      batches.clear();
+      batches.resize(batch_count);
+      const bool ok = run(json, length, err, [this](worker& w, size_t batch, const char* record, size_t size, std::string& e) {
+        node_type* node = new (w.arena.allocate(sizeof(node_type))) node_type(arena_allocator<char>(&w.arena));
+        if (!json_parser::parse(*node, record, size, interning ? &w.keys : nullptr, e)) return false;
+        batches[batch].push_back(node);
+        return true;
+      });
+      if (ok) {
+        size_t total = 0;
+        for (const auto& b : batches) total += b.size();
+        records.reserve(total);
+        for (const auto& b : batches) records.insert(records.end(), b.begin(), b.end());
+      }
+      batches.clear();
+      return ok;
+    }
+    FORCE_INLINE bool parse(const std::string& json, std::string& err) {
+      return parse(json.data(), json.size(), err);
+    }
+
+    // hands every record to f(node_type& record, size_t offset) instead of keeping it. offset is
+    // where the record starts in the input. f is called from several threads at once and in no
+    // particular order, the record is only valid during the call. returning false stops the parse
+    // with "parse cancelled.".
+    template <typename F>
+    bool for_each(const char* json, size_t length, F f, std::string& err) {
+      records.clear();
+      return run(json, length, err, [this, &f, json](worker& w, size_t, const char* record, size_t size, std::string& e) {
+        w.arena.reset();
+        node_type node(arena_allocator<char>(&w.arena));
+        if (!json_parser::parse(node, record, size, interning ? &w.keys : nullptr, e)) return false;
+        if (!f(node, static_cast<size_t>(record - json))) {
+          w.cancelled = true;
+          return false;
+        }
+        return true;
+      });
+    }
+    template <typename F>
+    FORCE_INLINE bool for_each(const std::string& json, F f, std::string& err) {
+      return for_each(json.data(), json.size(), f, err);
+    }
+
+    FORCE_INLINE size_t size() const { return records.size(); }
+    FORCE_INLINE node_type& operator[](size_t i) { return *records[i]; }
+    FORCE_INLINE const node_type& operator[](size_t i) const { return *records[i]; }
+    FORCE_INLINE unsigned threads() const { return thread_count; }
+    // records share their keys: every thread interns them in a key_table of its own, which the
+    // parser keeps for as long as it lives
+    FORCE_INLINE void intern_keys(bool on) { interning = on; }
+
+  private:
+    struct worker {
+      memory_arena arena;
+      key_table keys;
+      std::string err;
+      size_t err_offset;
+      bool cancelled;
+    };
+
+    // first byte of the record that starts at or after pos
+    static FORCE_INLINE size_t record_start(const char* json, size_t length, size_t pos) {
+      if (pos == 0) return 0;
+      if (pos >= length) return length;
+      const void* nl = memchr(json + pos - 1, '\n', length - pos + 1);
+      return nl ? static_cast<const char*>(nl) - json + 1 : length;
+    }
+
+    // batches are claimed in input order. a bad record stops further claims but the batches
+    // already taken run to their end, so the error reported is always the first one of the input.
+    template <typename Parse>
+    bool run(const char* json, size_t length, std::string& err, Parse parse_record) {
+      err.clear();
+      const size_t batch_count = (length + batch_size - 1) / batch_size;
+      const unsigned n = static_cast<unsigned>(std::min<size_t>(thread_count, std::max<size_t>(batch_count, 1)));
+      while (workers.size() < n) workers.emplace_back(new worker());
+      std::atomic<size_t> next(0);
+      std::atomic<bool> failed(false), cancelled(false);
+
+      auto work = [&](worker& w) {
+        w.err.clear();
+        w.err_offset = length;
+        w.cancelled = false;
+        for (size_t batch; !failed.load(std::memory_order_relaxed) && (batch = next.fetch_add(1)) < batch_count;) {
+          const char* end = json + record_start(json, length, (batch + 1) * batch_size);
+          const char* line = json + record_start(json, length, batch * batch_size);
+          while (line < end) {
+            const char* nl = static_cast<const char*>(memchr(line, '\n', end - line));
+            const char* line_end = nl ? nl : end;
+            const char* first = line;
+            while (first < line_end && is_space(*first)) ++first;
+            if (first < line_end) {
+              if (!parse_record(w, batch, line, line_end - line, w.err)) {
+                w.err_offset = line - json;
+                if (w.cancelled) cancelled.store(true);
+                failed.store(true);
+                return;
+              }
+              if (cancelled.load(std::memory_order_relaxed)) return;
+            }
+            line = line_end + 1;
+          }
+        }
+      };
+
+      std::vector<std::thread> pool;
+      pool.reserve(n - 1);
+      for (unsigned i = 1; i < n; ++i) pool.emplace_back(work, std::ref(*workers[i]));
+      work(*workers[0]);
+      for (auto& t : pool) t.join();
+
+      if (!failed.load()) return true;
+      if (cancelled.load()) {
+        err = "parse cancelled.";
+        return false;
+      }
+      const worker* first = nullptr;
+      for (unsigned i = 0; i < n; ++i) {
+        if (!workers[i]->err.empty() && (!first || workers[i]->err_offset < first->err_offset)) first = workers[i].get();
+      }
+      const size_t line = std::count(json, json + first->err_offset, '\n') + 1;
+      err = "line " + std::to_string(line) + ": " + first->err;
+      return false;
+    }
+
+    static FORCE_INLINE bool is_space(const char c) {
+      return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+    }
+
+    unsigned thread_count;
+    size_t batch_size;
+    bool interning;
+    std::vector<std::unique_ptr<worker>> workers;
+    std::vector<std::vector<node_type*>> batches;
+    std::vector<node_type*> records;
+  };
+
+  typedef basic_ndjson_parser<document_node::string> ndjson_parser;
+  // records point into the input, which has to outlive them
+  typedef basic_ndjson_parser<string_view> ndjson_view_parser;
+
+  // parses one big document on several threads. a serial pass over the structural index builds the
+  // containers above the split depth and cuts the values at that depth out as tasks, depth 1 being
+  // the elements or members of the root. the tasks are parsed concurrently straight into their place
+  // in the tree, so the result is the same json_node a serial parse gives, in the same order.
+  class parallel_parser {
+  public:
+    static const size_t default_batch_size = 64 * 1024;
+
+    // threads = 0 uses every core
+    explicit parallel_parser(unsigned threads = 0, unsigned depth = 1, size_t batch_size = default_batch_size)
+      : thread_count(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+        split_depth(std::max(1u, depth)), batch_size(batch_size ? batch_size : default_batch_size) {}
+    parallel_parser(const parallel_parser&) = delete;
+    parallel_parser& operator=(const parallel_parser&) = delete;
+
+    // fails with the same message a serial json_parser::parse would give
+    bool parse(json_node& value, const char* json, size_t length, std::string& err) {
+      err.clear();
+      value = json_node();
+      if (length >= std::numeric_limits<uint32_t>::max()) {
+        return json_parser::make_err_msg("json too large.", err);
+      }
+      json_parser::index_buffer index(length);
+      size_t count = 0;
+      if (!structural_index::scan(json, length, index.data, count)) {
+        return json_parser::make_err_msg("unclosed string.", err);
+      }
+      index.data[count] = index.data[count + 1] = static_cast<uint32_t>(length);
+      structural_iterator token(json, length, index.data);
+      // RFC 4627: only objects or arrays were allowed as root
+      if (token.peek() != token_type::start_object && token.peek() != token_type::start_array) {
+        return json_parser::make_err_msg("invalid or empty json.", err);
+      }
+
+      tasks.clear();
+      json_parser::scratch_buffer scratch;
+      std::string split_err;
+      const bool split_ok = split(value, token, 0, scratch, split_err);
+      // a task starts before the point the split stopped at, so its error comes first in the input
+      if (!run(json, length, err)) return false;
+      if (!split_ok) {
+        err = split_err;
+        return false;
+      }
+      return true;
+    }
+    FORCE_INLINE bool parse(json_node& value, const std::string& json, std::string& err) {
+      return parse(value, json.data(), json.size(), err);
+    }
+
+    FORCE_INLINE unsigned threads() const { return thread_count; }
+    FORCE_INLINE unsigned depth() const { return split_depth; }
+
+  private:
+    // a value cut out for the workers: where it goes and the first of its tokens
+    struct task {
+      json_node* node;
+      const uint32_t* token;
+    };
+
+    // builds node from the value at token, down to the split depth
+    bool split(json_node& node, structural_iterator& token, unsigned depth, json_parser::scratch_buffer& scratch, std::string& err) {
+      if (depth == split_depth) {
+        tasks.push_back(task{&node, token.cursor()});
+        skip(token);
+        return true;
+      }
+      if (token.expect(token_type::start_array)) {
+        node = json_node::array();
+        if (token.expect(token_type::end_array)) return true;
+        do {
+          if (!split(node.emplace_back(), token, depth + 1, scratch, err)) return false;
+        } while (token.expect(token_type::comma));
+        return token.expect(token_type::end_array) || json_parser::make_err_msg("invalid end of array.", err);
+      }
+      if (token.expect(token_type::start_object)) {
+        node = json_node::object();
+        if (token.expect(token_type::end_object)) return true;
+        do {
+          const char* key;
+          size_t length;
+          bool copy;
+          if (token.peek() != token_type::double_quote
+            || !json_parser::parse_string(token, scratch, key, length, copy)
+            || length == 0
+            || !token.expect(token_type::colon)) {
+            return json_parser::make_err_msg("invalid token.", err);
+          }
+          if (!split(node.emplace(std::string(key, length)), token, depth + 1, scratch, err)) return false;
+        } while (token.expect(token_type::comma));
+        return token.expect(token_type::end_object) || json_parser::make_err_msg("invalid end of object.", err);
+      }
+      dom_builder<json_node> builder(node);
+      return json_parser::parse_value(builder, token, scratch, err);
+    }
+
+    // moves past a value by counting brackets, its task checks it
+    static FORCE_INLINE void skip(structural_iterator& token) {
+      size_t open = 0;
+      do {
+        const char c = token.peek();
+        if (c == token_type::start_object || c == token_type::start_array) {
+          ++open;
+        } else if (c == token_type::end_object || c == token_type::end_array) {
+          if (open == 0) return;
+          --open;
+        } else if (c == token_type::double_quote) {
+          token.advance();
+        } else if (c == '\0' && token.remaining() == 0) {
+          return;
+        }
+        token.advance();
+      } while (open);
+    }
+
+    // consecutive tasks are claimed in batches of about batch_size bytes. a bad value stops further
+    // claims but the batches already taken run to their end, so the error reported is the first one.
+    bool run(const char* json, size_t length, std::string& err) {
+      if (tasks.empty()) return true;
+      batches.clear();
+      for (size_t i = 0; i < tasks.size(); ++i) {
+        if (batches.empty() || *tasks[i].token - *tasks[batches.back()].token >= batch_size) batches.push_back(i);
+      }
+      batches.push_back(tasks.size());
+      const size_t batch_count = batches.size() - 1;
+      const unsigned n = static_cast<unsigned>(std::min<size_t>(thread_count, batch_count));
+      std::vector<std::string> errs(n);
+      std::vector<size_t> err_task(n, tasks.size());
+      std::atomic<size_t> next(0);
+      std::atomic<bool> failed(false);
+
+      auto work = [&](unsigned w) {
+        json_parser::scratch_buffer scratch;
+        for (size_t batch; !failed.load(std::memory_order_relaxed) && (batch = next.fetch_add(1)) < batch_count;) {
+          for (size_t i = batches[batch]; i < batches[batch + 1]; ++i) {
+            structural_iterator token(json, length, tasks[i].token);
+            dom_builder<json_node> builder(*tasks[i].node);
+            if (!json_parser::parse_element(builder, token, scratch, errs[w])) {
+              err_task[w] = i;
+              failed.store(true);
+              return;
+            }
+          }
+        }
+      };
+
+      std::vector<std::thread> pool;
+      pool.reserve(n - 1);
+      for (unsigned i = 1; i < n; ++i) pool.emplace_back(work, i);
+      work(0);
+      for (auto& t : pool) t.join();
+
+      if (!failed.load()) return true;
+      unsigned first = 0;
+      for (unsigned i = 1; i < n; ++i) {
+        if (err_task[i] < err_task[first]) first = i;
+      }
+      err = errs[first];
+      return false;
+    }
+
+    unsigned thread_count;
+    unsigned split_depth;
+    size_t batch_size;
+    std::vector<task> tasks;
+    std::vector<size_t> batches;
+  };
+
+  // serializes a big tree on several threads. containers near the root with few children are taken
+  // apart, the others have their elements or members cut into batches; every batch is written into a
+  // buffer of its own and the buffers are joined in order, so the text is byte for byte what
+  // serialize() gives.
+  class parallel_serializer {
+  public:
+    // most elements or members in one batch
+    static const size_t default_batch_size = 1024;
+
+    // threads = 0 uses every core
+    explicit parallel_serializer(unsigned threads = 0, size_t batch_size = default_batch_size)
+      : thread_count(threads ? threads : std::max(1u, std::thread::hardware_concurrency())),
+        batch_size(batch_size ? batch_size : default_batch_size), used(0), open_literal(0) {}
+    parallel_serializer(const parallel_serializer&) = delete;
+    parallel_serializer& operator=(const parallel_serializer&) = delete;
+
+    template <typename Alloc, typename String>
+    std::basic_string<json_char> serialize(const basic_json_node<Alloc, String>& node, bool prettify = false, unsigned int indent_size = 2) {
+      run(node, prettify ? 0 : -1, indent_size);
+      std::basic_string<json_char> s;
+      s.reserve(total_size());
+      for (size_t i = 0; i < used; ++i) s.append(pieces[i].data(), pieces[i].size());
+      return s;
+    }
+    // appends to out, which is not cleared first
+    template <typename Alloc, typename String>
+    void serialize(const basic_json_node<Alloc, String>& node, output_buffer& out, bool prettify = false, unsigned int indent_size = 2) {
+      run(node, prettify ? 0 : -1, indent_size);
+      out.reserve(out.size() + total_size());
+      for (size_t i = 0; i < used; ++i) out.write(pieces[i].data(), pieces[i].size());
+    }
+    // hands the buffers to the sink in order without joining them, a sink with write_parts such as
+    // fd_sink takes them all in one gathered write. false when the sink failed
+    template <typename Alloc, typename String, typename Sink>
+    bool serialize_to(const basic_json_node<Alloc, String>& node, Sink& sink, bool prettify = false, unsigned int indent_size = 2) {
+      run(node, prettify ? 0 : -1, indent_size);
+      return write_pieces(sink, 0);
+    }
+
+    FORCE_INLINE unsigned threads() const { return thread_count; }
+
+  private:
+    // deeper containers are always written as a whole
+    static const unsigned max_depth = 16;
+
+    // elements or members [begin, end) of node, written into a piece of their own
+    template <typename Node>
+    struct task {
+      const Node* node;
+      size_t begin;
+      size_t end;
+      int indent;
+      size_t piece;
+    };
+
+    template <typename Node>
+    void run(const Node& node, int indent, unsigned int indent_size) {
+      used = 0;
+      open_literal = 0;
+      if (thread_count == 1 || (!node.is_array() && !node.is_object())) {
+        node._serialize(indent, pieces[new_piece()], indent_size);
+        return;
+      }
+      std::vector<task<Node>> tasks;
+      plan(node, indent, indent_size, 0, tasks);
+      if (tasks.empty()) return;
 
-          return (l->size() == r->size()) && std::equal(l->cbegin(), l->cend(), r->cbegin(),
-                  [](const auto& left, const auto& right) {
-                    return (left.first == right.first) && (left.second == right.second);
-                  });
+      const unsigned n = static_cast<unsigned>(std::min<size_t>(thread_count, tasks.size()));
+      std::atomic<size_t> next(0);
+      auto work = [&]() {
+        for (size_t i; (i = next.fetch_add(1)) < tasks.size();) {
+          const task<Node>& t = tasks[i];
+          write_items(pieces[t.piece], *t.node, t.begin, t.end, t.indent, indent_size);
         }
-        case node_type::array_type: {
-          const array* l = this->storage.array_val;
-          const array* r = other.storage.array_val;
+      };
+      std::vector<std::thread> pool;
+      pool.reserve(n - 1);
+      for (unsigned i = 1; i < n; ++i) pool.emplace_back(work);
+      work();
+      for (auto& t : pool) t.join();
+    }
 
-          return (l->size() == r->size()) && std::equal(l->cbegin(), l->cend(), r->cbegin(),
-                  [](const auto& left, const auto& right) {
-                    return (left == right);
-                  });
+    // writes the brackets of a container and whatever of its children is not left to a task
+    template <typename Node>
+    void plan(const Node& node, int indent, unsigned int indent_size, unsigned depth, std::vector<task<Node>>& tasks) {
+      const bool is_array = node.is_array();
+      const size_t size = node.length();
+      literal().put(is_array ? '[' : '{');
+      const int inner = indent == -1 ? -1 : indent + 1;
+      if (size < thread_count * 4 && depth < max_depth) {
+        // too few children to share out, each one is taken apart in turn
+        for (size_t i = 0; i < size; ++i) {
+          const Node& child = child_at(node, i);
+          if ((child.is_array() || child.is_object()) && child.length() > 0) {
+            write_prefix(literal(), node, i, inner, indent_size);
+            plan(child, inner, indent_size, depth + 1, tasks);
+          } else {
+            write_items(literal(), node, i, i + 1, inner, indent_size);
+          }
+        }
+      } else {
+        // at least four batches per thread
+        const size_t batch = std::max<size_t>(1, std::min(batch_size, size / (thread_count * 4)));
+        for (size_t i = 0; i < size; i += batch) {
+          tasks.push_back(task<Node>{&node, i, std::min(size, i + batch), inner, new_piece()});
         }
-        default:
-          return true;
       }
-    }
-    FORCE_INLINE bool operator!=(const json_node& other) const {
-      return !(*this == other);
-    }
-    FORCE_INLINE bool operator==(const string& other) const {
-      if (type != node_type::string_type) {
-        return false;
+      if (indent != -1 && size > 0) {
+        write_indent(literal(), indent, indent_size);
       }
-
-      return *(storage.str_val) == other;
-    }
-    FORCE_INLINE bool operator!=(const string& other) const {
-      return !(*this == other);
+      literal().put(is_array ? ']' : '}');
     }
-    FORCE_INLINE bool operator==(const double other) const {
-      if (type != node_type::number_type) {
-        return false;
-      }
 
-      return is_equal(storage.num_val, other);
+    template <typename Node>
+    static FORCE_INLINE const Node& child_at(const Node& node, size_t i) {
+      return node.is_array() ? *(*node.storage.array_val)[i] : *(node.storage.object_val->begin() + i)->second;
     }
-    FORCE_INLINE bool operator!=(const double other) const {
-      return !(*this == other);
+
+    // the separator, indentation and key in front of child i, laid out like _serialize
+    template <typename Node>
+    static FORCE_INLINE void write_prefix(output_buffer& out, const Node& node, size_t i, int indent, unsigned int indent_size) {
+      if (i != 0) {
+        out.put(',');
+      }
+      if (indent != -1) {
+        write_indent(out, indent, indent_size);
+      }
+      if (!node.is_array()) {
+        const auto& key = (node.storage.object_val->begin() + i)->first;
+        write_escaped(out, key.data(), key.size());
+        out.put(':');
+        if (indent != -1) {
+          out.put(' ');
+        }
+      }
     }
-    FORCE_INLINE bool operator==(const int other) const {
-      if (type != node_type::number_type) {
-        return false;
+
+    template <typename Node>
+    static void write_items(output_buffer& out, const Node& node, size_t begin, size_t end, int indent, unsigned int indent_size) {
+      for (size_t i = begin; i < end; ++i) {
+        write_prefix(out, node, i, indent, indent_size);
+        child_at(node, i)._serialize(indent, out, indent_size);
       }
+    }
 
-      return is_equal(storage.num_val, (number)other);
+    // buffers are kept between calls, so a serializer that is reused stops allocating
+    FORCE_INLINE size_t new_piece() {
+      if (used == pieces.size()) pieces.emplace_back();
+      pieces[used].clear();
+      return used++;
     }
-    FORCE_INLINE bool operator!=(const int other) const {
-      return !(*this == other);
+    // the piece text between tasks goes into, the last one unless a task took it
+    FORCE_INLINE output_buffer& literal() {
+      if (open_literal == 0 || open_literal != used) open_literal = new_piece() + 1;
+      return pieces[open_literal - 1];
+    }
+    FORCE_INLINE size_t total_size() const {
+      size_t total = 0;
+      for (size_t i = 0; i < used; ++i) total += pieces[i].size();
+      return total;
     }
-    FORCE_INLINE bool is_null() const { return type == node_type::null_type; }
-    FORCE_INLINE bool is_boolean() const { return type == node_type::boolean_type; }
-    FORCE_INLINE bool is_number() const { return type == node_type::number_type; }
-    FORCE_INLINE bool is_string() const { return type == node_type::string_type; }
-    FORCE_INLINE bool is_array() const { return type == node_type::array_type; }
-    FORCE_INLINE bool is_object() const { return type == node_type::object_type; }
 
-  private:
-    FORCE_INLINE void clear() {
-      switch (type) {
-        case node_type::string_type:
-          delete storage.str_val;
-          break;
-        case node_type::array_type:
-          for (json_node* elem : *(storage.array_val)) {
-            delete elem;
-          }
-          delete storage.array_val;
-          break;
-        case node_type::object_type:
-          for (const auto& elem : *(storage.object_val)) {
-            delete elem.second;
-          }
-          delete storage.object_val;
-          break;
-        default:
-          break;
+    template <typename Sink>
+    auto write_pieces(Sink& sink, int) -> decltype(sink.write_parts(static_cast<const string_view*>(nullptr), size_t()), bool()) {
+      std::vector<string_view> parts;
+      parts.reserve(used);
+      for (size_t i = 0; i < used; ++i) {
+        if (!pieces[i].empty()) parts.emplace_back(pieces[i].data(), pieces[i].size());
       }
+      return sink.write_parts(parts.data(), parts.size());
     }
-    FORCE_INLINE void set(boolean val) { type = node_type::boolean_type; storage.bool_val = val; }
-    FORCE_INLINE void set(number val) { type = node_type::number_type; storage.num_val = val; }
-    FORCE_INLINE void set(const string& val) { type = node_type::string_type; storage.str_val = new string(val); }
-#if USE_UNICODE
-    FORCE_INLINE void set(const char16_t* val) { type = node_type::string_type; storage.str_val = new string(val); }
-#else
-    FORCE_INLINE void set(const char* val) { type = node_type::string_type; storage.str_val = new string(val); }
-#endif
-    FORCE_INLINE void set(const array& val) {
-      type = node_type::array_type;
-      storage.array_val = new array();
-      storage.array_val->reserve(val.size());
-      // deep copy
-      for (auto e : val) {
-        storage.array_val->emplace_back(new json_node(*e));
+    template <typename Sink>
+    bool write_pieces(Sink& sink, long) {
+      for (size_t i = 0; i < used; ++i) {
+        if (!pieces[i].empty() && !sink.write(pieces[i].data(), pieces[i].size())) return false;
       }
+      return true;
     }
-    FORCE_INLINE void set(const object& val) {
-      type = node_type::object_type;
-      storage.object_val = new object(val.size());
-      // deep copy
-      auto begin = val.cbegin();
-      auto end = val.cend();
-      for (; begin != end; ++begin) {
-        storage.object_val->insert(std::make_pair(begin->first, new json_node(*(begin->second))));
+
+    unsigned thread_count;
+    size_t batch_size;
+    std::vector<output_buffer> pieces;
+    size_t used;
+    // index + 1 of the piece literal text goes into, 0 for none
+    size_t open_literal;
+  };
+
+  // reads json into c++ types through json_binding, one value at a time. a cursor over the structural
+  // index of the document; the read functions return false and set the error when the input does not
+  // match what is read from it.
+  class json_reader {
+  public:
+    FORCE_INLINE json_reader(structural_iterator& token, std::string& err) : token(token), err(err) {}
+
+    FORCE_INLINE char peek() const { return token.peek(); }
+    FORCE_INLINE bool fail(const char* msg) { return json_parser::make_err_msg(msg, err); }
+
+    FORCE_INLINE bool read_null() {
+      if (peek() != 'n' || !json_parser::match_literal(token, "null", 4)) return fail("type mismatch.");
+      token.advance();
+      return true;
+    }
+    FORCE_INLINE bool read_boolean(bool& value) {
+      if (peek() == 't' && json_parser::match_literal(token, "true", 4)) {
+        value = true;
+      } else if (peek() == 'f' && json_parser::match_literal(token, "false", 5)) {
+        value = false;
+      } else {
+        return fail("type mismatch.");
       }
+      token.advance();
+      return true;
     }
-    FORCE_INLINE void set(string* val) { type = node_type::string_type; storage.str_val = val; }
-    FORCE_INLINE void set(array* val) { type = node_type::array_type; storage.array_val = val; }
-    FORCE_INLINE void set(object* val) { type = node_type::object_type; storage.object_val = val; }
-    FORCE_INLINE void make_indent(int indent, std::back_insert_iterator<string>& iter, unsigned int indent_size) const {
-      size_t size = indent * indent_size;
-      iter++ = '\n';
-      for (int i = 0; i < size; ++i) {
-        iter++ = ' ';
+    FORCE_INLINE bool read_number(number_value& value) {
+      const char c = peek();
+      if (c == token_type::double_quote || c == token_type::start_object || c == token_type::start_array
+        || c == 't' || c == 'f' || c == 'n') {
+        return fail("type mismatch.");
       }
+      return json_parser::parse_number(&value, token) || fail("parse error.");
     }
-    FORCE_INLINE void serialize_str(const string& str, std::back_insert_iterator<string>& iter) const {
-      iter++ = '\"';
-      std::copy(str.begin(), str.end(), iter);
-      iter++ = '\"';
+    // the text is only valid until the next read
+    FORCE_INLINE bool read_string(const char*& str, size_t& length) {
+      if (peek() != token_type::double_quote) return fail("type mismatch.");
+      bool copy;
+      return json_parser::parse_string(token, scratch, str, length, copy) || fail("invalid escape.");
     }
-    void _serialize(int indent, std::back_insert_iterator<string>& iter, unsigned int indent_size) const {
-      switch (type) {
-        case node_type::string_type:
-          serialize_str(*(storage.str_val), iter);
-          break;
-        case node_type::object_type: {
-          iter++ = '{';
-          if (indent != -1) {
-            ++indent;
-          }
-          auto cbegin = storage.object_val->cbegin();
-          auto cend = storage.object_val->cend();
-          for (auto citer = cbegin; citer != cend; ++citer) {
-            if (citer != cbegin) {
-              iter++ = ',';
-            }
-            if (indent != -1) {
-              make_indent(indent, iter, indent_size);
-            }
-            serialize_str(citer->first, iter);
-            iter++ = ':';
-            if (indent != -1) {
-              iter++ = ' ';
-            }
-            citer->second->_serialize(indent, iter, indent_size);
-          }
-          if (indent != -1) {
-            --indent;
-            if (!storage.object_val->empty()) {
-              make_indent(indent, iter, indent_size);
-            }
-          }
-          iter++ = '}';
-          break;
-        }
-        case node_type::array_type: {
-          iter++ = '[';
-          if (indent != -1) {
-            ++indent;
-          }
-          auto cbegin = storage.array_val->cbegin();
-          auto cend = storage.array_val->cend();
-          for (auto citer = cbegin; citer != cend; ++citer) {
-            if (citer != cbegin) {
-              iter++ = ',';
-            }
-            if (indent != -1) {
-              make_indent(indent, iter, indent_size);
-            }
-            (*citer)->_serialize(indent, iter, indent_size);
-          }
-          if (indent != -1) {
-            --indent;
-            if (!storage.array_val->empty()) {
-              make_indent(indent, iter, indent_size);
-            }
-          }
-          iter++ = ']';
-          break;
-        }
-        case node_type::null_type: {
-		      static const char* n = "null";
-          std::copy(n, n + 4, iter);
-          break;
-		    }
-        case node_type::number_type: {
-          char buf[MAX_NUMBER_STRING_SIZE];
-          const char* c = dtoa(buf, storage.num_val);
-          std::copy(c, c + strlen(c), iter);
-          break;
+    // calls f(const char* key, size_t length) for every member, f reads the value and returns false to stop
+    template <typename F>
+    bool read_object(F f) {
+      if (!token.expect(token_type::start_object)) return fail("type mismatch.");
+      if (token.expect(token_type::end_object)) return true;
+      do {
+        const char* key;
+        size_t length;
+        bool copy;
+        if (token.peek() != token_type::double_quote
+          || !json_parser::parse_string(token, scratch, key, length, copy)
+          || length == 0
+          || !token.expect(token_type::colon)) {
+          return fail("invalid token.");
         }
-        case node_type::boolean_type: {
-		      static const char* t = "true";
-          static const char* f = "false";
-          if (storage.bool_val) {
-            std::copy(t, t + 4, iter);
-          } else {
-            std::copy(f, f + 5, iter);
-          }
-          break;
-		    }
-      }
+        if (!f(key, length)) return false;
+      } while (token.expect(token_type::comma));
+      return token.expect(token_type::end_object) || fail("invalid end of object.");
+    }
+    // calls f() for every element, f reads it and returns false to stop
+    template <typename F>
+    bool read_array(F f) {
+      if (!token.expect(token_type::start_array)) return fail("type mismatch.");
+      if (token.expect(token_type::end_array)) return true;
+      do {
+        if (!f()) return false;
+      } while (token.expect(token_type::comma));
+      return token.expect(token_type::end_array) || fail("invalid end of array.");
+    }
+    // checks the value and moves past it, for members nothing is bound to
+    FORCE_INLINE bool skip() {
+      json_handler ignore;
+      return json_parser::parse_element(ignore, token, scratch, err);
+    }
+    // builds the value into an empty tree, for parts of a document that are not bound to a type
+    template <typename Node>
+    FORCE_INLINE bool read_node(Node& node) {
+      dom_builder<Node> builder(node);
+      return json_parser::parse_element(builder, token, scratch, err);
     }
 
-    Storage storage;
-    node_type type;
+  private:
+    structural_iterator& token;
+    std::string& err;
+    json_parser::scratch_buffer scratch;
   };
 
-  typedef json_node::boolean boolean;
-  typedef json_node::number number;
-  typedef json_node::string string;
-  typedef json_node::array array;
-  typedef json_node::object object;
-
-  class json_parser {
-  public:
-    FORCE_INLINE static bool parse(json_node& value, const std::string& json, std::string& err) {
-      const char* token = json.c_str();
-      err.clear();
+  // how a c++ type is read from and written as json: a specialization has
+  //   static bool read(T& value, json_reader& in);
+  //   template <typename Writer> static void write(const T& value, Writer& out, int indent, unsigned int indent_size);
+  // where indent is -1 for compact output. booleans, numbers, std::string, std::vector, std::map with
+  // string keys, std::optional, json_node and structs declared with TINYJSON_BIND come with one.
+  template <typename T, typename Enable = void>
+  struct json_binding;
 
-      // RFC 4627: only objects or arrays were allowed as root
-      if (expect_token(&token, token_type::start_object)) {
-        if (!parse_object(value, &token, err)) return false;
-      } else if (expect_token(&token, token_type::start_array)) {
-        if (!parse_array(value, &token, err)) return false;
+  template <>
+  struct json_binding<bool> {
+    static FORCE_INLINE bool read(bool& value, json_reader& in) { return in.read_boolean(value); }
+    template <typename Writer>
+    static FORCE_INLINE void write(bool value, Writer& out, int, unsigned int) {
+      if (value) {
+        out.write("true", 4);
       } else {
-        return make_err_msg("invalid or empty json.", err);
+        out.write("false", 5);
       }
+    }
+  };
 
+  // integers have to be whole numbers within the range of the type
+  template <typename T>
+  struct json_binding<T, typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type> {
+    static bool read(T& value, json_reader& in) {
+      number_value number;
+      if (!in.read_number(number)) return false;
+      if (number.kind == number_kind::real) return in.fail("type mismatch.");
+      if (number.kind == number_kind::unsigned_integer) {
+        if (number.uint_val > static_cast<typename std::make_unsigned<T>::type>(std::numeric_limits<T>::max())) return in.fail("number out of range.");
+        value = static_cast<T>(number.uint_val);
+        return true;
+      }
+      if (std::is_signed<T>::value
+        ? (number.int_val < static_cast<int64_t>(std::numeric_limits<T>::min()) || number.int_val > static_cast<int64_t>(std::numeric_limits<T>::max()))
+        : (number.int_val < 0 || static_cast<uint64_t>(number.int_val) > static_cast<uint64_t>(std::numeric_limits<T>::max()))) {
+        return in.fail("number out of range.");
+      }
+      value = static_cast<T>(number.int_val);
       return true;
     }
+    template <typename Writer>
+    static FORCE_INLINE void write(T value, Writer& out, int, unsigned int) {
+      char buf[MAX_NUMBER_STRING_SIZE];
+      const char* e = std::is_signed<T>::value ? itoa(buf, static_cast<int64_t>(value)) : utoa(buf, static_cast<uint64_t>(value));
+      out.write(buf, e - buf);
+    }
+  };
 
-  private:
-    FORCE_INLINE static bool expect_token(const char** token, token_type type) {
-      (*token) += strspn((*token), " \t\n\r");
-      if ((*token)[0] == type) {
-        (*token)++;
-        return true;
+  template <typename T>
+  struct json_binding<T, typename std::enable_if<std::is_floating_point<T>::value>::type> {
+    static bool read(T& value, json_reader& in) {
+      number_value number;
+      if (!in.read_number(number)) return false;
+      switch (number.kind) {
+        case number_kind::signed_integer: value = static_cast<T>(number.int_val); break;
+        case number_kind::unsigned_integer: value = static_cast<T>(number.uint_val); break;
+        default: value = static_cast<T>(number.real); break;
       }
+      return true;
+    }
+    template <typename Writer>
+    static FORCE_INLINE void write(T value, Writer& out, int, unsigned int) {
+      char buf[MAX_NUMBER_STRING_SIZE];
+      const char* e = dtoa(buf, static_cast<double>(value));
+      out.write(buf, e - buf);
+    }
+  };
 
-      return false;
+  template <typename Traits, typename Alloc>
+  struct json_binding<std::basic_string<json_char, Traits, Alloc>> {
+    typedef std::basic_string<json_char, Traits, Alloc> string_type;
+
+    static FORCE_INLINE bool read(string_type& value, json_reader& in) {
+      const char* str;
+      size_t length;
+      if (!in.read_string(str, length)) return false;
+      value.assign(str, length);
+      return true;
     }
-    FORCE_INLINE static bool make_err_msg(const char* msg, std::string& err) {
-      char buf[64];
-      snprintf(buf, sizeof(buf), "%s", msg);
-      err = buf;
-      return false;
+    template <typename Writer>
+    static FORCE_INLINE void write(const string_type& value, Writer& out, int, unsigned int) {
+      write_escaped(out, value.data(), value.size());
     }
-    FORCE_INLINE static bool parse_number(double* number, const char** token) {
-      (*token) += strspn((*token), " \t");
-      const char* end = (*token) + strcspn((*token), " \t,\n\r}]");
-      if (end != (*token)) {
-        double value;
-        if (!atod((*token), end, &value)) return false;
-        (*number) = value;
-        (*token) = end;
-        return true;
-      }
+  };
 
-      return false;
+  // writes the elements or members of a container with the layout of json_node::serialize
+  template <typename Writer, typename Iter, typename F>
+  void write_container(Writer& out, int indent, unsigned int indent_size, char open, char close, Iter begin, Iter end, F write_item) {
+    out.put(open);
+    if (indent != -1) {
+      ++indent;
     }
-    FORCE_INLINE static bool parse_string(string& str, const char** token) {
-      // skip "
-      if ((*token)[0] == token_type::double_quote) (*token)++;
-      const char* end = (*token) + strcspn((*token), "\"");
-      str.clear();
-      if ((*token) != end) {
-        str.assign((*token), end - (*token));
-        (*token) = ++end;
-        return true;
+    for (Iter iter = begin; iter != end; ++iter) {
+      if (iter != begin) {
+        out.put(',');
       }
-
-      (*token) = ++end;
-      return false;
+      if (indent != -1) {
+        write_indent(out, indent, indent_size);
+      }
+      write_item(*iter, indent);
     }
-    FORCE_INLINE static bool parse_value(json_node& value, const char** token, std::string& err) {
-      if ((*token)[0] == token_type::double_quote) {
-        // string
-        string str_value;
-        // allow empty string
-        parse_string(str_value, token);
-        value.set(str_value);
-      } else if (((*token)[0] == 't') && (0 == strncmp((*token), "true", 4))) {
-        // boolean true
-        value.set(true);
-        (*token) += 4;
-      } else if (((*token)[0] == 'f') && (0 == strncmp((*token), "false", 5))) {
-        // boolean false
-        value.set(false);
-        (*token) += 5;
-      } else if (((*token)[0] == 'n') && (0 == strncmp((*token), "null", 4))) {
-        // null
-        (*token) += 4;
-      } else {
-        // number
-        double number = 0.0;
-        if (!parse_number(&number, token)) {
-          return make_err_msg("parse error.", err);
-        }
-        value.set(number);
+    if (indent != -1) {
+      --indent;
+      if (begin != end) {
+        write_indent(out, indent, indent_size);
       }
+    }
+    out.put(close);
+  }
 
-      return true;
+  // a member key and the separator after it
+  template <typename Writer>
+  FORCE_INLINE void write_key(Writer& out, const json_char* key, size_t length, int indent) {
+    write_escaped(out, key, length);
+    out.put(':');
+    if (indent != -1) {
+      out.put(' ');
     }
-    static bool parse_object(json_node& value, const char** token, std::string& err) {
-      string current_key;
-      object* root = new object();
+  }
 
-      // empty object
-      if (expect_token(token, token_type::end_object)) {
-        value.set(root);
-        return true;
-      }
+  template <typename T, typename Alloc>
+  struct json_binding<std::vector<T, Alloc>> {
+    static bool read(std::vector<T, Alloc>& value, json_reader& in) {
+      value.clear();
+      return in.read_array([&value, &in]() {
+        value.emplace_back();
+        return json_binding<T>::read(value.back(), in);
+      });
+    }
+    template <typename Writer>
+    static void write(const std::vector<T, Alloc>& value, Writer& out, int indent, unsigned int indent_size) {
+      write_container(out, indent, indent_size, '[', ']', value.begin(), value.end(), [&out, indent_size](const T& item, int level) {
+        json_binding<T>::write(item, out, level, indent_size);
+      });
+    }
+  };
 
-      do {
-        if (!expect_token(token, token_type::double_quote)
-          || !parse_string(current_key, token)
-          || !expect_token(token, token_type::colon)) {
-          return make_err_msg("invalid token.", err);
-        }
+  template <typename T, typename Compare, typename Alloc>
+  struct json_binding<std::map<std::string, T, Compare, Alloc>> {
+    typedef std::map<std::string, T, Compare, Alloc> map_type;
 
-        json_node* current_value = new json_node();
-        if (expect_token(token, token_type::start_object)) {
-          if (!parse_object(*current_value, token, err)) return false;
-        } else if (expect_token(token, token_type::start_array)) {
-          if (!parse_array(*current_value, token, err)) return false;
-        } else {
-          if (!parse_value(*current_value, token, err)) return false;
-        }
-        root->insert(std::make_pair(current_key, current_value));
-      } while(expect_token(token, token_type::comma));
+    static bool read(map_type& value, json_reader& in) {
+      value.clear();
+      return in.read_object([&value, &in](const char* key, size_t length) {
+        return json_binding<T>::read(value[std::string(key, length)], in);
+      });
+    }
+    template <typename Writer>
+    static void write(const map_type& value, Writer& out, int indent, unsigned int indent_size) {
+      write_container(out, indent, indent_size, '{', '}', value.begin(), value.end(), [&out, indent_size](const typename map_type::value_type& item, int level) {
+        write_key(out, item.first.data(), item.first.size(), level);
+        json_binding<T>::write(item.second, out, level, indent_size);
+      });
+    }
+  };
 
-      if (!expect_token(token, token_type::end_object)) {
-        return make_err_msg("invalid end of object.", err);
+#if TINYJSON_HAS_OPTIONAL
+  // null or a missing member leave it empty, an empty one is written as null or left out of an object
+  template <typename T>
+  struct json_binding<std::optional<T>> {
+    static bool read(std::optional<T>& value, json_reader& in) {
+      if (in.peek() == 'n') {
+        value.reset();
+        return in.read_null();
       }
+      if (!value) value.emplace();
+      return json_binding<T>::read(*value, in);
+    }
+    template <typename Writer>
+    static void write(const std::optional<T>& value, Writer& out, int indent, unsigned int indent_size) {
+      if (value) {
+        json_binding<T>::write(*value, out, indent, indent_size);
+      } else {
+        out.write("null", 4);
+      }
+    }
+    static FORCE_INLINE bool absent(const std::optional<T>& value) { return !value; }
+  };
+#endif
 
-      value.set(root);
-      return true;
+  // a part of a document that is kept as a tree
+  template <typename Alloc, typename String>
+  struct json_binding<basic_json_node<Alloc, String>> {
+    static FORCE_INLINE bool read(basic_json_node<Alloc, String>& value, json_reader& in) {
+      value.clear();
+      return in.read_node(value);
+    }
+    template <typename Writer>
+    static FORCE_INLINE void write(const basic_json_node<Alloc, String>& value, Writer& out, int indent, unsigned int indent_size) {
+      value._serialize(indent, out, indent_size);
     }
-    static bool parse_array(json_node& value, const char** token, std::string& err) {
-      array* root = new array();
+  };
 
-      // empty array
-      if (expect_token(token, token_type::end_array)) {
-        value.set(root);
-        return true;
+  // a member of a struct bound to json, see TINYJSON_BIND
+  template <typename T, typename M>
+  struct json_field {
+    typedef M member_type;
+    const char* name;
+    size_t length;
+    M T::*member;
+  };
+
+  template <typename T, typename M, size_t N>
+  constexpr json_field<T, M> make_field(const char (&name)[N], M T::*member) {
+    return json_field<T, M>{name, N - 1, member};
+  }
+
+  // members that are left out of an object when written, those whose binding has an absent() that says so
+  template <typename T>
+  class json_absent {
+    template <typename B>
+    static auto test(int) -> decltype(B::absent(std::declval<const T&>()), std::true_type());
+    template <typename B>
+    static std::false_type test(...);
+  public:
+    static FORCE_INLINE bool check(const T& value) { return check(value, decltype(test<json_binding<T>>(0))()); }
+  private:
+    static FORCE_INLINE bool check(const T&, std::false_type) { return false; }
+    static FORCE_INLINE bool check(const T& value, std::true_type) { return json_binding<T>::absent(value); }
+  };
+
+  // the binding of a struct whose json_binding lists its fields() as a tuple of json_field. members
+  // are matched by name in any order; unknown ones are skipped, missing ones keep their value.
+  template <typename T>
+  struct object_binding {
+    static FORCE_INLINE bool read(T& value, json_reader& in) {
+      return read_fields(value, json_binding<T>::fields(), in);
+    }
+    template <typename Writer>
+    static void write(const T& value, Writer& out, int indent, unsigned int indent_size) {
+      out.put('{');
+      bool empty = true;
+      write_fields<0>(value, json_binding<T>::fields(), out, indent == -1 ? -1 : indent + 1, indent_size, empty);
+      if (indent != -1 && !empty) {
+        write_indent(out, indent, indent_size);
       }
+      out.put('}');
+    }
 
-      do {
-        json_node* current_value = new json_node();
-        if (expect_token(token, token_type::start_object)) {
-          if (!parse_object(*current_value, token, err)) return false;
-        } else if (expect_token(token, token_type::start_array)) {
-          if (!parse_array(*current_value, token, err)) return false;
-        } else {
-          if (!parse_value(*current_value, token, err)) return false;
+  private:
+    struct field_name {
+      const char* str;
+      size_t length;
+    };
+
+    template <typename Fields, size_t... I>
+    static std::array<field_name, sizeof...(I)> field_names(const Fields& fields, std::index_sequence<I...>) {
+      return {{ field_name{std::get<I>(fields).name, std::get<I>(fields).length}... }};
+    }
+    static FORCE_INLINE bool name_equal(const field_name& name, const char* key, size_t length) {
+      return name.length == length && memcmp(name.str, key, length) == 0;
+    }
+
+    template <typename Fields>
+    static bool read_fields(T& value, const Fields& fields, json_reader& in) {
+      static const size_t count = std::tuple_size<Fields>::value;
+      static const std::array<field_name, count> names = field_names(fields, std::make_index_sequence<count>());
+      size_t next = 0;
+      return in.read_object([&](const char* key, size_t length) {
+        // members mostly come in the order of the fields, so the one after the last match is tried first
+        size_t i = next;
+        if (i >= count || !name_equal(names[i], key, length)) {
+          for (i = 0; i < count && !name_equal(names[i], key, length); ++i) {}
+          if (i == count) return in.skip();
         }
-        root->emplace_back(current_value);
-      } while(expect_token(token, token_type::comma));
+        next = i + 1;
+        return read_field<0>(i, value, fields, in);
+      });
+    }
 
-      if (!expect_token(token, token_type::end_array)) {
-        return make_err_msg("invalid end of array.", err);
-      }
+    // dispatches the runtime field index to the member it reads
+    template <size_t I, typename Fields>
+    static FORCE_INLINE typename std::enable_if<(I < std::tuple_size<Fields>::value), bool>::type
+    read_field(size_t i, T& value, const Fields& fields, json_reader& in) {
+      const auto& field = std::get<I>(fields);
+      if (i == I) return json_binding<typename std::decay<decltype(field)>::type::member_type>::read(value.*field.member, in);
+      return read_field<I + 1>(i, value, fields, in);
+    }
+    template <size_t I, typename Fields>
+    static FORCE_INLINE typename std::enable_if<(I == std::tuple_size<Fields>::value), bool>::type
+    read_field(size_t, T&, const Fields&, json_reader& in) {
+      return in.skip();
+    }
 
-      value.set(root);
-      return true;
+    template <size_t I, typename Fields, typename Writer>
+    static FORCE_INLINE typename std::enable_if<(I < std::tuple_size<Fields>::value)>::type
+    write_fields(const T& value, const Fields& fields, Writer& out, int indent, unsigned int indent_size, bool& empty) {
+      const auto& field = std::get<I>(fields);
+      typedef typename std::decay<decltype(field)>::type::member_type member_type;
+      const member_type& member = value.*field.member;
+      if (!json_absent<member_type>::check(member)) {
+        if (!empty) {
+          out.put(',');
+        }
+        empty = false;
+        if (indent != -1) {
+          write_indent(out, indent, indent_size);
+        }
+        write_key(out, field.name, field.length, indent);
+        json_binding<member_type>::write(member, out, indent, indent_size);
+      }
+      write_fields<I + 1>(value, fields, out, indent, indent_size, empty);
     }
+    template <size_t I, typename Fields, typename Writer>
+    static FORCE_INLINE typename std::enable_if<(I == std::tuple_size<Fields>::value)>::type
+    write_fields(const T&, const Fields&, Writer&, int, unsigned int, bool&) {}
   };
+
+  template <typename T>
+  bool json_parser::decode(T& value, const char* json, size_t length, std::string& err) {
+    err.clear();
+    if (length >= std::numeric_limits<uint32_t>::max()) {
+      return make_err_msg("json too large.", err);
+    }
+    index_buffer index(length);
+    size_t count = 0;
+    if (!structural_index::scan(json, length, index.data, count)) {
+      return make_err_msg("unclosed string.", err);
+    }
+    index.data[count] = index.data[count + 1] = static_cast<uint32_t>(length);
+    structural_iterator token(json, length, index.data);
+    // RFC 4627: only objects or arrays were allowed as root
+    if (token.peek() != token_type::start_object && token.peek() != token_type::start_array) {
+      return make_err_msg("invalid or empty json.", err);
+    }
+    json_reader in(token, err);
+    return json_binding<T>::read(value, in);
+  }
+
+  // writes a value with a json_binding, laid out like json_node::serialize
+  template <typename T>
+  FORCE_INLINE std::string serialize(const T& value, bool prettify = false, unsigned int indent_size = 2) {
+    std::string s;
+    string_writer<std::string> out(s);
+    json_binding<T>::write(value, out, prettify ? 0 : -1, indent_size);
+    return s;
+  }
+  // appends to out, which is not cleared first
+  template <typename T>
+  FORCE_INLINE void serialize(const T& value, output_buffer& out, bool prettify = false, unsigned int indent_size = 2) {
+    json_binding<T>::write(value, out, prettify ? 0 : -1, indent_size);
+  }
+  // streams to a sink such as file_sink, fd_sink or a callback_sink. false when the sink failed
+  template <typename T, typename Sink>
+  bool serialize_to(const T& value, Sink& sink, bool prettify = false, unsigned int indent_size = 2) {
+    chunked_writer<Sink> out(sink);
+    json_binding<T>::write(value, out, prettify ? 0 : -1, indent_size);
+    return out.flush();
+  }
 }
+
+// binds the listed members of a struct to json members of the same name. use it at global scope,
+// after the struct:
+//   TINYJSON_BIND(point, x, y)
+// for other member names specialize tinyjson::json_binding by hand, see README.
+#define TINYJSON_EXPAND(x) x
+#define TINYJSON_CONCAT_(a, b) a##b
+#define TINYJSON_CONCAT(a, b) TINYJSON_CONCAT_(a, b)
+#define TINYJSON_COUNT_N(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define TINYJSON_COUNT(...) TINYJSON_EXPAND(TINYJSON_COUNT_N(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define TINYJSON_FIELD(type, f) ::tinyjson::make_field(#f, &type::f)
+#define TINYJSON_FIELDS_1(type, f) TINYJSON_FIELD(type, f)
+#define TINYJSON_FIELDS_2(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_1(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_3(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_2(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_4(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_3(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_5(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_4(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_6(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_5(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_7(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_6(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_8(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_7(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_9(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_8(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_10(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_9(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_11(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_10(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_12(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_11(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_13(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_12(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_14(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_13(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_15(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_14(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_16(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_15(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_17(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_16(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_18(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_17(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_19(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_18(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_20(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_19(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_21(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_20(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_22(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_21(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_23(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_22(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_24(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_23(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_25(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_24(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_26(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_25(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_27(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_26(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_28(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_27(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_29(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_28(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_30(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_29(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_31(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_30(type, __VA_ARGS__))
+#define TINYJSON_FIELDS_32(type, f, ...) TINYJSON_FIELD(type, f), TINYJSON_EXPAND(TINYJSON_FIELDS_31(type, __VA_ARGS__))
+#define TINYJSON_FIELDS(type, ...) TINYJSON_EXPAND(TINYJSON_CONCAT(TINYJSON_FIELDS_, TINYJSON_COUNT(__VA_ARGS__))(type, __VA_ARGS__))
+#define TINYJSON_BIND(type, ...) \
+  namespace tinyjson { \
+    template <> \
+    struct json_binding<type> : object_binding<type> { \
+      static const auto& fields() { \
+        static const auto f = std::make_tuple(TINYJSON_FIELDS(type, __VA_ARGS__)); \
+        return f; \
+      } \
+    }; \
+  }